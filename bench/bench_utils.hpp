@@ -0,0 +1,44 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+
+// best wall clock time of `repeats` runs of `body`, in milliseconds
+template<typename F>
+double bestOf(int repeats, F&& body)
+{
+    double best = 0.0;
+    for (int i = 0; i < repeats; i++)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        body();
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if(i == 0 || ms < best)
+        {
+            best = ms;
+        }
+    }
+
+    return best;
+}
+
+// peak resident set size of the whole process so far in MB, 0 where the platform doesn't tell
+inline double peakRssMB()
+{
+#if defined(__APPLE__)
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return double(usage.ru_maxrss) / (1024.0 * 1024.0);
+#elif defined(__unix__)
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return double(usage.ru_maxrss) / 1024.0;
+#else
+    return 0.0;
+#endif
+}
@@ -0,0 +1,107 @@
+// Reading a whole extrusion once: materialized with extrudeProfile vs streamed from a CurveMeshView in blocks.
+// Peak memory only grows over the life of a process, so every run measures a single way of reading the mesh.
+// usage: bench_curve_mesh_view <mesh | blocks | elements> [segment count = 2000000]
+
+#include "bench_utils.hpp"
+
+#include "curve_mesh_view.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <string>
+
+
+// stands in for a consumer like an exporter, so that nothing gets optimized away
+struct Checksum
+{
+    double sum = 0.0;
+    size_t vertexCount = 0;
+    size_t indexCount = 0;
+
+    void add(const std::vector<glm::vec3>& vertices, const std::vector<glm::vec3>& normals, const std::vector<unsigned int>& indices)
+    {
+        for (size_t i = 0; i < vertices.size(); i++)
+        {
+            sum += vertices[i].x + vertices[i].y + vertices[i].z + normals[i].x + normals[i].y + normals[i].z;
+        }
+        for(unsigned int index : indices)
+        {
+            sum += index & 1;
+        }
+        vertexCount += vertices.size();
+        indexCount += indices.size();
+    }
+};
+
+int main(int argc, char **argv)
+{
+    const char *mode = argc > 1 ? argv[1] : "";
+    if(strcmp(mode, "mesh") != 0 && strcmp(mode, "blocks") != 0 && strcmp(mode, "elements") != 0)
+    {
+        printf("usage: bench_curve_mesh_view <mesh | blocks | elements> [segment count = 2000000]\n");
+        return 2;
+    }
+    const unsigned int segmentCount = argc > 2 ? std::stoul(argv[2]) : 2000000;
+
+    const std::vector<BezierCurvePoint> curvePoints {
+        {{-5.f, 0.f, 0.f}, 0.3f},
+        {{-2.f, 7.f, -1.f}, 1.f},
+        {{5.f, 0.f, -2.f}, 1.f},
+        {{2.f, 7.f, -3.f}, 0.1f},
+    };
+    std::vector<glm::vec2> profile;
+    for (int i = 0; i < 16; i++)
+    {
+        const float angle = 6.2831853f * float(i) / 16.f;
+        profile.push_back(glm::vec2(std::cos(angle), std::sin(angle)) * 0.2f);
+    }
+
+    const std::vector<ExtrusionPoint> extrusionPoints = computeExtrusionPoints(sampleBezierCurve(curvePoints, segmentCount));
+    const double inputMB = peakRssMB();
+
+    Checksum checksum;
+    const double ms = bestOf(1, [&]() {
+        if(strcmp(mode, "mesh") == 0)
+        {
+            const CurveMeshData mesh = extrudeProfile(profile, extrusionPoints);
+            checksum.add(mesh.vertices, mesh.normals, mesh.indices);
+        }
+        else if(strcmp(mode, "blocks") == 0)
+        {
+            const CurveMeshView view = makeCurveMeshView(profile, extrusionPoints);
+            CurveMeshView::BlockIterator blocks = view.blocks();
+            while(blocks.next())
+            {
+                checksum.add(blocks.block().vertices, blocks.block().normals, blocks.block().indices);
+            }
+        }
+        else
+        {
+            // one ring at a time through the element ranges, the slowest way to read a view
+            const CurveMeshView view = makeCurveMeshView(profile, extrusionPoints);
+            std::vector<glm::vec3> vertices(view.ringSize()), normals(view.ringSize());
+            std::vector<unsigned int> indices;
+            for (size_t i = 0; i < view.ringCount(); i++)
+            {
+                for (size_t j = 0; j < view.ringSize(); j++)
+                {
+                    vertices[j] = view.vertices()[i * view.ringSize() + j];
+                    normals[j] = view.normals()[i * view.ringSize() + j];
+                }
+                indices.clear();
+                for (size_t k = 0; i + 1 < view.ringCount() && k < view.segmentIndexCount(); k++)
+                {
+                    indices.push_back(view.indices()[i * view.segmentIndexCount() + k]);
+                }
+                checksum.add(vertices, normals, indices);
+            }
+        }
+    });
+
+    printf("%s: %u segments, %zu vertices, %zu indices (checksum %.3f)\n", mode, segmentCount, checksum.vertexCount, checksum.indexCount, checksum.sum);
+    printf("  time            %10.1f ms\n", ms);
+    printf("  peak RSS        %10.1f MB\n", peakRssMB());
+    printf("  before reading  %10.1f MB\n", inputMB);
+
+    return 0;
+}
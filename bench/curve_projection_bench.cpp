@@ -0,0 +1,77 @@
+// Closest point queries on the demo curve: projection tree vs brute force over densely plotted points.
+// usage: bench_curve_projection [query count = 20000]
+
+#include "bench_utils.hpp"
+
+#include "curve_projection.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+
+
+int main(int argc, char **argv)
+{
+    const size_t queryCount = argc > 1 ? std::stoul(argv[1]) : 20000;
+    const unsigned int sampleCount = 20000;
+
+    const std::vector<BezierCurvePoint> curvePoints {
+        {{-5.f, 0.f, 0.f}, 0.3f},
+        {{-2.f, 7.f, -1.f}, 1.f},
+        {{5.f, 0.f, -2.f}, 1.f},
+        {{2.f, 7.f, -3.f}, 0.1f},
+    };
+
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> coordinate(-8.f, 8.f);
+    std::vector<glm::vec3> queries(queryCount);
+    for(auto& q : queries)
+    {
+        q = glm::vec3(coordinate(rng), coordinate(rng) * 0.5f + 3.f, coordinate(rng) * 0.3f);
+    }
+
+    CurveProjectionTree tree;
+    const double buildMs = bestOf(5, [&]() { tree = buildCurveProjectionTree(curvePoints); });
+
+    std::vector<CurveProjection> projections(queryCount);
+    const double treeMs = bestOf(3, [&]() {
+        for (size_t i = 0; i < queryCount; i++)
+        {
+            projections[i] = projectPointOntoCurve(tree, queries[i]);
+        }
+    });
+    const double batchMs = bestOf(3, [&]() { projections = projectPointsOntoCurve(tree, queries); });
+
+    const std::vector<glm::vec3> samples = plotBezierCurve(curvePoints, sampleCount);
+    std::vector<float> bruteDistances(queryCount);
+    const double bruteMs = bestOf(1, [&]() {
+        for (size_t i = 0; i < queryCount; i++)
+        {
+            float best = INFINITY;
+            for(const auto& p : samples)
+            {
+                best = std::min(best, glm::dot(p - queries[i], p - queries[i]));
+            }
+            bruteDistances[i] = std::sqrt(best);
+        }
+    });
+
+    // the tree should never be further than the closest sample
+    size_t worse = 0;
+    float maxGain = 0.f;
+    for (size_t i = 0; i < queryCount; i++)
+    {
+        worse += projections[i].distance > bruteDistances[i] + 1e-4f;
+        maxGain = std::max(maxGain, bruteDistances[i] - projections[i].distance);
+    }
+
+    printf("%zu queries, brute force over %u samples\n", queryCount, sampleCount);
+    printf("  tree build        %10.3f ms\n", buildMs);
+    printf("  tree, one thread  %10.3f us/query\n", treeMs * 1000.0 / queryCount);
+    printf("  tree, batch       %10.3f us/query\n", batchMs * 1000.0 / queryCount);
+    printf("  brute force       %10.3f us/query\n", bruteMs * 1000.0 / queryCount);
+    printf("  further than brute force: %zu, largest improvement %g\n", worse, maxGain);
+
+    return worse == 0 ? 0 : 1;
+}
@@ -0,0 +1,70 @@
+// Extruding circles of 4, 8, 16 and 32 vertices: runtime sized extrudeProfile vs the compile-time sized one.
+// usage: bench_fixed_profile [segment count = 200000]
+
+#include "bench_utils.hpp"
+
+#include "fixed_profile.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+
+// compared bit for bit, so that NaNs of degenerate segments count as equal
+template<typename V>
+static bool isSameData(const std::vector<V>& a, const std::vector<V>& b)
+{
+    return a.size() == b.size() && (a.empty() || memcmp(a.data(), b.data(), a.size() * sizeof(V)) == 0);
+}
+
+static bool isSameMesh(const CurveMeshData& a, const CurveMeshData& b)
+{
+    return isSameData(a.vertices, b.vertices) && isSameData(a.normals, b.normals) && isSameData(a.uvs, b.uvs) && isSameData(a.indices, b.indices)
+        && a.ringSize == b.ringSize && a.segmentIndexCount == b.segmentIndexCount;
+}
+
+template<size_t N>
+static bool compare(const std::vector<ExtrusionPoint>& extrusionPoints)
+{
+    const std::array<glm::vec2, N> profile = circleProfile<N>(0.5f);
+    const std::vector<glm::vec2> runtimeProfile(profile.begin(), profile.end());
+
+    // comparing the meshes first also warms up the heap for the timed runs
+    const bool isSame = isSameMesh(extrudeProfile(runtimeProfile, extrusionPoints), extrudeProfile<N>(profile, extrusionPoints));
+
+    // Runs of both extruders take turns and meshes are dropped within every run,
+    // so that neither of them pays for the other one's memory or gets a quieter moment of the machine.
+    double runtimeMs = 0.0, fixedMs = 0.0;
+    for (int r = 0; r < 7; r++)
+    {
+        const double runtimeRunMs = bestOf(1, [&]() { CurveMeshData mesh = extrudeProfile(runtimeProfile, extrusionPoints); });
+        const double fixedRunMs = bestOf(1, [&]() { CurveMeshData mesh = extrudeProfile<N>(profile, extrusionPoints); });
+        runtimeMs = r == 0 ? runtimeRunMs : std::min(runtimeMs, runtimeRunMs);
+        fixedMs = r == 0 ? fixedRunMs : std::min(fixedMs, fixedRunMs);
+    }
+    printf("  N = %2zu  runtime %9.2f ms  fixed %9.2f ms  speedup %5.2fx  %s\n",
+           N, runtimeMs, fixedMs, runtimeMs / fixedMs, isSame ? "identical" : "MESHES DIFFER");
+
+    return isSame;
+}
+
+int main(int argc, char **argv)
+{
+    const unsigned int segmentCount = argc > 1 ? std::stoul(argv[1]) : 200000;
+
+    const std::vector<BezierCurvePoint> curvePoints {
+        {{-5.f, 0.f, 0.f}, 0.3f},
+        {{-2.f, 7.f, -1.f}, 1.f},
+        {{5.f, 0.f, -2.f}, 1.f},
+        {{2.f, 7.f, -3.f}, 0.1f},
+    };
+    const std::vector<ExtrusionPoint> extrusionPoints = computeExtrusionPoints(plotBezierCurve(curvePoints, segmentCount));
+
+    printf("%u segments, %s ring transform\n", segmentCount, ringTransformKernelName());
+    bool isSame = compare<4>(extrusionPoints);
+    isSame = compare<8>(extrusionPoints) && isSame;
+    isSame = compare<16>(extrusionPoints) && isSame;
+    isSame = compare<32>(extrusionPoints) && isSame;
+
+    return isSame ? 0 : 1;
+}
@@ -0,0 +1,120 @@
+// Loading an OBJ file into Mesh::load's arrays: parseObjFile vs OBJ-Loader, when built with it.
+// Without a path, a torus of `resolution`² quads with normals is generated into the working directory.
+// usage: bench_obj_parser [resolution = 1000 | path/to/file.obj]
+
+#include "bench_utils.hpp"
+
+#include "obj_parser.hpp"
+
+#ifdef PROFILE_EXTRUDER_BENCH_OBJLOADER
+#include <OBJ_Loader.h>
+#endif
+
+#include <cmath>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+
+static bool writeTorus(const char *path, size_t resolution)
+{
+    FILE *file = fopen(path, "w");
+    if(!file)
+    {
+        return false;
+    }
+
+    const float tau = 6.2831853f;
+    for (size_t i = 0; i < resolution; i++)
+    {
+        for (size_t j = 0; j < resolution; j++)
+        {
+            const float u = tau * float(i) / float(resolution);
+            const float v = tau * float(j) / float(resolution);
+            const float r = 3.f + std::cos(v);
+            fprintf(file, "v %f %f %f\n", r * std::cos(u), std::sin(v), r * std::sin(u));
+            fprintf(file, "vn %f %f %f\n", std::cos(v) * std::cos(u), std::sin(v), std::cos(v) * std::sin(u));
+        }
+    }
+    for (size_t i = 0; i < resolution; i++)
+    {
+        for (size_t j = 0; j < resolution; j++)
+        {
+            const size_t a = i * resolution + j + 1;
+            const size_t b = i * resolution + (j + 1) % resolution + 1;
+            const size_t c = (i + 1) % resolution * resolution + (j + 1) % resolution + 1;
+            const size_t d = (i + 1) % resolution * resolution + j + 1;
+            fprintf(file, "f %zu//%zu %zu//%zu %zu//%zu %zu//%zu\n", a, a, d, d, c, c, b, b);
+        }
+    }
+
+    fclose(file);
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    std::string path = "bench_obj_parser.obj";
+    const bool isGenerated = argc < 2 || std::string(argv[1]).find(".obj") == std::string::npos;
+    if(isGenerated)
+    {
+        const size_t resolution = argc > 1 ? std::stoul(argv[1]) : 1000;
+        if(!writeTorus(path.c_str(), resolution))
+        {
+            printf("Failed to write %s\n", path.c_str());
+            return 1;
+        }
+    }
+    else
+    {
+        path = argv[1];
+    }
+
+    FILE *file = fopen(path.c_str(), "rb");
+    if(!file)
+    {
+        printf("Failed to open %s\n", path.c_str());
+        return 1;
+    }
+    fseek(file, 0, SEEK_END);
+    const double sizeMB = double(ftell(file)) / (1024.0 * 1024.0);
+    fclose(file);
+
+    printf("%s: %.1f MB, %u hardware threads\n", path.c_str(), sizeMB, std::thread::hardware_concurrency());
+
+    ObjMeshData mesh;
+    bool parsed = true;
+    const double parserMs = bestOf(3, [&]() {
+        parsed = parseObjFile(path.c_str(), mesh) && parsed;
+    });
+    if(!parsed)
+    {
+        return 1;
+    }
+    printf("parseObjFile: %9.1f ms, %zu vertices, %zu triangles\n", parserMs, mesh.vertices.size(), mesh.indices.size() / 3);
+
+#ifdef PROFILE_EXTRUDER_BENCH_OBJLOADER
+    size_t loaderVertexCount = 0, loaderIndexCount = 0;
+    const double loaderMs = bestOf(3, [&]() {
+        objl::Loader loader;
+        parsed = loader.LoadFile(path) && parsed;
+        loaderVertexCount = loader.LoadedVertices.size();
+        loaderIndexCount = loader.LoadedIndices.size();
+    });
+    if(!parsed)
+    {
+        return 1;
+    }
+    printf("OBJ-Loader:   %9.1f ms, %zu vertices, %zu triangles\n", loaderMs, loaderVertexCount, loaderIndexCount / 3);
+    printf("speedup:      %9.1fx\n", loaderMs / parserMs);
+#else
+    printf("OBJ-Loader:   not built, configure with -DPROFILE_EXTRUDER_BENCH_OBJLOADER=ON to compare\n");
+#endif
+
+    if(isGenerated)
+    {
+        remove(path.c_str());
+    }
+
+    return 0;
+}
@@ -0,0 +1,91 @@
+// Extruding a 4km curve 20km away from the origin: float, double with a local origin and chunked double.
+// Errors are the largest distance between a ring's center and its extrusion point computed in double.
+// usage: bench_precision [segment count = 200000] [segments per chunk = 1000]
+
+#include "bench_utils.hpp"
+
+#include "bezier_curve.hpp"
+#include "curve_mesh.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+
+// largest distance between the rings of `mesh`, placed at `origin`, and the extrusion points starting at `first`
+static double maxRingError(const CurveMeshData& mesh, size_t profileSize, const glm::dvec3& origin, const std::vector<ExtrusionPointD>& reference, size_t first)
+{
+    double error = 0.0;
+    const size_t ringCount = mesh.vertices.size() / mesh.ringSize;
+    for (size_t r = 0; r < ringCount; r++)
+    {
+        glm::dvec3 center(0.0);
+        for (size_t k = 0; k < profileSize; k++)
+        {
+            center += glm::dvec3(mesh.vertices[r * mesh.ringSize + k]);
+        }
+        center = center / double(profileSize) + origin;
+        error = std::max(error, glm::length(center - reference[first + r].position));
+    }
+
+    return error;
+}
+
+int main(int argc, char **argv)
+{
+    const unsigned int segmentCount = argc > 1 ? std::stoul(argv[1]) : 200000;
+    const unsigned int segmentsPerChunk = argc > 2 ? std::stoul(argv[2]) : 1000;
+
+    const glm::dvec3 offset(20000.0, 0.0, 20000.0 / std::sqrt(2.0));
+    const std::vector<BezierCurvePointD> curvePoints {
+        {offset + glm::dvec3(0.0, 0.0, 0.0), 1.0},
+        {offset + glm::dvec3(1000.0, 300.0, 1500.0), 1.0},
+        {offset + glm::dvec3(3000.0, -200.0, -1500.0), 1.0},
+        {offset + glm::dvec3(4000.0, 0.0, 0.0), 1.0},
+    };
+    std::vector<BezierCurvePoint> curvePointsF;
+    for(const auto& p : curvePoints)
+    {
+        curvePointsF.push_back({glm::vec3(p.position), float(p.ratio)});
+    }
+
+    // a 10cm pipe
+    std::vector<glm::vec2> profile;
+    for (int i = 0; i < 8; i++)
+    {
+        const float angle = 6.2831853f * float(i) / 8.f;
+        profile.push_back(glm::vec2(std::cos(angle), std::sin(angle)) * 0.05f);
+    }
+
+    const std::vector<ExtrusionPointD> reference = computeExtrusionPoints(plotBezierCurve(curvePoints, segmentCount));
+
+    CurveMeshData floatMesh;
+    const double floatMs = bestOf(3, [&]() { floatMesh = extrudeProfileWithCurve(profile, curvePointsF, segmentCount); });
+    const double floatError = maxRingError(floatMesh, profile.size(), glm::dvec3(0.0), reference, 0);
+
+    CurveMeshData doubleMesh;
+    const glm::dvec3 origin = curvePoints.front().position;
+    const double doubleMs = bestOf(3, [&]() { doubleMesh = extrudeProfileWithCurve(profile, curvePoints, segmentCount, ExtrusionOptions(), origin); });
+    const double doubleError = maxRingError(doubleMesh, profile.size(), origin, reference, 0);
+
+    std::vector<CurveMeshChunk> chunks;
+    const double chunkedMs = bestOf(3, [&]() {
+        chunks = extrudeProfileChunked(profile, computeExtrusionPoints(plotBezierCurve(curvePoints, segmentCount)), segmentsPerChunk);
+    });
+    double chunkedError = 0.0;
+    size_t first = 0;
+    for(const auto& chunk : chunks)
+    {
+        chunkedError = std::max(chunkedError, maxRingError(chunk.mesh, profile.size(), chunk.origin, reference, first));
+        // the boundary ring is in both chunks
+        first += chunk.mesh.vertices.size() / chunk.mesh.ringSize - 1;
+    }
+
+    printf("%u segments, 4km curve 20km from the origin\n", segmentCount);
+    printf("  float               %10.1f ms, max ring error %10.6f m\n", floatMs, floatError);
+    printf("  double, origin      %10.1f ms, max ring error %10.6f m\n", doubleMs, doubleError);
+    printf("  chunked, %6u/chunk %8.1f ms, max ring error %10.6f m, %zu chunks\n", segmentsPerChunk, chunkedMs, chunkedError, chunks.size());
+
+    // chunks are as precise as a single double mesh, or better
+    return first == segmentCount && chunkedError <= doubleError * 2.0 ? 0 : 1;
+}
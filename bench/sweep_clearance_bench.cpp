@@ -0,0 +1,74 @@
+// Clearance check of many cables routed through a cabinet: short curved sweeps, plus every tenth one routed
+// as a polyline whose straight runs are single segments across the whole volume, like extrudeProfileAlongPolyline makes them.
+// usage: bench_sweep_clearance [sweep count = 100000] [segments per curved sweep = 16]
+
+#include "bench_utils.hpp"
+
+#include "bezier_curve.hpp"
+#include "sweep_clearance.hpp"
+
+#include <cmath>
+#include <random>
+#include <string>
+#include <thread>
+
+
+int main(int argc, char **argv)
+{
+    const unsigned int sweepCount = argc > 1 ? std::stoul(argv[1]) : 100000;
+    const unsigned int segmentCount = argc > 2 ? std::stoul(argv[2]) : 16;
+
+    // a 5mm cable in a 20m cube, about as dense as 100k of them get
+    const float size = 20.f;
+    std::vector<glm::vec2> profile;
+    for (int i = 0; i < 8; i++)
+    {
+        const float angle = 6.2831853f * float(i) / 8.f;
+        profile.push_back(glm::vec2(std::cos(angle), std::sin(angle)) * 0.005f);
+    }
+
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> position(0.f, size);
+    std::uniform_real_distribution<float> offset(-0.3f, 0.3f);
+
+    std::vector<std::vector<Capsule>> sweeps(sweepCount);
+    size_t capsuleCount = 0;
+    for (unsigned int s = 0; s < sweepCount; s++)
+    {
+        const glm::vec3 start(position(random), position(random), position(random));
+        std::vector<ExtrusionPoint> extrusionPoints;
+        if(s % 10 == 0)
+        {
+            // along the axes from one corner of the cabinet to another
+            const glm::vec3 end(position(random), position(random), position(random));
+            const std::vector<glm::vec3> corners {start, glm::vec3(end.x, start.y, start.z), glm::vec3(end.x, end.y, start.z), end};
+            extrusionPoints = computeExtrusionPoints(corners);
+        }
+        else
+        {
+            const std::vector<BezierCurvePoint> curvePoints {
+                {start, 1.f},
+                {start + glm::vec3(offset(random), offset(random), offset(random)), 1.f},
+                {start + glm::vec3(offset(random), offset(random), offset(random)), 1.f},
+                {start + glm::vec3(offset(random), offset(random), offset(random)), 1.f},
+            };
+            extrusionPoints = computeExtrusionPoints(plotBezierCurve(curvePoints, segmentCount));
+        }
+        sweeps[s] = makeSweepCapsules(profile, extrusionPoints);
+        capsuleCount += sweeps[s].size();
+    }
+
+    ClearanceOptions options;
+    options.clearance = 0.002f;
+
+    ClearanceReport report;
+    const double ms = bestOf(3, [&]() { report = checkSweepClearance(sweeps, options); });
+
+    printf("%u sweeps, %zu segments, %u threads\n", sweepCount, capsuleCount, std::thread::hardware_concurrency());
+    printf("  time            %10.1f ms\n", ms);
+    printf("  violations      %10zu\n", report.violations.size());
+    printf("  tight bends     %10zu\n", report.tightBends.size());
+    printf("  peak RSS        %10.1f MB\n", peakRssMB());
+
+    return report.complete ? 0 : 1;
+}
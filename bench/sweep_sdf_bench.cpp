@@ -0,0 +1,193 @@
+// Distance field of a sweep: baked straight from its rings with bakeSweepSdf vs rasterized from its extruded mesh.
+// The mesh rasterizer is the plain way of doing it: every triangle writes the distance to itself into the voxels within
+// the band of its bounds. It only finds unsigned distances, and inside the sweep also those to the parts of the tube buried
+// where the curve crosses itself, so the two are compared outside the sweep, where both measure the same surface.
+// usage: bench_sweep_sdf [segment count = 2000] [voxel size = 0.05]
+
+#include "bench_utils.hpp"
+
+#include "sweep_sdf.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+
+struct RasterizedBlock
+{
+    glm::ivec3 block;
+    std::array<float, SDF_BLOCK_VOXELS> distances;
+};
+
+struct RasterizedSdf
+{
+    std::unordered_map<uint64_t, RasterizedBlock> blocks;
+};
+
+static uint64_t rasterBlockKey(int x, int y, int z)
+{
+    const uint64_t mask = (uint64_t(1) << 21) - 1;
+    return (uint64_t(x) & mask) << 42 | (uint64_t(y) & mask) << 21 | (uint64_t(z) & mask);
+}
+
+// closest point of the triangle to `p`, from Ericson's Real-Time Collision Detection
+static glm::vec3 closestPointOnTriangle(const glm::vec3& p, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c)
+{
+    const glm::vec3 ab = b - a, ac = c - a, ap = p - a;
+    const float d1 = glm::dot(ab, ap), d2 = glm::dot(ac, ap);
+    if(d1 <= 0.f && d2 <= 0.f)
+    {
+        return a;
+    }
+
+    const glm::vec3 bp = p - b;
+    const float d3 = glm::dot(ab, bp), d4 = glm::dot(ac, bp);
+    if(d3 >= 0.f && d4 <= d3)
+    {
+        return b;
+    }
+
+    const float vc = d1 * d4 - d3 * d2;
+    if(vc <= 0.f && d1 >= 0.f && d3 <= 0.f)
+    {
+        return a + ab * (d1 / (d1 - d3));
+    }
+
+    const glm::vec3 cp = p - c;
+    const float d5 = glm::dot(ab, cp), d6 = glm::dot(ac, cp);
+    if(d6 >= 0.f && d5 <= d6)
+    {
+        return c;
+    }
+
+    const float vb = d5 * d2 - d1 * d6;
+    if(vb <= 0.f && d2 >= 0.f && d6 <= 0.f)
+    {
+        return a + ac * (d2 / (d2 - d6));
+    }
+
+    const float va = d3 * d6 - d5 * d4;
+    if(va <= 0.f && d4 - d3 >= 0.f && d5 - d6 >= 0.f)
+    {
+        return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+    }
+
+    const float denominator = 1.f / (va + vb + vc);
+    return a + ab * (vb * denominator) + ac * (vc * denominator);
+}
+
+static RasterizedSdf rasterizeMesh(const CurveMeshData& mesh, const SdfBakeOptions& options)
+{
+    RasterizedSdf sdf;
+    for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+    {
+        const glm::vec3& a = mesh.vertices[mesh.indices[i]];
+        const glm::vec3& b = mesh.vertices[mesh.indices[i + 1]];
+        const glm::vec3& c = mesh.vertices[mesh.indices[i + 2]];
+
+        const glm::ivec3 first(glm::ceil((glm::min(glm::min(a, b), c) - options.bandWidth) / options.voxelSize));
+        const glm::ivec3 last(glm::floor((glm::max(glm::max(a, b), c) + options.bandWidth) / options.voxelSize));
+        for (int z = first.z; z <= last.z; z++)
+        {
+            for (int y = first.y; y <= last.y; y++)
+            {
+                for (int x = first.x; x <= last.x; x++)
+                {
+                    const glm::vec3 p = glm::vec3(x, y, z) * options.voxelSize;
+                    const float distance = glm::length(p - closestPointOnTriangle(p, a, b, c));
+                    if(distance >= options.bandWidth)
+                    {
+                        continue;
+                    }
+
+                    const int bx = int(std::floor(float(x) / SDF_BLOCK_SIZE));
+                    const int by = int(std::floor(float(y) / SDF_BLOCK_SIZE));
+                    const int bz = int(std::floor(float(z) / SDF_BLOCK_SIZE));
+                    auto inserted = sdf.blocks.try_emplace(rasterBlockKey(bx, by, bz));
+                    if(inserted.second)
+                    {
+                        inserted.first->second.block = glm::ivec3(bx, by, bz);
+                        inserted.first->second.distances.fill(options.bandWidth);
+                    }
+                    float& stored = inserted.first->second.distances[((z - bz * SDF_BLOCK_SIZE) * SDF_BLOCK_SIZE + (y - by * SDF_BLOCK_SIZE)) * SDF_BLOCK_SIZE + (x - bx * SDF_BLOCK_SIZE)];
+                    stored = std::min(stored, distance);
+                }
+            }
+        }
+    }
+
+    return sdf;
+}
+
+int main(int argc, char **argv)
+{
+    const unsigned int segmentCount = argc > 1 ? std::stoul(argv[1]) : 2000;
+    SdfBakeOptions options;
+    options.voxelSize = argc > 2 ? std::stof(argv[2]) : 0.05f;
+    options.bandWidth = options.voxelSize * 4.f;
+
+    const std::vector<BezierCurvePoint> curvePoints {
+        {{-5.f, 0.f, 0.f}, 0.3f},
+        {{-2.f, 7.f, -1.f}, 1.f},
+        {{5.f, 0.f, -2.f}, 1.f},
+        {{2.f, 7.f, -3.f}, 0.1f},
+    };
+    std::vector<glm::vec2> profile;
+    for (int i = 0; i < 16; i++)
+    {
+        const float angle = 6.2831853f * float(i) / 16.f;
+        profile.push_back(glm::vec2(std::cos(angle), std::sin(angle)) * 0.5f);
+    }
+    const std::vector<ExtrusionPoint> extrusionPoints = computeExtrusionPoints(plotBezierCurve(curvePoints, segmentCount));
+
+    SparseSdfGrid grid;
+    const double bakeMs = bestOf(3, [&]() { grid = bakeSweepSdf({makeSweepSdfSource(profile, extrusionPoints)}, options); });
+
+    ExtrusionOptions extrusionOptions;
+    extrusionOptions.startCap = true;
+    extrusionOptions.endCap = true;
+    RasterizedSdf rasterized;
+    size_t triangleCount = 0;
+    const double rasterizeMs = bestOf(3, [&]() {
+        const CurveMeshData mesh = extrudeProfile(profile, extrusionPoints, extrusionOptions);
+        triangleCount = mesh.indices.size() / 3;
+        rasterized = rasterizeMesh(mesh, options);
+    });
+
+    // outside, both measure the same surface, up to the mesh's triangles cutting the corners of the quads between the rings
+    double maxDifference = 0.0;
+    size_t voxelCount = 0;
+    for(const auto& entry : rasterized.blocks)
+    {
+        const RasterizedBlock& block = entry.second;
+        const glm::ivec3 firstVoxel = block.block * SDF_BLOCK_SIZE;
+        for (int v = 0; v < SDF_BLOCK_VOXELS; v++)
+        {
+            if(block.distances[v] >= options.bandWidth)
+            {
+                continue;
+            }
+            const glm::ivec3 voxel = firstVoxel + glm::ivec3(v % SDF_BLOCK_SIZE, v / SDF_BLOCK_SIZE % SDF_BLOCK_SIZE, v / (SDF_BLOCK_SIZE * SDF_BLOCK_SIZE));
+            const float baked = sampleSparseSdf(grid, glm::vec3(voxel) * options.voxelSize);
+            if(baked < 0.f)
+            {
+                continue;
+            }
+            maxDifference = std::max(maxDifference, double(std::abs(baked - block.distances[v])));
+            voxelCount++;
+        }
+    }
+
+    printf("%u segments, %zu triangles, voxel size %.3f, band %.3f, %u threads\n",
+           segmentCount, triangleCount, options.voxelSize, options.bandWidth, std::thread::hardware_concurrency());
+    printf("  baked from rings    %10.1f ms, %zu blocks\n", bakeMs, grid.blocks.size());
+    printf("  rasterized mesh     %10.1f ms, %zu blocks, single threaded, unsigned\n", rasterizeMs, rasterized.blocks.size());
+    printf("  max difference      %10.4f over %zu voxels outside\n", maxDifference, voxelCount);
+
+    // the surfaces differ by much less than a voxel
+    return maxDifference < options.voxelSize * 0.5 ? 0 : 1;
+}
@@ -0,0 +1,448 @@
+// profile-extrude: turns scene files into mesh files without a window or GPU.
+//
+// Scene files are plain text, one statement per line, '#' starts a comment:
+//
+//   profile <name> <x> <y> <x> <y> ...
+//   curve <profile name> <segment count> <output path> <x> <y> <z> <ratio> <x> <y> <z> <ratio> ...
+//
+// The segment count is between 1 and 2^24. Every statement that can't be used counts as a failure,
+// and any failure makes the tool exit with 1.
+//
+// A profile has to be defined before the curves that use it. The output format is picked from
+// the extension of the output path: .glb, .stl or .ply.
+//
+// The file is read line by line on the main thread while a pool of workers extrudes the curves
+// and another thread writes the finished meshes, so that parsing, extrusion and writing overlap.
+
+#include <bezier_curve.hpp>
+#include <curve_mesh.hpp>
+#include <mesh_export.hpp>
+
+#include <algorithm> // std::max
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib> // strtoul
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+
+// how many jobs may wait in a queue per worker before the stage feeding it is held back
+const size_t QUEUE_CAPACITY_PER_WORKER = 4;
+// more segments than this is surely a typo, and the vertex indices of the mesh would soon overflow
+const long long MAX_SEGMENT_COUNT = 1 << 24;
+
+
+// Queue between two stages of the pipeline. Push blocks while the queue is full, so a fast stage
+// can't run away from a slow one and fill the memory with meshes. Pop returns false once the queue
+// is closed and empty.
+template<typename T>
+class BoundedQueue
+{
+private:
+    std::deque<T> m_items;
+    size_t m_capacity;
+    bool m_closed;
+
+    std::mutex m_mutex;
+    std::condition_variable m_notEmpty;
+    std::condition_variable m_notFull;
+
+
+public:
+    BoundedQueue(size_t capacity) : m_capacity(std::max<size_t>(capacity, 1)), m_closed(false) {}
+
+    void push(T item)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_notFull.wait(lock, [this]() { return m_items.size() < m_capacity; });
+
+        m_items.push_back(std::move(item));
+        lock.unlock();
+        m_notEmpty.notify_one();
+    }
+
+    bool pop(T& item)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_notEmpty.wait(lock, [this]() { return m_closed || !m_items.empty(); });
+
+        if(m_items.empty())
+        {
+            return false;
+        }
+
+        item = std::move(m_items.front());
+        m_items.pop_front();
+        lock.unlock();
+        m_notFull.notify_one();
+        return true;
+    }
+
+    // no more items will be pushed
+    void close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_closed = true;
+        }
+        m_notEmpty.notify_all();
+    }
+};
+
+
+struct CurveJob
+{
+    size_t line;
+    std::shared_ptr<const std::vector<glm::vec2>> profile;
+    std::vector<BezierCurvePoint> curvePoints;
+    unsigned int segmentCount;
+    std::string outputPath;
+};
+
+struct MeshResult
+{
+    size_t line;
+    std::string outputPath;
+    CurveMeshData mesh;
+};
+
+struct Settings
+{
+    const char *scenePath = nullptr;
+    unsigned int threadCount = 0;
+    ExtrusionOptions options;
+};
+
+struct Statistics
+{
+    std::atomic<size_t> curves{0};
+    std::atomic<size_t> failed{0};
+    std::atomic<size_t> vertices{0};
+    std::atomic<size_t> triangles{0};
+    std::atomic<size_t> bytesWritten{0};
+};
+
+
+
+// ============= PARSING ============= //
+
+static bool endsWith(const std::string& s, const char *suffix)
+{
+    const size_t length = strlen(suffix);
+    return s.size() >= length && s.compare(s.size() - length, length, suffix) == 0;
+}
+
+static bool isSupportedOutput(const std::string& path)
+{
+    return endsWith(path, ".glb") || endsWith(path, ".stl") || endsWith(path, ".ply");
+}
+
+// reads the scene and hands every curve over to the workers
+static void parseScene(std::istream& input, BoundedQueue<CurveJob>& jobs, Statistics& stats)
+{
+    std::unordered_map<std::string, std::shared_ptr<const std::vector<glm::vec2>>> profiles;
+
+    std::string lineText;
+    size_t line = 0;
+    while(std::getline(input, lineText))
+    {
+        line++;
+
+        const size_t comment = lineText.find('#');
+        if(comment != std::string::npos)
+        {
+            lineText.resize(comment);
+        }
+
+        std::istringstream tokens(lineText);
+        std::string keyword;
+        if(!(tokens >> keyword))
+        {
+            continue;
+        }
+
+        if(keyword == "profile")
+        {
+            std::string name;
+            tokens >> name;
+
+            auto profile = std::make_shared<std::vector<glm::vec2>>();
+            glm::vec2 v;
+            while(tokens >> v.x >> v.y)
+            {
+                profile->push_back(v);
+            }
+
+            if(name.empty() || profile->size() < 3 || !tokens.eof())
+            {
+                printf("[ERROR] line %zu: profile needs a name and at least 3 vertices\n", line);
+                stats.failed++;
+                continue;
+            }
+
+            profiles[name] = std::move(profile);
+        }
+        else if(keyword == "curve")
+        {
+            CurveJob job;
+            job.line = line;
+
+            // read as signed, so that a negative count isn't taken for a huge one
+            std::string profileName;
+            long long segmentCount = 0;
+            tokens >> profileName >> segmentCount >> job.outputPath;
+            if(!tokens)
+            {
+                printf("[ERROR] line %zu: expected a profile name, segment count and output path\n", line);
+                stats.failed++;
+                continue;
+            }
+            if(segmentCount < 1 || segmentCount > MAX_SEGMENT_COUNT)
+            {
+                printf("[ERROR] line %zu: segment count has to be between 1 and %lld\n", line, MAX_SEGMENT_COUNT);
+                stats.failed++;
+                continue;
+            }
+            job.segmentCount = (unsigned int)segmentCount;
+
+            auto profile = profiles.find(profileName);
+            if(profile == profiles.end())
+            {
+                printf("[ERROR] line %zu: unknown profile '%s'\n", line, profileName.c_str());
+                stats.failed++;
+                continue;
+            }
+            job.profile = profile->second;
+
+            if(!isSupportedOutput(job.outputPath))
+            {
+                printf("[ERROR] line %zu: output '%s' is not a .glb, .stl or .ply file\n", line, job.outputPath.c_str());
+                stats.failed++;
+                continue;
+            }
+
+            BezierCurvePoint point;
+            while(tokens >> point.position.x >> point.position.y >> point.position.z >> point.ratio)
+            {
+                job.curvePoints.push_back(point);
+            }
+
+            if(job.curvePoints.size() < 2 || !tokens.eof())
+            {
+                printf("[ERROR] line %zu: curve needs at least 2 points, given as x y z ratio\n", line);
+                stats.failed++;
+                continue;
+            }
+
+            jobs.push(std::move(job));
+        }
+        else
+        {
+            printf("[ERROR] line %zu: unknown statement '%s'\n", line, keyword.c_str());
+            stats.failed++;
+        }
+    }
+}
+
+
+
+// ============= GENERATING ============= //
+
+static void extrudeJobs(BoundedQueue<CurveJob>& jobs, BoundedQueue<MeshResult>& results, const ExtrusionOptions& options, Statistics& stats)
+{
+    CurveJob job;
+    while(jobs.pop(job))
+    {
+        MeshResult result;
+        result.line = job.line;
+        result.outputPath = std::move(job.outputPath);
+        // a failing job, e.g. running out of memory, shouldn't take the other curves down with it
+        try
+        {
+            result.mesh = extrudeProfileWithCurve(*job.profile, job.curvePoints, job.segmentCount, options);
+        }
+        catch(const std::exception& e)
+        {
+            printf("[ERROR] line %zu: extrusion failed: %s\n", job.line, e.what());
+            stats.failed++;
+            continue;
+        }
+
+        if(result.mesh.vertices.empty())
+        {
+            printf("[ERROR] line %zu: extrusion failed\n", job.line);
+            stats.failed++;
+            continue;
+        }
+
+        results.push(std::move(result));
+    }
+}
+
+
+
+// ============= WRITING ============= //
+
+static size_t fileSize(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    return file ? size_t(file.tellg()) : 0;
+}
+
+static void writeMeshes(BoundedQueue<MeshResult>& results, Statistics& stats)
+{
+    MeshResult result;
+    while(results.pop(result))
+    {
+        bool written;
+        if(endsWith(result.outputPath, ".glb"))
+        {
+            written = exportGlb(result.mesh, result.outputPath.c_str());
+        }
+        else if(endsWith(result.outputPath, ".stl"))
+        {
+            written = exportStl(result.mesh, result.outputPath.c_str());
+        }
+        else
+        {
+            written = exportPly(result.mesh, result.outputPath.c_str());
+        }
+
+        if(!written)
+        {
+            printf("[ERROR] line %zu: could not write '%s'\n", result.line, result.outputPath.c_str());
+            stats.failed++;
+            continue;
+        }
+
+        stats.curves++;
+        stats.vertices += result.mesh.vertices.size();
+        stats.triangles += result.mesh.indices.size() / 3;
+        stats.bytesWritten += fileSize(result.outputPath);
+    }
+}
+
+
+
+// ============= MAIN ============= //
+
+static void printUsage()
+{
+    printf(
+        "Usage: profile-extrude [options] <scene file>\n"
+        "Reads the scene from standard input if the file is '-'.\n"
+        "\n"
+        "Options:\n"
+        "  -j <count>   number of extrusion threads, all hardware threads but two by default\n"
+        "  --caps       close both ends of every tube\n"
+        "  --seamless   share the first and last vertex of every ring instead of duplicating it\n"
+    );
+}
+
+static bool parseArguments(int argc, char *argv[], Settings& settings)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if(strcmp(argv[i], "-j") == 0 && i + 1 < argc)
+        {
+            settings.threadCount = (unsigned int)strtoul(argv[++i], nullptr, 10);
+        }
+        else if(strcmp(argv[i], "--caps") == 0)
+        {
+            settings.options.startCap = settings.options.endCap = true;
+        }
+        else if(strcmp(argv[i], "--seamless") == 0)
+        {
+            settings.options.seamless = true;
+        }
+        else if(argv[i][0] == '-' && argv[i][1] != '\0')
+        {
+            return false;
+        }
+        else if(!settings.scenePath)
+        {
+            settings.scenePath = argv[i];
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    return settings.scenePath != nullptr;
+}
+
+int main(int argc, char *argv[])
+{
+    Settings settings;
+    if(!parseArguments(argc, argv, settings))
+    {
+        printUsage();
+        return 2;
+    }
+
+    std::ifstream sceneFile;
+    std::istream *input = &std::cin;
+    if(strcmp(settings.scenePath, "-") != 0)
+    {
+        sceneFile.open(settings.scenePath);
+        if(!sceneFile)
+        {
+            printf("[ERROR] could not open '%s'\n", settings.scenePath);
+            return 1;
+        }
+        input = &sceneFile;
+    }
+
+    // the parser and the writer keep a thread each
+    unsigned int workerCount = settings.threadCount;
+    if(workerCount == 0)
+    {
+        workerCount = std::max(std::thread::hardware_concurrency(), 3u) - 2;
+    }
+
+    BoundedQueue<CurveJob> jobs(workerCount * QUEUE_CAPACITY_PER_WORKER);
+    BoundedQueue<MeshResult> results(workerCount * QUEUE_CAPACITY_PER_WORKER);
+    Statistics stats;
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> workers;
+    workers.reserve(workerCount);
+    for (unsigned int i = 0; i < workerCount; i++)
+    {
+        workers.emplace_back(extrudeJobs, std::ref(jobs), std::ref(results), std::cref(settings.options), std::ref(stats));
+    }
+    std::thread writer(writeMeshes, std::ref(results), std::ref(stats));
+
+    parseScene(*input, jobs, stats);
+    jobs.close();
+
+    for(auto& worker : workers)
+    {
+        worker.join();
+    }
+    results.close();
+    writer.join();
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const double megabytes = double(stats.bytesWritten) / (1024.0 * 1024.0);
+
+    printf("%zu curves written, %zu failed, using %u extrusion threads\n", size_t(stats.curves), size_t(stats.failed), workerCount);
+    printf("%zu vertices, %zu triangles, %.1f MB\n", size_t(stats.vertices), size_t(stats.triangles), megabytes);
+    printf("%.3f s, %.1f curves/s, %.1f MB/s\n", seconds, seconds > 0.0 ? stats.curves / seconds : 0.0, seconds > 0.0 ? megabytes / seconds : 0.0);
+
+    return stats.failed == 0 ? 0 : 1;
+}
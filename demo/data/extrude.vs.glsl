@@ -0,0 +1,89 @@
+#version 330 core
+
+// Reconstructs the extruded mesh purely from ring frames and the profile,
+// the vertex of a triangle is picked based on gl_VertexID, no vertex attributes are used.
+
+// ======== INPUT ========
+// 3 texels per ring: position, right axis, up axis
+uniform samplerBuffer uFrames;
+// one texel per profile vertex
+uniform samplerBuffer uProfile;
+uniform int uProfileSize;
+uniform int uRingCount;
+
+uniform mat4 uView;
+uniform mat4 uProjection;
+
+
+// ======== OUTPUT ========
+out VS_OUT {
+    vec3 position;
+    vec3 normal;
+    vec3 tint;
+} vs_out;
+
+
+// ======== FUNCTIONS ========
+vec3 ringVertex(int ring, int j)
+{
+    vec3 position = texelFetch(uFrames, ring * 3).xyz;
+    vec3 right = texelFetch(uFrames, ring * 3 + 1).xyz;
+    vec3 up = texelFetch(uFrames, ring * 3 + 2).xyz;
+    vec2 p = texelFetch(uProfile, (j + uProfileSize) % uProfileSize).xy;
+
+    return position + right * p.x + up * p.y;
+}
+
+// same as normals computed in extrudeProfile, based on faces of the next curve mesh segment
+vec3 normalAfter(int i, int j, vec3 vThis)
+{
+    vec3 vRight = ringVertex(i, j + 1);
+    vec3 vUp = ringVertex(i + 1, j);
+    vec3 vLeft = ringVertex(i, j - 1);
+
+    return normalize(cross(vRight - vThis, vUp - vThis) + cross(vUp - vThis, vLeft - vThis));
+}
+
+// and based on faces of the previous curve mesh segment
+vec3 normalBefore(int i, int j, vec3 vThis)
+{
+    vec3 vLeft = ringVertex(i, j - 1);
+    vec3 vDown = ringVertex(i - 1, j);
+    vec3 vRight = ringVertex(i, j + 1);
+
+    return normalize(cross(vLeft - vThis, vDown - vThis) + cross(vDown - vThis, vRight - vThis));
+}
+
+
+// ======== MAIN ========
+// corners of the two triangles of a quad as (ring offset, profile offset), in the order extrudeProfile uses
+const ivec2 QUAD_CORNERS[6] = ivec2[6](
+    ivec2(0, 0), ivec2(0, 1), ivec2(1, 1),
+    ivec2(0, 0), ivec2(1, 1), ivec2(1, 0)
+);
+
+void main()
+{
+    int quad = gl_VertexID / 6;
+    ivec2 corner = QUAD_CORNERS[gl_VertexID % 6];
+
+    int i = quad / uProfileSize + corner.x;
+    int j = (quad % uProfileSize + corner.y) % uProfileSize;
+
+    vec3 vertex = ringVertex(i, j);
+
+    vec3 normal;
+    if(i == 0) {
+        normal = normalAfter(i, j, vertex);
+    } else if(i == uRingCount - 1) {
+        normal = normalBefore(i, j, vertex);
+    } else {
+        normal = normalize(normalBefore(i, j, vertex) + normalAfter(i, j, vertex));
+    }
+
+    vs_out.position = vertex;
+    vs_out.normal = normal;
+    vs_out.tint = vec3(1.0);
+
+    gl_Position = uProjection * uView * vec4(vertex, 1.0);
+}
\ No newline at end of file
@@ -20,6 +20,8 @@ struct Light {
 in VS_OUT {
     vec3 position;
     vec3 normal;
+    // multiplies the diffuse color of the material
+    vec3 tint;
 } fs_in;
 
 uniform vec3 uCameraPosition;
@@ -42,8 +44,10 @@ void main()
     vec3 reflectDirection = reflect(-lightDirection, fs_in.normal);
     float specularImpact = pow(max(dot(viewDirection, reflectDirection), 0.0), uMaterial.shininess);
 
-    vec3 ambient = uLight.ambient * uMaterial.diffuse;
-    vec3 diffuse = uLight.diffuse * diffuseImpact * uMaterial.diffuse;
+    vec3 materialDiffuse = uMaterial.diffuse * fs_in.tint;
+
+    vec3 ambient = uLight.ambient * materialDiffuse;
+    vec3 diffuse = uLight.diffuse * diffuseImpact * materialDiffuse;
     vec3 specular = uLight.specular * specularImpact * uMaterial.specular;
 
     fs_out_color = vec4(ambient + diffuse + specular, 1.0);
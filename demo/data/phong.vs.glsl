@@ -1,8 +1,8 @@
 #version 330 core
 
 // ======== INPUT ========
-in vec3 avPosition;
-in vec3 avNormal;
+layout(location = 0) in vec3 avPosition;
+layout(location = 1) in vec3 avNormal;
 
 uniform vec3 uTranslation = vec3(0.0, 0.0, 0.0);
 uniform float uScale = 1.0;
@@ -14,6 +14,7 @@ uniform mat4 uProjection;
 out VS_OUT {
     vec3 position;
     vec3 normal;
+    vec3 tint;
 } vs_out;
 
 
@@ -24,6 +25,7 @@ void main()
 
     vs_out.position = vertex;
     vs_out.normal = avNormal;
+    vs_out.tint = vec3(1.0);
 
     gl_Position = uProjection * uView * vec4(vertex, 1.0);
 }
\ No newline at end of file
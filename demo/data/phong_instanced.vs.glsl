@@ -0,0 +1,33 @@
+#version 330 core
+
+// ======== INPUT ========
+layout(location = 0) in vec3 avPosition;
+layout(location = 1) in vec3 avNormal;
+// per instance
+layout(location = 2) in vec3 aiTranslation;
+layout(location = 3) in float aiScale;
+layout(location = 4) in vec3 aiColor;
+
+uniform mat4 uView;
+uniform mat4 uProjection;
+
+
+// ======== OUTPUT ========
+out VS_OUT {
+    vec3 position;
+    vec3 normal;
+    vec3 tint;
+} vs_out;
+
+
+// ======== MAIN ========
+void main()
+{
+    vec3 vertex = avPosition * aiScale + aiTranslation;
+
+    vs_out.position = vertex;
+    vs_out.normal = avNormal;
+    vs_out.tint = aiColor;
+
+    gl_Position = uProjection * uView * vec4(vertex, 1.0);
+}
\ No newline at end of file
@@ -1,6 +1,8 @@
 #include "utils/shader_program.hpp"
 #include "utils/camera.hpp"
 #include "utils/mesh.hpp"
+#include "utils/mesh_pool.hpp"
+#include "utils/gpu_curve_mesh.hpp"
 #include "utils/light.hpp"
 #include "utils/material.hpp"
 
@@ -8,6 +10,7 @@
 #include <GL/glew.h>
 #include <SDL_opengl.h>
 #include <glm/gtc/type_ptr.hpp>
+#include <async_extruder.hpp>
 #include <bezier_curve.hpp>
 #include <curve_mesh.hpp>
 #include <imgui.h>
@@ -15,6 +18,11 @@
 #include <imgui_impl_sdl.h>
 #include <imgui_impl_opengl3.h>
 
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <exception>
+#include <future>
 #include <vector>
 
 
@@ -26,6 +34,7 @@
 namespace imgui = ImGui;
 
 
+GLuint shader;
 GLint unifLocTranslation;
 GLint unifLocScale;
 GLint unifLocView;
@@ -40,6 +49,24 @@ GLint unifLocLightAmbient;
 GLint unifLocLightDiffuse;
 GLint unifLocLightSpecular;
 
+GLuint instancedShader;
+GLint unifLocInstancedView;
+GLint unifLocInstancedProjection;
+
+GLuint extrusionShader;
+GLint unifLocExtrusionProfileSize;
+GLint unifLocExtrusionRingCount;
+GLint unifLocExtrusionView;
+GLint unifLocExtrusionProjection;
+GLint unifLocExtrusionCameraPosition;
+GLint unifLocExtrusionMaterialDiffuse;
+GLint unifLocExtrusionMaterialSpecular;
+GLint unifLocExtrusionMaterialShininess;
+GLint unifLocExtrusionLightPosition;
+GLint unifLocExtrusionLightAmbient;
+GLint unifLocExtrusionLightDiffuse;
+GLint unifLocExtrusionLightSpecular;
+
 
 Light light {
     glm::vec3(0.f, 10.f, 5.f),
@@ -49,7 +76,9 @@ Light light {
     glm::vec3(0.8f, 0.8f, 0.8f)
 };
 
-Mesh *curveMesh;
+// curve meshes share buffers and are drawn with a single indirect call
+MeshPool *curveMeshPool;
+MeshPool::MeshId curveMeshId = MeshPool::INVALID_MESH;
 Material curveMaterial {
     {0.1f, 0.9, 1.0f},
     {0.1f, 1.f, 0.9f},
@@ -58,6 +87,9 @@ Material curveMaterial {
 
 Mesh *sphereMesh;
 
+GpuCurveMesh *gpuCurveMesh;
+bool useGpuExtrusion = false;
+
 Camera camera;
 
 
@@ -79,6 +111,7 @@ std::vector<BezierCurvePoint> curvePoints {
     {{2.f, 7.f, -3.f}, 0.1f},
 };
 int segmentCount = 50;
+ExtrusionOptions extrusionOptions;
 
 
 bool isInEditorMode = false;
@@ -89,6 +122,22 @@ SDL_Cursor *cursorHand;
 const float DRAGGING_SPEED = 0.02f;
 
 CurveMeshData curveMeshData;
+std::atomic<float> extrusionTimeNs(0.f);
+size_t uploadSize = 0;
+
+// the curve mesh is extruded in the background and swapped in once it's ready,
+// meanwhile the previous one is still being drawn
+AsyncExtruder *asyncExtruder;
+std::future<CurveMeshData> pendingCurveMeshData;
+const unsigned int CURVE_MESH_JOB_KEY = 0;
+
+// what the last job was submitted with, so that a new one is only submitted after an edit
+std::vector<BezierCurvePoint> submittedCurvePoints;
+int submittedSegmentCount = -1;
+ExtrusionOptions submittedExtrusionOptions;
+// same for the frames last uploaded for the GPU path
+std::vector<BezierCurvePoint> gpuCurvePoints;
+int gpuSegmentCount = -1;
 
 
 
@@ -189,6 +238,10 @@ void debugWindow()
             }
 
             imgui::SliderInt("Segment count##curve", &segmentCount, 1, 200);
+            imgui::Checkbox("Start cap##curve", &extrusionOptions.startCap);
+            imgui::SameLine();
+            imgui::Checkbox("End cap##curve", &extrusionOptions.endCap);
+            imgui::Checkbox("GPU extrusion (no caps)##curve", &useGpuExtrusion);
 
             imgui::Text("Point 1");
             imgui::SameLine();
@@ -231,6 +284,30 @@ void debugWindow()
             imgui::EndTabItem();
         }
 
+        if(imgui::BeginTabItem("Stats"))
+        {
+            imgui::Text("Ring transform kernel: %s", ringTransformKernelName());
+            imgui::Text("Vertices: %d", (int)curveMeshData.vertices.size());
+            imgui::Text("Uploaded per edit: %d bytes", (int)uploadSize);
+            const float timeNs = extrusionTimeNs;
+            imgui::Text("Extrusion time: %.3f ms", timeNs / 1000000.f);
+            if(timeNs > 0.f)
+            {
+                imgui::Text("Throughput: %.3f vertices/ns", (float)curveMeshData.vertices.size() / timeNs);
+            }
+
+            const RangeAllocator& vertexRanges = curveMeshPool->vertexRanges();
+            const RangeAllocator& indexRanges = curveMeshPool->indexRanges();
+            imgui::Text("Mesh pool vertices: %d / %d in use, %d free ranges", (int)vertexRanges.used(), (int)vertexRanges.capacity(), (int)vertexRanges.freeRangeCount());
+            imgui::Text("Mesh pool indices: %d / %d in use, %d free ranges", (int)indexRanges.used(), (int)indexRanges.capacity(), (int)indexRanges.freeRangeCount());
+            if(imgui::Button("Defragment mesh pool"))
+            {
+                curveMeshPool->defragment();
+            }
+
+            imgui::EndTabItem();
+        }
+
         imgui::EndTabBar();
     }
 
@@ -259,6 +336,109 @@ void disableLighting()
     glUniform3f(unifLocLightSpecular, 0.f, 0.f, 0.f);
 }
 
+// whether the curve differs from the one a mesh was last made from
+bool isCurveChanged(const std::vector<BezierCurvePoint>& madeFromPoints, int madeFromSegmentCount)
+{
+    if(segmentCount != madeFromSegmentCount || curvePoints.size() != madeFromPoints.size())
+    {
+        return true;
+    }
+
+    for (size_t i = 0; i < curvePoints.size(); i++)
+    {
+        if(curvePoints[i].position != madeFromPoints[i].position || curvePoints[i].ratio != madeFromPoints[i].ratio)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool isCurveEdited()
+{
+    return isCurveChanged(submittedCurvePoints, submittedSegmentCount)
+        || extrusionOptions.startCap != submittedExtrusionOptions.startCap
+        || extrusionOptions.endCap != submittedExtrusionOptions.endCap;
+}
+
+// supersedes the job that may still be running for the previous edit
+void extrudeCurveMesh()
+{
+    submittedCurvePoints = curvePoints;
+    submittedSegmentCount = segmentCount;
+    submittedExtrusionOptions = extrusionOptions;
+
+    pendingCurveMeshData = asyncExtruder->submit(CURVE_MESH_JOB_KEY,
+        [shape = profile, points = curvePoints, count = segmentCount, options = extrusionOptions](const std::atomic<bool> *cancelled) {
+            ExtrusionOptions jobOptions = options;
+            jobOptions.cancelled = cancelled;
+
+            auto start = std::chrono::steady_clock::now();
+            CurveMeshData mesh = extrudeProfileWithCurve(shape, points, count, jobOptions);
+            auto end = std::chrono::steady_clock::now();
+
+            if(!mesh.vertices.empty())
+            {
+                extrusionTimeNs = (float)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+            }
+            return mesh;
+        }
+    );
+}
+
+// never waits for the job, just checks if it's done
+void swapInCurveMesh()
+{
+    if(!pendingCurveMeshData.valid() || pendingCurveMeshData.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+    {
+        return;
+    }
+
+    // a failed job, e.g. out of memory with too many segments, keeps the previous mesh on screen
+    CurveMeshData mesh;
+    try
+    {
+        mesh = pendingCurveMeshData.get();
+    }
+    catch(const std::exception& e)
+    {
+        printf("[ERROR][%s(%d)] Extruding the curve mesh failed: %s\n", __FILE__, __LINE__, e.what());
+        return;
+    }
+    // a job that got superseded leaves an empty mesh behind
+    if(mesh.vertices.empty())
+    {
+        return;
+    }
+
+    curveMeshData = std::move(mesh);
+    // only the range of this mesh in the pool's buffers is rewritten
+    if(curveMeshId == MeshPool::INVALID_MESH)
+    {
+        curveMeshId = curveMeshPool->add(curveMeshData.vertices, curveMeshData.normals, curveMeshData.indices);
+    }
+    else
+    {
+        curveMeshPool->update(curveMeshId, curveMeshData.vertices, curveMeshData.normals, curveMeshData.indices);
+    }
+    uploadSize = curveMeshData.vertices.size() * sizeof(glm::vec3) * 2 + curveMeshData.indices.size() * sizeof(unsigned int);
+}
+
+// only ring frames are computed on the CPU, the rest is done by extrude.vs.glsl
+void extrudeGpuCurveMesh()
+{
+    gpuCurvePoints = curvePoints;
+    gpuSegmentCount = segmentCount;
+
+    // exact tangents, same as the CPU extruders use
+    std::vector<BezierCurveSample> samples = sampleBezierCurve(curvePoints, segmentCount);
+    std::vector<ExtrusionPoint> extrusionPoints = computeExtrusionPoints(samples);
+    std::vector<RingFrame> frames = computeRingFrames(extrusionPoints, glm::vec3(0.f), ExtrusionOptions());
+
+    uploadSize = gpuCurveMesh->loadFrames(frames);
+}
+
 void renderMesh(const Mesh* mesh, const Material& material, glm::vec3 translation = glm::vec3(0.f), float scale = 1.f)
 {
     glUniform3fv(unifLocTranslation, 1, glm::value_ptr(translation));
@@ -271,6 +451,38 @@ void renderMesh(const Mesh* mesh, const Material& material, glm::vec3 translatio
     mesh->draw();
 }
 
+void renderCurveMeshes(const Material& material)
+{
+    glUniform3fv(unifLocTranslation, 1, glm::value_ptr(glm::vec3(0.f)));
+    glUniform1f(unifLocScale, 1.f);
+
+    glUniform3fv(unifLocMaterialDiffuse, 1, glm::value_ptr(material.diffuse));
+    glUniform3fv(unifLocMaterialSpecular, 1, glm::value_ptr(material.specular));
+    glUniform1f(unifLocMaterialShininess, material.shininess);
+
+    curveMeshPool->draw();
+}
+
+void renderGpuCurveMesh()
+{
+    // extrusion shader shares the fragment shader with the main one, so it needs the same uniforms
+    glUseProgram(extrusionShader);
+    glUniformMatrix4fv(unifLocExtrusionView, 1, GL_FALSE, glm::value_ptr(camera.getView()));
+    glUniformMatrix4fv(unifLocExtrusionProjection, 1, GL_FALSE, glm::value_ptr(camera.getProjection()));
+    glUniform3fv(unifLocExtrusionCameraPosition, 1, glm::value_ptr(camera.getPosition()));
+    glUniform3fv(unifLocExtrusionMaterialDiffuse, 1, glm::value_ptr(curveMaterial.diffuse));
+    glUniform3fv(unifLocExtrusionMaterialSpecular, 1, glm::value_ptr(curveMaterial.specular));
+    glUniform1f(unifLocExtrusionMaterialShininess, curveMaterial.shininess);
+    glUniform3fv(unifLocExtrusionLightPosition, 1, glm::value_ptr(light.position));
+    glUniform3fv(unifLocExtrusionLightAmbient, 1, glm::value_ptr(light.ambient));
+    glUniform3fv(unifLocExtrusionLightDiffuse, 1, glm::value_ptr(light.diffuse));
+    glUniform3fv(unifLocExtrusionLightSpecular, 1, glm::value_ptr(light.specular));
+
+    gpuCurveMesh->draw(unifLocExtrusionProfileSize, unifLocExtrusionRingCount);
+
+    glUseProgram(shader);
+}
+
 void renderLightSphere()
 {
     glUniform3fv(unifLocTranslation, 1, glm::value_ptr(light.position));
@@ -285,6 +497,37 @@ void renderLightSphere()
 
 
 
+void renderControlPoints()
+{
+    const glm::vec3 disabledPointColor = {1.f, 1.f, 0.f};
+    const glm::vec3 enabledPointColor = {0.f, 1.f, 0.f};
+
+    std::vector<MeshInstance> instances;
+    instances.reserve(curvePoints.size());
+    for (int i = 0; i < curvePoints.size(); i++)
+    {
+        instances.push_back({
+            curvePoints[i].position,
+            0.05f,
+            i == selectedCurvePoint ? enabledPointColor : disabledPointColor
+        });
+    }
+    sphereMesh->loadInstances(instances);
+
+    // all points are drawn with a single call
+    glUseProgram(instancedShader);
+    glUniformMatrix4fv(unifLocInstancedView, 1, GL_FALSE, glm::value_ptr(camera.getView()));
+    glUniformMatrix4fv(unifLocInstancedProjection, 1, GL_FALSE, glm::value_ptr(camera.getProjection()));
+
+    sphereMesh->drawInstanced();
+
+    glUseProgram(shader);
+}
+
+
+
+
+
 int main(int argc, char const *argv[])
 {
     if(SDL_Init(SDL_INIT_VIDEO | SDL_INIT_EVENTS) < 0)
@@ -335,7 +578,38 @@ int main(int argc, char const *argv[])
     SDL_GL_SetSwapInterval(1);
 
 
-    GLuint shader = loadShaderProgramFromFiles("data/phong.vs.glsl", "data/phong.fs.glsl");
+    shader = loadShaderProgramFromFiles("data/phong.vs.glsl", "data/phong.fs.glsl");
+    instancedShader = loadShaderProgramFromFiles("data/phong_instanced.vs.glsl", "data/phong.fs.glsl");
+
+    // instances are only used for gizmos, which don't need lighting;
+    // the color comes purely from instance's tint applied to the ambient term
+    glUseProgram(instancedShader);
+    unifLocInstancedView = glGetUniformLocation(instancedShader, "uView");
+    unifLocInstancedProjection = glGetUniformLocation(instancedShader, "uProjection");
+    glUniform3f(glGetUniformLocation(instancedShader, "uMaterial.diffuse"), 1.f, 1.f, 1.f);
+    glUniform3f(glGetUniformLocation(instancedShader, "uMaterial.specular"), 0.f, 0.f, 0.f);
+    glUniform1f(glGetUniformLocation(instancedShader, "uMaterial.shininess"), 1.f);
+    glUniform3f(glGetUniformLocation(instancedShader, "uLight.ambient"), 1.f, 1.f, 1.f);
+    glUniform3f(glGetUniformLocation(instancedShader, "uLight.diffuse"), 0.f, 0.f, 0.f);
+    glUniform3f(glGetUniformLocation(instancedShader, "uLight.specular"), 0.f, 0.f, 0.f);
+
+    extrusionShader = loadShaderProgramFromFiles("data/extrude.vs.glsl", "data/phong.fs.glsl");
+    glUseProgram(extrusionShader);
+    unifLocExtrusionProfileSize = glGetUniformLocation(extrusionShader, "uProfileSize");
+    unifLocExtrusionRingCount = glGetUniformLocation(extrusionShader, "uRingCount");
+    unifLocExtrusionView = glGetUniformLocation(extrusionShader, "uView");
+    unifLocExtrusionProjection = glGetUniformLocation(extrusionShader, "uProjection");
+    unifLocExtrusionCameraPosition = glGetUniformLocation(extrusionShader, "uCameraPosition");
+    unifLocExtrusionMaterialDiffuse = glGetUniformLocation(extrusionShader, "uMaterial.diffuse");
+    unifLocExtrusionMaterialSpecular = glGetUniformLocation(extrusionShader, "uMaterial.specular");
+    unifLocExtrusionMaterialShininess = glGetUniformLocation(extrusionShader, "uMaterial.shininess");
+    unifLocExtrusionLightPosition = glGetUniformLocation(extrusionShader, "uLight.position");
+    unifLocExtrusionLightAmbient = glGetUniformLocation(extrusionShader, "uLight.ambient");
+    unifLocExtrusionLightDiffuse = glGetUniformLocation(extrusionShader, "uLight.diffuse");
+    unifLocExtrusionLightSpecular = glGetUniformLocation(extrusionShader, "uLight.specular");
+    glUniform1i(glGetUniformLocation(extrusionShader, "uFrames"), 0);
+    glUniform1i(glGetUniformLocation(extrusionShader, "uProfile"), 1);
+
     glUseProgram(shader);
 
     unifLocTranslation = glGetUniformLocation(shader, "uTranslation");
@@ -353,15 +627,23 @@ int main(int argc, char const *argv[])
     unifLocLightSpecular = glGetUniformLocation(shader, "uLight.specular");
 
 
-    curveMesh = new Mesh();
+    curveMeshPool = new MeshPool();
     sphereMesh = new Mesh();
     sphereMesh->load("data/sphere.obj");
 
+    gpuCurveMesh = new GpuCurveMesh();
+    gpuCurveMesh->loadProfile(profile);
+
 
     camera.setPosition(glm::vec3(0.f, 3.5f, 10.f));
 
-    curveMeshData = extrudeProfileWithCurve(profile, curvePoints, segmentCount);
-    curveMesh->load(curveMeshData.vertices, curveMeshData.normals, curveMeshData.indices);
+    asyncExtruder = new AsyncExtruder();
+
+    // the first mesh is waited for, so that there's always something to draw
+    extrudeCurveMesh();
+    pendingCurveMeshData.wait();
+    swapInCurveMesh();
+    extrudeGpuCurveMesh();
 
 
     SDL_Event e;
@@ -417,11 +699,29 @@ int main(int argc, char const *argv[])
 
         if(isInEditorMode)
         {
-            curveMeshData = extrudeProfileWithCurve(profile, curvePoints, segmentCount);
-            curveMesh->load(curveMeshData.vertices, curveMeshData.normals, curveMeshData.indices);
+            // the GPU path only uploads frames when the curve changes, like the CPU path only extrudes then
+            if(useGpuExtrusion)
+            {
+                if(isCurveChanged(gpuCurvePoints, gpuSegmentCount))
+                {
+                    extrudeGpuCurveMesh();
+                }
+            }
+            else if(isCurveEdited())
+            {
+                extrudeCurveMesh();
+            }
         }
+        swapInCurveMesh();
 
-        renderMesh(curveMesh, curveMaterial);
+        if(useGpuExtrusion)
+        {
+            renderGpuCurveMesh();
+        }
+        else
+        {
+            renderCurveMeshes(curveMaterial);
+        }
 
         disableLighting();
         
@@ -432,29 +732,7 @@ int main(int argc, char const *argv[])
             // so that points are visible no matter what
             glClear(GL_DEPTH_BUFFER_BIT);
 
-            Material disabledPointMat {
-                {1.f, 1.f, 0.f},
-                {1.f, 1.f, 0.f},
-                0.f
-            };
-            Material enabledPointMat {
-                {0.f, 1.f, 0.f},
-                {0.f, 1.f, 0.f},
-                0.f
-            };
-
-            for (int i = 0; i < curvePoints.size(); i++)
-            {
-                if(i == selectedCurvePoint)
-                {
-                    renderMesh(sphereMesh, enabledPointMat, curvePoints[i].position, 0.05f);
-                }
-                else
-                {
-                    renderMesh(sphereMesh, disabledPointMat, curvePoints[i].position, 0.05f);
-                }
-                
-            }
+            renderControlPoints();
         }
 
 
@@ -462,8 +740,12 @@ int main(int argc, char const *argv[])
         SDL_GL_SwapWindow(window);
     }
 
-    delete curveMesh; 
+    // the workers have to be gone before anything a job may use is destroyed
+    delete asyncExtruder;
+
+    delete curveMeshPool;
     delete sphereMesh;
+    delete gpuCurveMesh;
 
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplSDL2_Shutdown();
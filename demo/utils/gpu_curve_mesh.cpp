@@ -0,0 +1,102 @@
+#include "gpu_curve_mesh.hpp"
+
+GpuCurveMesh::GpuCurveMesh()
+{
+    // core profile doesn't allow drawing without a VAO, even if it has no attributes
+    glCreateVertexArrays(1, &m_vao);
+
+    glCreateBuffers(1, &m_tboFrames);
+    glCreateBuffers(1, &m_tboProfile);
+    glGenTextures(1, &m_texFrames);
+    glGenTextures(1, &m_texProfile);
+
+    glBindBuffer(GL_TEXTURE_BUFFER, m_tboFrames);
+    glBufferData(GL_TEXTURE_BUFFER, 0, nullptr, GL_DYNAMIC_DRAW);
+    glBindTexture(GL_TEXTURE_BUFFER, m_texFrames);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, m_tboFrames);
+
+    glBindBuffer(GL_TEXTURE_BUFFER, m_tboProfile);
+    glBufferData(GL_TEXTURE_BUFFER, 0, nullptr, GL_STATIC_DRAW);
+    glBindTexture(GL_TEXTURE_BUFFER, m_texProfile);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RG32F, m_tboProfile);
+
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+    m_ringCount = m_profileSize = m_framesCapacity = 0;
+}
+
+GpuCurveMesh::~GpuCurveMesh()
+{
+    glDeleteTextures(1, &m_texFrames);
+    glDeleteTextures(1, &m_texProfile);
+    glDeleteBuffers(1, &m_tboFrames);
+    glDeleteBuffers(1, &m_tboProfile);
+    glDeleteVertexArrays(1, &m_vao);
+}
+
+void GpuCurveMesh::loadProfile(const std::vector<glm::vec2>& profile)
+{
+    m_profileSize = profile.size();
+
+    glBindBuffer(GL_TEXTURE_BUFFER, m_tboProfile);
+    glBufferData(GL_TEXTURE_BUFFER, profile.size() * sizeof(glm::vec2), profile.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+size_t GpuCurveMesh::loadFrames(const std::vector<RingFrame>& frames)
+{
+    m_ringCount = frames.size();
+
+    // one 3x4 matrix per ring, as 4 component texels are the closest fitting format
+    std::vector<glm::vec4> texels;
+    texels.reserve(frames.size() * 3);
+    for(const auto& frame : frames)
+    {
+        texels.push_back(glm::vec4(frame.position, 1.f));
+        texels.push_back(glm::vec4(frame.right, 0.f));
+        texels.push_back(glm::vec4(frame.up, 0.f));
+    }
+
+    const size_t size = texels.size() * sizeof(glm::vec4);
+
+    glBindBuffer(GL_TEXTURE_BUFFER, m_tboFrames);
+    if(size > m_framesCapacity)
+    {
+        glBufferData(GL_TEXTURE_BUFFER, size, texels.data(), GL_DYNAMIC_DRAW);
+        m_framesCapacity = size;
+    }
+    else
+    {
+        glBufferSubData(GL_TEXTURE_BUFFER, 0, size, texels.data());
+    }
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+    return size;
+}
+
+void GpuCurveMesh::draw(GLint unifLocProfileSize, GLint unifLocRingCount) const
+{
+    if(m_ringCount < 2 || m_profileSize < 2)
+    {
+        return;
+    }
+
+    glUniform1i(unifLocProfileSize, m_profileSize);
+    glUniform1i(unifLocRingCount, m_ringCount);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_BUFFER, m_texFrames);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_BUFFER, m_texProfile);
+
+    glBindVertexArray(m_vao);
+        // two triangles for every quad between two rings
+        glDrawArrays(GL_TRIANGLES, 0, (m_ringCount - 1) * m_profileSize * 6);
+    glBindVertexArray(0);
+
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+}
\ No newline at end of file
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <ring_transform.hpp>
+
+#include <vector>
+
+
+// Curve mesh generated on the GPU by extrude.vs.glsl.
+// Only ring frames and the profile are uploaded, vertices are reconstructed in the vertex shader.
+class GpuCurveMesh
+{
+private:
+    GLuint m_vao;
+    GLuint m_tboFrames;
+    GLuint m_texFrames;
+    GLuint m_tboProfile;
+    GLuint m_texProfile;
+
+    size_t m_ringCount;
+    size_t m_profileSize;
+    size_t m_framesCapacity;
+
+
+public:
+    GpuCurveMesh();
+    ~GpuCurveMesh();
+
+    void loadProfile(const std::vector<glm::vec2>& profile);
+    // returns the number of bytes uploaded
+    size_t loadFrames(const std::vector<RingFrame>& frames);
+
+    // the extrusion shader must be in use, its uFrames and uProfile samplers are bound to texture units 0 and 1
+    void draw(GLint unifLocProfileSize, GLint unifLocRingCount) const;
+};
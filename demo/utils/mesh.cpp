@@ -1,6 +1,9 @@
 #include "mesh.hpp"
 
-#include "OBJ_Loader.h"
+#include "obj_parser.hpp"
+
+#include <cstddef> // offsetof
+#include <cstdio>
 
 Mesh::Mesh()
 {
@@ -8,6 +11,7 @@ Mesh::Mesh()
     glCreateBuffers(1, &m_vboNormals);
     // glCreateBuffers(1, &m_vboUVs);
     glCreateBuffers(1, &m_ibo);
+    glCreateBuffers(1, &m_vboInstances);
     glCreateVertexArrays(1, &m_vao);
 
     glBindVertexArray(m_vao);
@@ -25,11 +29,21 @@ Mesh::Mesh()
         // glBufferData(GL_ARRAY_BUFFER, 0, nullptr, GL_STATIC_DRAW);
         // glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
 
+        glBindBuffer(GL_ARRAY_BUFFER, m_vboInstances);
+        glBufferData(GL_ARRAY_BUFFER, 0, nullptr, GL_DYNAMIC_DRAW);
+        glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(MeshInstance), (void *)offsetof(MeshInstance, translation));
+        glVertexAttribDivisor(2, 1);
+        glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, sizeof(MeshInstance), (void *)offsetof(MeshInstance, scale));
+        glVertexAttribDivisor(3, 1);
+        glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(MeshInstance), (void *)offsetof(MeshInstance, color));
+        glVertexAttribDivisor(4, 1);
+
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ibo);
         glBufferData(GL_ELEMENT_ARRAY_BUFFER, 0, nullptr, GL_STATIC_DRAW);
     glBindVertexArray(0);
 
     m_iboSize = m_iboCapacity = 0;
+    m_instanceCount = m_instanceCapacity = 0;
 }
 
 Mesh::~Mesh()
@@ -38,6 +52,7 @@ Mesh::~Mesh()
     glDeleteBuffers(1, &m_vboNormals);
     // glDeleteBuffers(1, &m_vboUVs);
     glDeleteBuffers(1, &m_ibo);
+    glDeleteBuffers(1, &m_vboInstances);
     glDeleteVertexArrays(1, &m_vao);
 }
 
@@ -82,24 +97,39 @@ void Mesh::load(const std::vector<glm::vec3>& vertices,
 
 void Mesh::load(const char *objPath)
 {
-    objl::Loader loader;    
+    ObjMeshData data;
 
-    if(!loader.LoadFile(objPath))
+    if(!parseObjFile(objPath, data))
     {
         printf("Failed to load mesh: %s\n", objPath);
         return;
     }
 
-    std::vector<glm::vec3> vertices(loader.LoadedVertices.size());
-    std::vector<glm::vec3> normals(loader.LoadedVertices.size());
+    load(data.vertices, data.normals, data.indices);
+}
+
+void Mesh::loadInstances(const std::vector<MeshInstance>& instances)
+{
+    m_instanceCount = instances.size();
 
-    for(unsigned int i = 0; i < loader.LoadedVertices.size(); i++)
+    glBindBuffer(GL_ARRAY_BUFFER, m_vboInstances);
+    if(m_instanceCount > m_instanceCapacity)
     {
-        vertices[i] = glm::vec3(loader.LoadedVertices[i].Position.X, loader.LoadedVertices[i].Position.Y, loader.LoadedVertices[i].Position.Z);
-        normals[i] = glm::vec3(loader.LoadedVertices[i].Normal.X, loader.LoadedVertices[i].Normal.Y, loader.LoadedVertices[i].Normal.Z);
+        glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(MeshInstance), instances.data(), GL_DYNAMIC_DRAW);
+        m_instanceCapacity = m_instanceCount;
+    }
+    else
+    {
+        glBufferSubData(GL_ARRAY_BUFFER, 0, instances.size() * sizeof(MeshInstance), instances.data());
     }
 
-    load(vertices, normals, loader.LoadedIndices);
+    // instance attributes are enabled only once there is some data to read them from,
+    // the regular shader doesn't use them anyway
+    glBindVertexArray(m_vao);
+        glEnableVertexAttribArray(2);
+        glEnableVertexAttribArray(3);
+        glEnableVertexAttribArray(4);
+    glBindVertexArray(0);
 }
 
 void Mesh::draw() const
@@ -108,3 +138,15 @@ void Mesh::draw() const
         glDrawElements(GL_TRIANGLES, m_iboSize, GL_UNSIGNED_INT, nullptr);
     glBindVertexArray(0);
 }
+
+void Mesh::drawInstanced() const
+{
+    if(m_instanceCount == 0)
+    {
+        return;
+    }
+
+    glBindVertexArray(m_vao);
+        glDrawElementsInstanced(GL_TRIANGLES, m_iboSize, GL_UNSIGNED_INT, nullptr, m_instanceCount);
+    glBindVertexArray(0);
+}
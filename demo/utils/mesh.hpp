@@ -6,6 +6,15 @@
 #include <vector>
 
 
+// per instance attributes used by phong_instanced.vs.glsl
+struct MeshInstance
+{
+    glm::vec3 translation;
+    float scale;
+    glm::vec3 color;
+};
+
+
 class Mesh
 {
 private:
@@ -13,11 +22,15 @@ private:
     GLuint m_vboNormals;
     // GLuint m_vboUVs;
     GLuint m_ibo;
+    GLuint m_vboInstances;
     GLuint m_vao;
 
     size_t m_iboSize;
     size_t m_iboCapacity;
 
+    size_t m_instanceCount;
+    size_t m_instanceCapacity;
+
 
 public:
     Mesh();
@@ -30,5 +43,9 @@ public:
 
     void load(const char *objPath);
 
+    void loadInstances(const std::vector<MeshInstance>& instances);
+
     void draw() const;
+    // draws all instances given with loadInstances() at once
+    void drawInstanced() const;
 };
\ No newline at end of file
@@ -0,0 +1,300 @@
+#include "mesh_pool.hpp"
+
+#include <algorithm> // std::max
+#include <cstdio>
+
+
+// ranges are a quarter bigger than the mesh, so that small edits fit in place
+static size_t withHeadroom(size_t count)
+{
+    return count + count / 4;
+}
+
+// Buffers are only ever bound to the copy targets, which no VAO state depends on.
+// The demo asks for a GL 3.3 context, so direct state access can't be relied on.
+static void createBuffer(GLuint& buffer, size_t size)
+{
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        glBufferData(GL_COPY_WRITE_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+static void writeBuffer(GLuint buffer, size_t offset, size_t size, const void *data)
+{
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, offset, size, data);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+static void copyBuffer(GLuint from, GLuint to, size_t fromOffset, size_t toOffset, size_t size)
+{
+    glBindBuffer(GL_COPY_READ_BUFFER, from);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, to);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, fromOffset, toOffset, size);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+MeshPool::MeshPool(size_t vertexCapacity, size_t indexCapacity)
+{
+    glGenVertexArrays(1, &m_vao);
+    glGenBuffers(1, &m_indirectBuffer);
+    m_vboVertices = m_vboNormals = m_ibo = 0;
+
+    m_indirectCapacity = 0;
+    m_commandsOutdated = true;
+
+    reallocate(vertexCapacity, indexCapacity);
+}
+
+MeshPool::~MeshPool()
+{
+    glDeleteBuffers(1, &m_vboVertices);
+    glDeleteBuffers(1, &m_vboNormals);
+    glDeleteBuffers(1, &m_ibo);
+    glDeleteBuffers(1, &m_indirectBuffer);
+    glDeleteVertexArrays(1, &m_vao);
+}
+
+void MeshPool::reallocate(size_t vertexCapacity, size_t indexCapacity)
+{
+    GLuint vboVertices, vboNormals, ibo;
+    createBuffer(vboVertices, vertexCapacity * sizeof(glm::vec3));
+    createBuffer(vboNormals, vertexCapacity * sizeof(glm::vec3));
+    createBuffer(ibo, indexCapacity * sizeof(unsigned int));
+
+    m_vertexRanges.reset(vertexCapacity);
+    m_indexRanges.reset(indexCapacity);
+
+    // live meshes are copied over on the GPU, in the order of their ids
+    for(auto& mesh : m_meshes)
+    {
+        if(!mesh.live)
+        {
+            continue;
+        }
+
+        const size_t firstVertex = m_vertexRanges.allocate(mesh.vertexCapacity);
+        const size_t firstIndex = m_indexRanges.allocate(mesh.indexCapacity);
+
+        copyBuffer(m_vboVertices, vboVertices, mesh.firstVertex * sizeof(glm::vec3), firstVertex * sizeof(glm::vec3), mesh.vertexCount * sizeof(glm::vec3));
+        copyBuffer(m_vboNormals, vboNormals, mesh.firstVertex * sizeof(glm::vec3), firstVertex * sizeof(glm::vec3), mesh.vertexCount * sizeof(glm::vec3));
+        copyBuffer(m_ibo, ibo, mesh.firstIndex * sizeof(unsigned int), firstIndex * sizeof(unsigned int), mesh.indexCount * sizeof(unsigned int));
+
+        mesh.firstVertex = firstVertex;
+        mesh.firstIndex = firstIndex;
+    }
+
+    glDeleteBuffers(1, &m_vboVertices);
+    glDeleteBuffers(1, &m_vboNormals);
+    glDeleteBuffers(1, &m_ibo);
+    m_vboVertices = vboVertices;
+    m_vboNormals = vboNormals;
+    m_ibo = ibo;
+
+    glBindVertexArray(m_vao);
+        glBindBuffer(GL_ARRAY_BUFFER, m_vboVertices);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
+
+        glBindBuffer(GL_ARRAY_BUFFER, m_vboNormals);
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
+
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ibo);
+    glBindVertexArray(0);
+
+    m_commandsOutdated = true;
+}
+
+void MeshPool::allocateRanges(MeshRanges& ranges, size_t vertexCount, size_t indexCount)
+{
+    ranges.vertexCount = vertexCount;
+    ranges.indexCount = indexCount;
+    ranges.vertexCapacity = withHeadroom(vertexCount);
+    ranges.indexCapacity = withHeadroom(indexCount);
+
+    ranges.firstVertex = m_vertexRanges.allocate(ranges.vertexCapacity);
+    ranges.firstIndex = m_indexRanges.allocate(ranges.indexCapacity);
+    if(ranges.firstVertex != RangeAllocator::INVALID_OFFSET && ranges.firstIndex != RangeAllocator::INVALID_OFFSET)
+    {
+        return;
+    }
+
+    // Whatever did fit is given back and the buffers are rebuilt without this mesh.
+    // They only grow if compacting them wouldn't make enough room.
+    if(ranges.firstVertex != RangeAllocator::INVALID_OFFSET)
+    {
+        m_vertexRanges.free(ranges.firstVertex, ranges.vertexCapacity);
+    }
+    if(ranges.firstIndex != RangeAllocator::INVALID_OFFSET)
+    {
+        m_indexRanges.free(ranges.firstIndex, ranges.indexCapacity);
+    }
+
+    size_t vertexCapacity = m_vertexRanges.capacity();
+    while(m_vertexRanges.used() + ranges.vertexCapacity > vertexCapacity)
+    {
+        vertexCapacity = std::max<size_t>(vertexCapacity * 2, 1);
+    }
+    size_t indexCapacity = m_indexRanges.capacity();
+    while(m_indexRanges.used() + ranges.indexCapacity > indexCapacity)
+    {
+        indexCapacity = std::max<size_t>(indexCapacity * 2, 1);
+    }
+
+    reallocate(vertexCapacity, indexCapacity);
+
+    ranges.firstVertex = m_vertexRanges.allocate(ranges.vertexCapacity);
+    ranges.firstIndex = m_indexRanges.allocate(ranges.indexCapacity);
+}
+
+void MeshPool::freeRanges(MeshRanges& ranges)
+{
+    m_vertexRanges.free(ranges.firstVertex, ranges.vertexCapacity);
+    m_indexRanges.free(ranges.firstIndex, ranges.indexCapacity);
+}
+
+void MeshPool::upload(const MeshRanges& ranges, const std::vector<glm::vec3>& vertices, const std::vector<glm::vec3>& normals, const std::vector<unsigned int>& indices)
+{
+    writeBuffer(m_vboVertices, ranges.firstVertex * sizeof(glm::vec3), vertices.size() * sizeof(glm::vec3), vertices.data());
+    writeBuffer(m_vboNormals, ranges.firstVertex * sizeof(glm::vec3), normals.size() * sizeof(glm::vec3), normals.data());
+    writeBuffer(m_ibo, ranges.firstIndex * sizeof(unsigned int), indices.size() * sizeof(unsigned int), indices.data());
+}
+
+MeshPool::MeshId MeshPool::add(const std::vector<glm::vec3>& vertices, const std::vector<glm::vec3>& normals, const std::vector<unsigned int>& indices)
+{
+    if(normals.size() != vertices.size())
+    {
+        printf("[ERROR][%s(%d)] Every vertex needs a normal\n", __FILE__, __LINE__);
+        return INVALID_MESH;
+    }
+
+    MeshId id;
+    if(!m_freeIds.empty())
+    {
+        id = m_freeIds.back();
+        m_freeIds.pop_back();
+    }
+    else
+    {
+        id = m_meshes.size();
+        m_meshes.push_back(MeshRanges{});
+    }
+
+    // allocating may reallocate the buffers, which must not see this mesh yet
+    MeshRanges ranges{};
+    allocateRanges(ranges, vertices.size(), indices.size());
+    ranges.live = true;
+    m_meshes[id] = ranges;
+
+    upload(ranges, vertices, normals, indices);
+    m_commandsOutdated = true;
+
+    return id;
+}
+
+void MeshPool::update(MeshId mesh, const std::vector<glm::vec3>& vertices, const std::vector<glm::vec3>& normals, const std::vector<unsigned int>& indices)
+{
+    if(mesh >= m_meshes.size() || !m_meshes[mesh].live || normals.size() != vertices.size())
+    {
+        printf("[ERROR][%s(%d)] Invalid mesh update\n", __FILE__, __LINE__);
+        return;
+    }
+
+    MeshRanges& ranges = m_meshes[mesh];
+    if(vertices.size() > ranges.vertexCapacity || indices.size() > ranges.indexCapacity)
+    {
+        freeRanges(ranges);
+        ranges.live = false;
+
+        MeshRanges moved{};
+        allocateRanges(moved, vertices.size(), indices.size());
+        moved.live = true;
+        m_meshes[mesh] = moved;
+    }
+    else
+    {
+        ranges.vertexCount = vertices.size();
+        ranges.indexCount = indices.size();
+    }
+
+    upload(m_meshes[mesh], vertices, normals, indices);
+    m_commandsOutdated = true;
+}
+
+void MeshPool::remove(MeshId mesh)
+{
+    if(mesh >= m_meshes.size() || !m_meshes[mesh].live)
+    {
+        return;
+    }
+
+    freeRanges(m_meshes[mesh]);
+    m_meshes[mesh].live = false;
+    m_freeIds.push_back(mesh);
+    m_commandsOutdated = true;
+}
+
+void MeshPool::defragment()
+{
+    reallocate(m_vertexRanges.capacity(), m_indexRanges.capacity());
+}
+
+void MeshPool::draw()
+{
+    const bool hasMultiDrawIndirect = GLEW_VERSION_4_3 || GLEW_ARB_multi_draw_indirect;
+
+    if(m_commandsOutdated)
+    {
+        m_commands.clear();
+        for(const auto& mesh : m_meshes)
+        {
+            if(mesh.live && mesh.indexCount > 0)
+            {
+                m_commands.push_back({(GLuint)mesh.indexCount, 1, (GLuint)mesh.firstIndex, (GLint)mesh.firstVertex, 0});
+            }
+        }
+
+        // the indirect buffer is only needed, and its target only exists, where multi-draw indirect does
+        const size_t size = m_commands.size() * sizeof(DrawElementsIndirectCommand);
+        if(hasMultiDrawIndirect && size > m_indirectCapacity)
+        {
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_indirectBuffer);
+                glBufferData(GL_DRAW_INDIRECT_BUFFER, size, m_commands.data(), GL_DYNAMIC_DRAW);
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+            m_indirectCapacity = size;
+        }
+        else if(hasMultiDrawIndirect)
+        {
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_indirectBuffer);
+                glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, size, m_commands.data());
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        }
+
+        m_commandsOutdated = false;
+    }
+
+    if(m_commands.empty())
+    {
+        return;
+    }
+
+    glBindVertexArray(m_vao);
+    if(hasMultiDrawIndirect)
+    {
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_indirectBuffer);
+            glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, m_commands.size(), 0);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    }
+    else
+    {
+        // same draws one by one
+        for(const auto& command : m_commands)
+        {
+            glDrawElementsBaseVertex(GL_TRIANGLES, command.count, GL_UNSIGNED_INT, (void *)(command.firstIndex * sizeof(unsigned int)), command.baseVertex);
+        }
+    }
+    glBindVertexArray(0);
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "range_allocator.hpp"
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+
+
+// Many meshes sharing one VAO and one set of buffers, drawn with a single glMultiDrawElementsIndirect.
+// Every mesh gets its own range of vertices and indices in the shared buffers, with some room to grow,
+// so updating a mesh only rewrites its own range. Buffers grow and get compacted when they run out of space.
+// Needs GL 3.3 only, where multi-draw indirect is missing the meshes are drawn one by one.
+class MeshPool
+{
+public:
+    typedef unsigned int MeshId;
+    static const MeshId INVALID_MESH = ~0u;
+
+
+private:
+    struct MeshRanges
+    {
+        bool live;
+        size_t firstVertex;
+        size_t vertexCount;
+        size_t vertexCapacity;
+        size_t firstIndex;
+        size_t indexCount;
+        size_t indexCapacity;
+    };
+
+    // layout required by glMultiDrawElementsIndirect
+    struct DrawElementsIndirectCommand
+    {
+        GLuint count;
+        GLuint instanceCount;
+        GLuint firstIndex;
+        GLint baseVertex;
+        GLuint baseInstance;
+    };
+
+    GLuint m_vao;
+    GLuint m_vboVertices;
+    GLuint m_vboNormals;
+    GLuint m_ibo;
+    GLuint m_indirectBuffer;
+
+    RangeAllocator m_vertexRanges;
+    RangeAllocator m_indexRanges;
+
+    std::vector<MeshRanges> m_meshes;
+    std::vector<MeshId> m_freeIds;
+
+    std::vector<DrawElementsIndirectCommand> m_commands;
+    size_t m_indirectCapacity;
+    bool m_commandsOutdated;
+
+    // moves all meshes to new buffers of the given capacities, packed one after another
+    void reallocate(size_t vertexCapacity, size_t indexCapacity);
+    // finds ranges for the mesh, growing or compacting the buffers if needed
+    void allocateRanges(MeshRanges& ranges, size_t vertexCount, size_t indexCount);
+    void freeRanges(MeshRanges& ranges);
+    void upload(const MeshRanges& ranges, const std::vector<glm::vec3>& vertices, const std::vector<glm::vec3>& normals, const std::vector<unsigned int>& indices);
+
+
+public:
+    MeshPool(size_t vertexCapacity = 1 << 16, size_t indexCapacity = 1 << 18);
+    ~MeshPool();
+
+    MeshPool(const MeshPool&) = delete;
+    MeshPool& operator=(const MeshPool&) = delete;
+
+    // indices are relative to the mesh's own vertices, like for a standalone mesh
+    MeshId add(const std::vector<glm::vec3>& vertices,
+               const std::vector<glm::vec3>& normals,
+               const std::vector<unsigned int>& indices);
+
+    void update(MeshId mesh,
+                const std::vector<glm::vec3>& vertices,
+                const std::vector<glm::vec3>& normals,
+                const std::vector<unsigned int>& indices);
+
+    void remove(MeshId mesh);
+
+    // packs all meshes at the start of the buffers, so that the free space is in one piece
+    void defragment();
+
+    // draws all meshes with the currently bound shader
+    void draw();
+
+    size_t meshCount() const { return m_meshes.size() - m_freeIds.size(); }
+    const RangeAllocator& vertexRanges() const { return m_vertexRanges; }
+    const RangeAllocator& indexRanges() const { return m_indexRanges; }
+};
@@ -0,0 +1,433 @@
+#include "obj_parser.hpp"
+
+#include <algorithm> // std::min
+#include <charconv> // std::from_chars
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <utility> // std::swap
+
+#ifdef _WIN32
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+// files smaller than this are not worth splitting between threads
+const size_t MIN_CHUNK_SIZE = 1 << 20;
+
+
+// read-only view of the whole file, mapped into memory where possible
+class MappedFile
+{
+private:
+    const char *m_data;
+    size_t m_size;
+#ifdef _WIN32
+    std::vector<char> m_buffer;
+#endif
+
+public:
+    MappedFile() : m_data(nullptr), m_size(0) {}
+
+    ~MappedFile()
+    {
+#ifndef _WIN32
+        if(m_data && m_size > 0)
+        {
+            munmap((void *)m_data, m_size);
+        }
+#endif
+    }
+
+    bool open(const char *path)
+    {
+#ifdef _WIN32
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if(!file.is_open())
+        {
+            return false;
+        }
+
+        m_buffer.resize((size_t)file.tellg());
+        file.seekg(0);
+        file.read(m_buffer.data(), m_buffer.size());
+
+        m_data = m_buffer.data();
+        m_size = m_buffer.size();
+        return true;
+#else
+        int fd = ::open(path, O_RDONLY);
+        if(fd < 0)
+        {
+            return false;
+        }
+
+        struct stat st;
+        if(fstat(fd, &st) != 0)
+        {
+            ::close(fd);
+            return false;
+        }
+
+        m_size = st.st_size;
+        if(m_size > 0)
+        {
+            void *mapped = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if(mapped == MAP_FAILED)
+            {
+                ::close(fd);
+                return false;
+            }
+
+            madvise(mapped, m_size, MADV_SEQUENTIAL);
+            m_data = (const char *)mapped;
+        }
+
+        ::close(fd);
+        return true;
+#endif
+    }
+
+    const char *data() const { return m_data; }
+    size_t size() const { return m_size; }
+};
+
+
+
+// index in a face statement, which can be absolute (1-based) or relative to the last element read so far
+struct ObjIndex
+{
+    int64_t value;
+    bool isRelative;
+};
+
+struct ObjCorner
+{
+    ObjIndex position;
+    ObjIndex normal;
+};
+
+struct ObjChunk
+{
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec3> normals;
+    std::vector<ObjCorner> corners; // three per triangle
+
+    // for resolving relative indices, the number of elements in all previous chunks
+    size_t positionOffset = 0;
+    size_t normalOffset = 0;
+};
+
+
+static const char *skipSpaces(const char *p, const char *end)
+{
+    while(p < end && (*p == ' ' || *p == '\t'))
+    {
+        p++;
+    }
+    return p;
+}
+
+static const char *parseVec3(const char *p, const char *end, glm::vec3& v)
+{
+    for (int i = 0; i < 3; i++)
+    {
+        p = skipSpaces(p, end);
+        auto result = std::from_chars(p, end, v[i]);
+        if(result.ec != std::errc())
+        {
+            v[i] = 0.f;
+        }
+        p = result.ptr;
+    }
+    return p;
+}
+
+// parses a single `v/vt/vn` corner, a missing normal index results in a value of -1
+static const char *parseCorner(const char *p, const char *end, const ObjChunk& chunk, ObjCorner& corner)
+{
+    auto parseIndex = [&](ObjIndex& index, size_t countSoFar) {
+        long long value = 0;
+        auto result = std::from_chars(p, end, value);
+        p = result.ptr;
+
+        if(value < 0)
+        {
+            // relative to the elements of this chunk, resolved once all chunks are parsed
+            index = {(int64_t)countSoFar + value, true};
+        }
+        else
+        {
+            index = {value - 1, false};
+        }
+    };
+
+    corner.normal = {-1, false};
+
+    parseIndex(corner.position, chunk.positions.size());
+    if(p < end && *p == '/')
+    {
+        p++;
+        // texture coordinates are not used
+        while(p < end && *p != '/' && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n')
+        {
+            p++;
+        }
+        if(p < end && *p == '/')
+        {
+            p++;
+            parseIndex(corner.normal, chunk.normals.size());
+        }
+    }
+
+    return p;
+}
+
+static void parseChunk(const char *p, const char *end, ObjChunk& chunk)
+{
+    std::vector<ObjCorner> polygon;
+
+    while(p < end)
+    {
+        const char *lineEnd = p;
+        while(lineEnd < end && *lineEnd != '\n')
+        {
+            lineEnd++;
+        }
+
+        p = skipSpaces(p, lineEnd);
+        if(lineEnd - p >= 2 && p[0] == 'v' && p[1] == ' ')
+        {
+            glm::vec3 v;
+            parseVec3(p + 2, lineEnd, v);
+            chunk.positions.push_back(v);
+        }
+        else if(lineEnd - p >= 3 && p[0] == 'v' && p[1] == 'n' && p[2] == ' ')
+        {
+            glm::vec3 n;
+            parseVec3(p + 3, lineEnd, n);
+            chunk.normals.push_back(n);
+        }
+        else if(lineEnd - p >= 2 && p[0] == 'f' && p[1] == ' ')
+        {
+            polygon.clear();
+
+            const char *q = skipSpaces(p + 2, lineEnd);
+            while(q < lineEnd && *q != '\r')
+            {
+                ObjCorner corner;
+                const char *next = parseCorner(q, lineEnd, chunk, corner);
+                if(next == q)
+                {
+                    break;
+                }
+                polygon.push_back(corner);
+                q = skipSpaces(next, lineEnd);
+            }
+
+            for (size_t i = 2; i < polygon.size(); i++)
+            {
+                chunk.corners.push_back(polygon[0]);
+                chunk.corners.push_back(polygon[i - 1]);
+                chunk.corners.push_back(polygon[i]);
+            }
+        }
+
+        p = lineEnd + 1;
+    }
+}
+
+
+
+const uint64_t EMPTY_CORNER_KEY = ~uint64_t(0);
+
+// open addressing hash map from (position, normal) index pairs to output vertex indices
+class CornerMap
+{
+private:
+    std::vector<uint64_t> m_keys;
+    std::vector<unsigned int> m_values;
+    size_t m_mask;
+    size_t m_size;
+    unsigned int m_shift;
+
+    // Fibonacci hashing, the top bits of the product depend on all bits of the key
+    size_t slotOf(uint64_t key) const
+    {
+        return (size_t)((key * 0x9E3779B97F4A7C15ull) >> m_shift);
+    }
+
+    void grow()
+    {
+        std::vector<uint64_t> keys(m_keys.size() * 2, EMPTY_CORNER_KEY);
+        std::vector<unsigned int> values(keys.size());
+        std::swap(keys, m_keys);
+        std::swap(values, m_values);
+        m_mask = m_keys.size() - 1;
+        m_shift--;
+
+        for (size_t i = 0; i < keys.size(); i++)
+        {
+            if(keys[i] != EMPTY_CORNER_KEY)
+            {
+                size_t slot = slotOf(keys[i]);
+                while(m_keys[slot] != EMPTY_CORNER_KEY)
+                {
+                    slot = (slot + 1) & m_mask;
+                }
+                m_keys[slot] = keys[i];
+                m_values[slot] = values[i];
+            }
+        }
+    }
+
+public:
+    explicit CornerMap(size_t expectedSize)
+    {
+        size_t capacity = 16;
+        m_shift = 60;
+        while(capacity < expectedSize * 2)
+        {
+            capacity <<= 1;
+            m_shift--;
+        }
+
+        m_keys.assign(capacity, EMPTY_CORNER_KEY);
+        m_values.resize(capacity);
+        m_mask = capacity - 1;
+        m_size = 0;
+    }
+
+    // returns the value stored under the key, or inserts `value` if there was none
+    unsigned int findOrInsert(uint64_t key, unsigned int value)
+    {
+        size_t slot = slotOf(key);
+        while(m_keys[slot] != EMPTY_CORNER_KEY)
+        {
+            if(m_keys[slot] == key)
+            {
+                return m_values[slot];
+            }
+            slot = (slot + 1) & m_mask;
+        }
+
+        m_keys[slot] = key;
+        m_values[slot] = value;
+
+        // keep the table at most half full
+        if(++m_size * 2 > m_keys.size())
+        {
+            grow();
+        }
+
+        return value;
+    }
+};
+
+bool parseObjFile(const char *path, ObjMeshData& mesh)
+{
+    MappedFile file;
+    if(!file.open(path))
+    {
+        printf("Failed to open file: %s\n", path);
+        return false;
+    }
+
+    const char *begin = file.data();
+    const char *end = begin + file.size();
+
+    // split the file into chunks of whole lines
+    size_t threadCount = std::max(1u, std::thread::hardware_concurrency());
+    threadCount = std::min(threadCount, file.size() / MIN_CHUNK_SIZE + 1);
+
+    std::vector<const char *> boundaries;
+    boundaries.push_back(begin);
+    for (size_t t = 1; t < threadCount; t++)
+    {
+        const char *p = std::max(begin + file.size() * t / threadCount, boundaries.back());
+        while(p < end && *p != '\n')
+        {
+            p++;
+        }
+        boundaries.push_back(p < end ? p + 1 : end);
+    }
+    boundaries.push_back(end);
+
+    std::vector<ObjChunk> chunks(threadCount);
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < threadCount; t++)
+    {
+        threads.emplace_back(parseChunk, boundaries[t], boundaries[t + 1], std::ref(chunks[t]));
+    }
+    parseChunk(boundaries[0], boundaries[1], chunks[0]);
+    for(auto& thread : threads)
+    {
+        thread.join();
+    }
+
+
+    size_t positionCount = 0, normalCount = 0, cornerCount = 0;
+    for(auto& chunk : chunks)
+    {
+        chunk.positionOffset = positionCount;
+        chunk.normalOffset = normalCount;
+        positionCount += chunk.positions.size();
+        normalCount += chunk.normals.size();
+        cornerCount += chunk.corners.size();
+    }
+
+    // vertices are emitted in the order of their first use, straight into upload-ready arrays
+    mesh.vertices.clear();
+    mesh.normals.clear();
+    mesh.indices.clear();
+    mesh.vertices.reserve(positionCount);
+    mesh.normals.reserve(positionCount);
+    mesh.indices.reserve(cornerCount);
+
+    auto lookup = [&](const std::vector<ObjChunk>& chunks, size_t globalIndex, bool isNormal) -> const glm::vec3& {
+        // chunks are few, so a linear search from the back is enough
+        size_t c = chunks.size() - 1;
+        while((isNormal ? chunks[c].normalOffset : chunks[c].positionOffset) > globalIndex)
+        {
+            c--;
+        }
+
+        return isNormal ? chunks[c].normals[globalIndex - chunks[c].normalOffset]
+                        : chunks[c].positions[globalIndex - chunks[c].positionOffset];
+    };
+
+    CornerMap corners(positionCount);
+    for(const auto& chunk : chunks)
+    {
+        for(const auto& corner : chunk.corners)
+        {
+            int64_t position = corner.position.value + (corner.position.isRelative ? chunk.positionOffset : 0);
+            int64_t normal = corner.normal.value + (corner.normal.isRelative ? chunk.normalOffset : 0);
+
+            // -1 is only left by corners without a normal, relative indices must land on an actual normal
+            const int64_t minNormal = corner.normal.isRelative ? 0 : -1;
+            if(position < 0 || position >= (int64_t)positionCount || normal < minNormal || normal >= (int64_t)normalCount)
+            {
+                printf("Invalid face index in file: %s\n", path);
+                return false;
+            }
+
+            uint64_t key = (uint64_t)position << 32 | (uint32_t)(normal + 1);
+            unsigned int index = corners.findOrInsert(key, mesh.vertices.size());
+            if(index == mesh.vertices.size())
+            {
+                mesh.vertices.push_back(lookup(chunks, position, false));
+                mesh.normals.push_back(normal >= 0 ? lookup(chunks, normal, true) : glm::vec3(0.f));
+            }
+
+            mesh.indices.push_back(index);
+        }
+    }
+
+    return true;
+}
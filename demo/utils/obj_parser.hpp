@@ -0,0 +1,20 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+
+// Mesh data in the form expected by Mesh::load
+struct ObjMeshData
+{
+    std::vector<glm::vec3> vertices;
+    std::vector<glm::vec3> normals;
+    std::vector<unsigned int> indices;
+};
+
+// Reads positions, normals and faces of a Wavefront OBJ file, all other statements are ignored.
+// The file is memory mapped and split into chunks of lines parsed on separate threads.
+// Corners of faces sharing both the position and the normal are merged into a single vertex,
+// polygons with more than 3 vertices are triangulated as fans.
+bool parseObjFile(const char *path, ObjMeshData& mesh);
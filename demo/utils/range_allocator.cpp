@@ -0,0 +1,107 @@
+#include "range_allocator.hpp"
+
+#include <cstdio>
+
+
+RangeAllocator::RangeAllocator(size_t capacity)
+{
+    reset(capacity);
+}
+
+void RangeAllocator::insertFree(size_t offset, size_t size)
+{
+    m_freeByOffset.emplace(offset, size);
+    m_freeBySize.emplace(size, offset);
+}
+
+void RangeAllocator::eraseFree(std::map<size_t, size_t>::iterator it)
+{
+    auto sameSize = m_freeBySize.equal_range(it->second);
+    for (auto bySize = sameSize.first; bySize != sameSize.second; ++bySize)
+    {
+        if(bySize->second == it->first)
+        {
+            m_freeBySize.erase(bySize);
+            break;
+        }
+    }
+
+    m_freeByOffset.erase(it);
+}
+
+size_t RangeAllocator::allocate(size_t size)
+{
+    if(size == 0)
+    {
+        return 0;
+    }
+
+    auto bySize = m_freeBySize.lower_bound(size);
+    if(bySize == m_freeBySize.end())
+    {
+        return INVALID_OFFSET;
+    }
+
+    const size_t offset = bySize->second;
+    const size_t rangeSize = bySize->first;
+    eraseFree(m_freeByOffset.find(offset));
+
+    // the rest of the range stays free
+    if(rangeSize > size)
+    {
+        insertFree(offset + size, rangeSize - size);
+    }
+
+    m_used += size;
+    return offset;
+}
+
+void RangeAllocator::free(size_t offset, size_t size)
+{
+    if(size == 0)
+    {
+        return;
+    }
+    if(offset + size > m_capacity)
+    {
+        printf("[ERROR][%s(%d)] Freeing a range outside of the allocator\n", __FILE__, __LINE__);
+        return;
+    }
+
+    m_used -= size;
+
+    // merge with the free ranges right after and right before
+    auto next = m_freeByOffset.lower_bound(offset);
+    if(next != m_freeByOffset.end() && next->first == offset + size)
+    {
+        size += next->second;
+        eraseFree(next);
+    }
+
+    auto prev = m_freeByOffset.lower_bound(offset);
+    if(prev != m_freeByOffset.begin())
+    {
+        --prev;
+        if(prev->first + prev->second == offset)
+        {
+            offset = prev->first;
+            size += prev->second;
+            eraseFree(prev);
+        }
+    }
+
+    insertFree(offset, size);
+}
+
+void RangeAllocator::reset(size_t capacity)
+{
+    m_capacity = capacity;
+    m_used = 0;
+
+    m_freeByOffset.clear();
+    m_freeBySize.clear();
+    if(capacity > 0)
+    {
+        insertFree(0, capacity);
+    }
+}
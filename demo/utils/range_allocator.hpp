@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <map>
+
+
+// Hands out ranges of a linear space, e.g. of a GPU buffer, measured in elements.
+// Free ranges are kept merged with their free neighbours and allocations take the smallest free range they fit in.
+class RangeAllocator
+{
+private:
+    size_t m_capacity;
+    size_t m_used;
+
+    // free ranges by offset, to find the neighbours of a freed range
+    std::map<size_t, size_t> m_freeByOffset;
+    // the same free ranges by size, to find the best fit
+    std::multimap<size_t, size_t> m_freeBySize;
+
+    void insertFree(size_t offset, size_t size);
+    void eraseFree(std::map<size_t, size_t>::iterator it);
+
+
+public:
+    static const size_t INVALID_OFFSET = ~size_t(0);
+
+    RangeAllocator(size_t capacity = 0);
+
+    // offset of the allocated range or INVALID_OFFSET if no free range is big enough
+    size_t allocate(size_t size);
+    void free(size_t offset, size_t size);
+
+    // forgets all allocations
+    void reset(size_t capacity);
+
+    size_t capacity() const { return m_capacity; }
+    size_t used() const { return m_used; }
+    size_t freeRangeCount() const { return m_freeByOffset.size(); }
+    size_t largestFreeRange() const { return m_freeBySize.empty() ? 0 : m_freeBySize.rbegin()->first; }
+};
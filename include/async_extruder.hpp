@@ -0,0 +1,63 @@
+#pragma once
+
+#include "curve_mesh.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+
+// Work that produces a mesh. It should pass `cancelled` on to the extruder through ExtrusionOptions::cancelled.
+typedef std::function<CurveMeshData(const std::atomic<bool> *cancelled)> ExtrusionJob;
+
+// Runs extrusions on a pool of background threads.
+// Every job is submitted under a key, e.g. an id of the edited object. A new job cancels the one submitted
+// under the same key before it, whether it's still queued or already running, so only the latest edit gets finished.
+// Futures of cancelled jobs are resolved with an empty mesh, exceptions thrown by the other jobs are passed on through theirs.
+class AsyncExtruder
+{
+private:
+    struct Task
+    {
+        unsigned int key;
+        ExtrusionJob job;
+        std::atomic<bool> cancelled;
+        std::promise<CurveMeshData> promise;
+    };
+
+    std::vector<std::thread> m_workers;
+    std::deque<std::shared_ptr<Task>> m_queue;
+    // the latest unfinished task of every key
+    std::unordered_map<unsigned int, std::shared_ptr<Task>> m_latest;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wakeUp;
+    bool m_stopping;
+
+    void workerLoop();
+
+
+public:
+    // 0 threads means one less than the number of hardware threads, so that the calling thread keeps a core
+    AsyncExtruder(unsigned int threadCount = 0);
+    // cancels everything that hasn't finished yet and waits for the workers
+    ~AsyncExtruder();
+
+    AsyncExtruder(const AsyncExtruder&) = delete;
+    AsyncExtruder& operator=(const AsyncExtruder&) = delete;
+
+    std::future<CurveMeshData> submit(unsigned int key, ExtrusionJob job);
+
+    // convenience for the most common job, the arguments are copied
+    std::future<CurveMeshData> submitProfileWithCurve(unsigned int key, const std::vector<glm::vec2>& profile, const std::vector<BezierCurvePoint>& curvePoints, unsigned int segmentCount, const ExtrusionOptions& options = ExtrusionOptions());
+
+    void cancel(unsigned int key);
+    void cancelAll();
+};
@@ -5,11 +5,47 @@
 #include <vector>
 
 
-struct BezierCurvePoint
+// T is the precision of the curve, either float or double
+template<typename T>
+struct BezierCurvePointT
 {
-    glm::vec3 position;
-    float ratio;
+    glm::vec<3, T> position;
+    T ratio;
 };
 
+typedef BezierCurvePointT<float> BezierCurvePoint;
+typedef BezierCurvePointT<double> BezierCurvePointD;
+
+// Point on a curve together with its exact derivatives with respect to the curve parameter
+template<typename T>
+struct BezierCurveSampleT
+{
+    glm::vec<3, T> position;
+    glm::vec<3, T> firstDerivative;
+    glm::vec<3, T> secondDerivative;
+    // 1 / radius of the osculating circle, 0 where the curve stops (the first derivative vanishes)
+    T curvature;
+};
+
+typedef BezierCurveSampleT<float> BezierCurveSample;
+typedef BezierCurveSampleT<double> BezierCurveSampleD;
+
 // All elements besides the first and last are treated as control points
-std::vector<glm::vec3> plotBezierCurve(const std::vector<BezierCurvePoint>& points, unsigned int segmentCount);
\ No newline at end of file
+template<typename T>
+std::vector<glm::vec<3, T>> plotBezierCurve(const std::vector<BezierCurvePointT<T>>& points, unsigned int segmentCount);
+
+// Same as plotBezierCurve, with derivatives and curvature computed in the same evaluation.
+// Samples are evenly spaced in the curve parameter, which goes from 0 to 1.
+template<typename T>
+std::vector<BezierCurveSampleT<T>> sampleBezierCurve(const std::vector<BezierCurvePointT<T>>& points, unsigned int segmentCount);
+
+// Evaluates a rational Bezier curve of the given degree at parameter `t` in range [0, 1].
+// Control points are given in homogeneous coordinates (position * ratio, ratio), at most 64 of them.
+// Uses de Casteljau's algorithm, which stays stable for high degrees.
+template<typename T>
+BezierCurveSampleT<T> evaluateBezierCurve(const glm::vec<4, T> *points, unsigned int degree, T t);
+
+// Sample of a rational curve from its homogeneous point (position * ratio, ratio) and the point's first two derivatives,
+// using the quotient rule. Shared by all rational curve evaluators.
+template<typename T>
+BezierCurveSampleT<T> rationalCurveSample(const glm::vec<4, T>& h, const glm::vec<4, T>& dh, const glm::vec<4, T>& ddh);
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <limits>
+
+
+struct BoundingBox
+{
+    glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());
+    glm::vec3 max = glm::vec3(-std::numeric_limits<float>::max());
+};
+
+inline void expandBoundingBox(BoundingBox& box, const glm::vec3& point)
+{
+    box.min = glm::min(box.min, point);
+    box.max = glm::max(box.max, point);
+}
+
+inline void expandBoundingBox(BoundingBox& box, const BoundingBox& other)
+{
+    box.min = glm::min(box.min, other.min);
+    box.max = glm::max(box.max, other.max);
+}
+
+inline glm::vec3 boundingBoxCenter(const BoundingBox& box)
+{
+    return (box.min + box.max) * 0.5f;
+}
+
+inline bool boundingBoxesOverlap(const BoundingBox& a, const BoundingBox& b)
+{
+    return a.min.x <= b.max.x && b.min.x <= a.max.x
+        && a.min.y <= b.max.y && b.min.y <= a.max.y
+        && a.min.z <= b.max.z && b.min.z <= a.max.z;
+}
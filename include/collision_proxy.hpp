@@ -0,0 +1,59 @@
+#pragma once
+
+#include "curve_mesh.hpp"
+#include "curve_sampler.hpp"
+#include "sweep_clearance.hpp"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+
+enum class CollisionProxyType
+{
+    // capsules if the profile is round within the tolerance, convex hulls otherwise
+    Automatic,
+    Capsules,
+    ConvexHulls,
+};
+
+struct CollisionProxyOptions
+{
+    CollisionProxyType type = CollisionProxyType::Automatic;
+
+    // Consecutive segments are merged into one piece as long as the piece stays within this distance of the rings it replaces.
+    // With 0 every segment between two rings is a piece of its own.
+    float tolerance = 0.f;
+    // upper limit of segments in a single piece
+    unsigned int maxSegmentsPerPiece = 64;
+};
+
+// Collision shape of an extruded tube, made of convex pieces that follow the curve.
+// Piece `i` covers the segments between rings [firstRing[i], firstRing[i + 1]].
+struct CollisionProxy
+{
+    CollisionProxyType type;
+    std::vector<unsigned int> firstRing;
+
+    // one per piece, for CollisionProxyType::Capsules
+    std::vector<Capsule> capsules;
+
+    // For CollisionProxyType::ConvexHulls, piece `i` is the convex hull of points [hullOffsets[i], hullOffsets[i + 1]):
+    // the convex hull of the profile placed at the first and last ring of the piece. Physics engines cook hulls from such points directly.
+    std::vector<glm::vec3> hullPoints;
+    std::vector<unsigned int> hullOffsets;
+
+    size_t pieceCount() const { return firstRing.empty() ? 0 : firstRing.size() - 1; }
+};
+
+// Builds the collision shape of the tube extrudeProfile would make from the same profile and points, without making the mesh.
+// Positions are relative to `origin`, like mesh vertices.
+template<typename T>
+CollisionProxy buildCollisionProxy(const std::vector<glm::vec2>& profile, const std::vector<ExtrusionPointT<T>>& extrusionPoints, const CollisionProxyOptions& options = CollisionProxyOptions(), const glm::vec<3, T>& origin = glm::vec<3, T>(T(0)));
+
+// same as above, along a curve sampled into `segmentCount` segments like extrudeProfileWithCurve does
+template<typename T>
+CollisionProxy buildCollisionProxyWithCurve(const std::vector<glm::vec2>& profile, const CurveSamplerT<T>& curve, unsigned int segmentCount, const CollisionProxyOptions& options = CollisionProxyOptions(), const glm::vec<3, T>& origin = glm::vec<3, T>(T(0)));
+
+// convex hull of a 2D point set in counter-clockwise order, without collinear points
+std::vector<glm::vec2> convexHull2D(std::vector<glm::vec2> points);
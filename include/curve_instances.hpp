@@ -0,0 +1,63 @@
+#pragma once
+
+#include "curve_mesh.hpp"
+#include "curve_sampler.hpp"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+
+// Transform of a single object placed along a curve.
+// An object vertex (x, y, z) lands at `position + x * right + y * up + z * forward`, so the object's XY plane
+// is the plane of the profile and its Z axis points along the curve.
+// Axes carry the scale of the extrusion points, just like the profile does.
+struct InstanceTransform
+{
+    glm::vec3 position;
+    glm::vec3 right;
+    glm::vec3 up;
+    glm::vec3 forward;
+};
+
+inline glm::mat4 instanceMatrix(const InstanceTransform& instance)
+{
+    return glm::mat4(
+        glm::vec4(instance.right, 0.f),
+        glm::vec4(instance.up, 0.f),
+        glm::vec4(instance.forward, 0.f),
+        glm::vec4(instance.position, 1.f)
+    );
+}
+
+struct InstancePlacement
+{
+    // Distance between two instances along the curve, measured on the polyline through the extrusion points.
+    // If 0, `count` instances are spread evenly from the start to the end of the curve instead.
+    float spacing = 0.f;
+    unsigned int count = 0;
+    // distance of the first instance from the start of the curve, only used with `spacing`, can't be negative
+    float offset = 0.f;
+
+    // Each instance is moved by a random amount up to these, the same seed always gives the same result.
+    // Along the curve, in units of length:
+    float jitterDistance = 0.f;
+    // within the profile plane, in units of the profile:
+    glm::vec2 jitterOffset = glm::vec2(0.f);
+    // around the curve, in radians:
+    float jitterRoll = 0.f;
+    unsigned int seed = 0;
+};
+
+// most instances a single placement makes, placements asking for more are rejected
+const size_t MAX_INSTANCE_COUNT = size_t(1) << 24;
+
+// Places instances along the curve given by extrusion points.
+// Frames are those of the rings extrudeProfile would make from the same points, interpolated linearly between
+// the rings the same way the mesh surface is, so an object at profile coordinates sits exactly on the mesh.
+template<typename T>
+std::vector<InstanceTransform> placeInstances(const std::vector<ExtrusionPointT<T>>& extrusionPoints, const InstancePlacement& placement, const glm::vec<3, T>& origin = glm::vec<3, T>(T(0)));
+
+// same as above, along a curve sampled into `segmentCount` segments like extrudeProfileWithCurve does
+template<typename T>
+std::vector<InstanceTransform> placeInstancesWithCurve(const CurveSamplerT<T>& curve, unsigned int segmentCount, const InstancePlacement& placement, const glm::vec<3, T>& origin = glm::vec<3, T>(T(0)));
@@ -1,9 +1,14 @@
 #pragma once
 
 #include "bezier_curve.hpp"
+#include "bounding_box.hpp"
+#include "curve_sampler.hpp"
+#include "ring_transform.hpp"
+#include "sweep_tracks.hpp"
 
 #include <glm/glm.hpp>
 
+#include <atomic>
 #include <vector>
 
 
@@ -13,19 +18,159 @@ struct CurveMeshData
     std::vector<glm::vec3> normals;
     std::vector<glm::vec2> uvs;
     std::vector<unsigned int> indices;
+
+    // number of vertices in a single ring of the tube, rings are stored one after another at the start of `vertices`
+    unsigned int ringSize = 0;
+    // number of indices of a single segment of the tube, segments are stored one after another at the start of `indices`
+    unsigned int segmentIndexCount = 0;
+    // bounds of the tube between every two consecutive rings, only filled if requested with ExtrusionOptions
+    std::vector<BoundingBox> segmentBounds;
 };
 
 
-struct ExtrusionPoint
+// T is the precision of the position, either float or double
+template<typename T>
+struct ExtrusionPointT
 {
-    glm::vec3 position;
-    glm::vec3 direction;
+    glm::vec<3, T> position;
+    glm::vec<3, T> direction;
     float roll;
+    // scale of the profile, kept at least MIN_RING_SCALE away from 0
+    float scale = 1.f;
+};
+
+// smallest scale a ring is given, so that the normals of tapered ends stay defined
+const float MIN_RING_SCALE = 1e-4f;
+
+typedef ExtrusionPointT<float> ExtrusionPoint;
+typedef ExtrusionPointT<double> ExtrusionPointD;
+
+struct ExtrusionOptions
+{
+    // close the mesh with a flat, triangulated profile at the first/last extrusion point
+    bool startCap = false;
+    bool endCap = false;
+
+    // Don't repeat the first vertex of the profile at the end of every ring and don't generate UVs.
+    // Meant for consumers that only care about the geometry, e.g. physics.
+    bool seamless = false;
+
+    // fill CurveMeshData::segmentBounds; these are computed from the profile's radius, so they're cheap but not tight
+    bool computeSegmentBounds = false;
+
+    // If set, the flag is checked between the stages of extrusion and once it's raised the extruder gives up
+    // and returns an empty mesh. Lets a mesh that's no longer needed be abandoned from another thread.
+    const std::atomic<bool> *cancelled = nullptr;
+};
+
+// Building blocks of the extruders, for extruders specialized elsewhere
+
+// how many rings are processed between checks of ExtrusionOptions::cancelled
+const size_t CANCELLATION_CHECK_INTERVAL = 1024;
+
+inline bool isExtrusionCancelled(const ExtrusionOptions& options)
+{
+    return options.cancelled && options.cancelled->load(std::memory_order_relaxed);
+}
+
+// Normal of a tube vertex, averaged from the faces of the segments before and after its ring.
+// `left` and `right` are its neighbours within the ring, `down` and `up` the same vertex of the previous and next ring,
+// null at the first and last ring of the tube.
+inline glm::vec3 computeTubeNormal(const glm::vec3& v, const glm::vec3& left, const glm::vec3& right, const glm::vec3 *down, const glm::vec3 *up)
+{
+    glm::vec3 nAfter, nBefore;
+    if(up)
+    {
+        nAfter = glm::normalize(glm::cross(right - v, *up - v) + glm::cross(*up - v, left - v));
+    }
+    if(down)
+    {
+        nBefore = glm::normalize(glm::cross(left - v, *down - v) + glm::cross(*down - v, right - v));
+    }
+
+    if(!down)
+    {
+        return nAfter;
+    }
+    if(!up)
+    {
+        return nBefore;
+    }
+    return glm::normalize(nBefore + nAfter);
+}
+
+// adds a flat cap made of the profile placed in the given frame, facing along or against the extrusion direction
+void appendCap(CurveMeshData& mesh, const std::vector<glm::vec2>& profile, const RingFrame& frame, bool facesBackwards, bool withUvs);
+
+// adds texture coordinates for `ringCount` rings of `ringSize` vertices, the seam vertex included;
+// the texture is wrapped once around every ring and repeats with every segment
+void appendTubeUvs(CurveMeshData& mesh, size_t ringCount, size_t ringSize);
+
+// Appends the tube of the profile swept through the frames, after whatever the mesh holds already, without caps.
+// Leaves ringSize and segmentIndexCount alone. Returns false if the extrusion gets cancelled, with the mesh left half done,
+// or if there are fewer than 2 frames, with the mesh untouched.
+bool appendTube(CurveMeshData& mesh, const std::vector<glm::vec2>& profile, const std::vector<RingFrame>& frames, const ExtrusionOptions& options);
+
+// fills `bounds` with boxes of every segment between consecutive frames of a tube no wider than `radius`
+void computeSegmentBounds(const std::vector<RingFrame>& frames, float radius, std::vector<BoundingBox>& bounds);
+
+
+// Piece of a mesh extruded in chunks, with vertices relative to `origin`.
+// Consecutive chunks share the ring at their boundary, so that they can be drawn without gaps.
+struct CurveMeshChunk
+{
+    glm::dvec3 origin;
+    CurveMeshData mesh;
 };
 
+
+// Every extruder takes an `origin` that is subtracted from the positions in their original precision,
+// before the mesh vertices are computed in float. With double precision input this keeps meshes
+// far away from the world's origin precise, as long as they're not too big themselves.
+
+// the frame the profile plane is rotated into at the given extrusion point
+template<typename T>
+RingFrame computeRingFrame(const ExtrusionPointT<T>& extrusionPoint, const glm::vec<3, T>& origin = glm::vec<3, T>(T(0)));
+
+// frames of all extrusion points, gives up with no frames if the extrusion gets cancelled
+template<typename T>
+std::vector<RingFrame> computeRingFrames(const std::vector<ExtrusionPointT<T>>& extrusionPoints, const glm::vec<3, T>& origin, const ExtrusionOptions& options);
+
+// extrusion points along a plotted curve, directions are approximated from the neighbouring points
+// curve must have at least 2 points
+template<typename T>
+std::vector<ExtrusionPointT<T>> computeExtrusionPoints(const std::vector<glm::vec<3, T>>& curve);
+
+// extrusion points along a sampled curve, directions are the exact tangents of the curve
+// where the curve stops for a moment (zero first derivative), the neighbouring samples are used instead
+template<typename T>
+std::vector<ExtrusionPointT<T>> computeExtrusionPoints(const std::vector<BezierCurveSampleT<T>>& samples);
+
 // profile vertices should be given in a counter-clockwise order around a (0,0) origin to avoid inverted normals
-CurveMeshData extrudeProfile(std::vector<glm::vec2> profile, const std::vector<ExtrusionPoint>& extrusionPoints);
+template<typename T>
+CurveMeshData extrudeProfile(std::vector<glm::vec2> profile, const std::vector<ExtrusionPointT<T>>& extrusionPoints, const ExtrusionOptions& options = ExtrusionOptions(), const glm::vec<3, T>& origin = glm::vec<3, T>(T(0)));
 
 // All elements besides the first and last in curvePoints are treated as control points
 // profile vertices should be given in a counter-clockwise order around a (0,0) origin to avoid inverted normals
-CurveMeshData extrudeProfileWithCurve(const std::vector<glm::vec2>& profile, const std::vector<BezierCurvePoint>& curvePoints, unsigned int segmentCount);
\ No newline at end of file
+template<typename T>
+CurveMeshData extrudeProfileWithCurve(const std::vector<glm::vec2>& profile, const std::vector<BezierCurvePointT<T>>& curvePoints, unsigned int segmentCount, const ExtrusionOptions& options = ExtrusionOptions(), const glm::vec<3, T>& origin = glm::vec<3, T>(T(0)));
+
+// Same as above for any kind of curve, e.g. a Catmull-Rom spline or NURBS.
+// The curve is sampled straight into extrusion points, with directions taken from its exact tangents.
+template<typename T>
+CurveMeshData extrudeProfileWithCurve(const std::vector<glm::vec2>& profile, const CurveSamplerT<T>& curve, unsigned int segmentCount, const ExtrusionOptions& options = ExtrusionOptions(), const glm::vec<3, T>& origin = glm::vec<3, T>(T(0)));
+
+// Same as extrudeProfile, but the profile at every extrusion point is a mix between `profileFrom` and `profileTo`,
+// weighted by the corresponding element of `blend`. Both profiles must have the same number of vertices.
+template<typename T>
+CurveMeshData extrudeMorphedProfile(const std::vector<glm::vec2>& profileFrom, const std::vector<glm::vec2>& profileTo, const std::vector<ExtrusionPointT<T>>& extrusionPoints, const std::vector<float>& blend, const ExtrusionOptions& options = ExtrusionOptions(), const glm::vec<3, T>& origin = glm::vec<3, T>(T(0)));
+
+// Same as extrudeProfileWithCurve, but with scale, roll and blend between `profileFrom` and `profileTo` animated along the curve.
+// `profileTo` can be left empty if the profile should not change its shape.
+template<typename T>
+CurveMeshData extrudeMorphedProfileWithCurve(const std::vector<glm::vec2>& profileFrom, const std::vector<glm::vec2>& profileTo, const std::vector<BezierCurvePointT<T>>& curvePoints, unsigned int segmentCount, const SweepTracks& tracks, const ExtrusionOptions& options = ExtrusionOptions(), const glm::vec<3, T>& origin = glm::vec<3, T>(T(0)));
+
+// Same as extrudeProfile, but the mesh is split into chunks of at most `segmentsPerChunk` segments,
+// each with vertices relative to its own origin. Normals and UVs are continuous across the chunks.
+template<typename T>
+std::vector<CurveMeshChunk> extrudeProfileChunked(const std::vector<glm::vec2>& profile, const std::vector<ExtrusionPointT<T>>& extrusionPoints, unsigned int segmentsPerChunk, const ExtrusionOptions& options = ExtrusionOptions());
@@ -0,0 +1,165 @@
+#pragma once
+
+#include "curve_mesh.hpp"
+#include "ring_transform.hpp"
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+
+class CurveMeshView;
+
+// Random access range over one attribute of a CurveMeshView, every element is computed when it's read
+template<typename Value>
+class CurveMeshViewRange
+{
+public:
+    typedef Value (CurveMeshView::*Getter)(size_t) const;
+
+    // Refers to the view itself rather than to the range, so that it stays valid after the range,
+    // usually a temporary returned by CurveMeshView, is gone.
+    class iterator
+    {
+    private:
+        const CurveMeshView *m_view;
+        Getter m_getter;
+        size_t m_index;
+
+
+    public:
+        typedef std::random_access_iterator_tag iterator_category;
+        typedef Value value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const Value *pointer;
+        // elements don't exist anywhere in memory, so they're handed out by value
+        typedef Value reference;
+
+        iterator() : m_view(nullptr), m_getter(nullptr), m_index(0) {}
+        iterator(const CurveMeshView *view, Getter getter, size_t index) : m_view(view), m_getter(getter), m_index(index) {}
+
+        Value operator*() const { return (m_view->*m_getter)(m_index); }
+        Value operator[](difference_type n) const { return (m_view->*m_getter)(m_index + n); }
+
+        iterator& operator++() { m_index++; return *this; }
+        iterator& operator--() { m_index--; return *this; }
+        iterator operator++(int) { iterator it = *this; m_index++; return it; }
+        iterator operator--(int) { iterator it = *this; m_index--; return it; }
+        iterator& operator+=(difference_type n) { m_index += n; return *this; }
+        iterator& operator-=(difference_type n) { m_index -= n; return *this; }
+        iterator operator+(difference_type n) const { return iterator(m_view, m_getter, m_index + n); }
+        iterator operator-(difference_type n) const { return iterator(m_view, m_getter, m_index - n); }
+        friend iterator operator+(difference_type n, const iterator& it) { return it + n; }
+        difference_type operator-(const iterator& other) const { return difference_type(m_index) - difference_type(other.m_index); }
+
+        bool operator==(const iterator& other) const { return m_view == other.m_view && m_getter == other.m_getter && m_index == other.m_index; }
+        bool operator!=(const iterator& other) const { return !(*this == other); }
+        bool operator<(const iterator& other) const { return m_index < other.m_index; }
+        bool operator>(const iterator& other) const { return m_index > other.m_index; }
+        bool operator<=(const iterator& other) const { return m_index <= other.m_index; }
+        bool operator>=(const iterator& other) const { return m_index >= other.m_index; }
+    };
+
+
+private:
+    const CurveMeshView *m_view;
+    Getter m_getter;
+    size_t m_size;
+
+
+public:
+    CurveMeshViewRange(const CurveMeshView *view, Getter getter, size_t size) : m_view(view), m_getter(getter), m_size(size) {}
+
+    Value operator[](size_t i) const { return (m_view->*m_getter)(i); }
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+    iterator begin() const { return iterator(m_view, m_getter, 0); }
+    iterator end() const { return iterator(m_view, m_getter, m_size); }
+};
+
+
+// Consecutive rings of a CurveMeshView with all of their attributes computed
+struct CurveMeshBlock
+{
+    size_t firstRing = 0;
+    size_t ringCount = 0;
+
+    // ringCount * ringSize elements, in the same order as in the whole mesh
+    std::vector<glm::vec3> vertices;
+    std::vector<glm::vec3> normals;
+    std::vector<glm::vec2> uvs;
+    // Triangles of the segments starting at the rings of the block, with indices into the whole mesh.
+    // The triangles of the block's last ring reach into the first ring of the next block.
+    std::vector<unsigned int> indices;
+};
+
+
+// The mesh extrudeProfile would make, without the caps, computed on demand from the ring frames and the profile.
+// Keeps only one frame per ring, so consumers that read the mesh once don't need memory for the whole of it.
+// Values match the materialized mesh up to rounding; blocks match it exactly.
+class CurveMeshView
+{
+private:
+    ProfileSoA m_profile;
+    std::vector<RingFrame> m_frames;
+    bool m_seamless;
+    unsigned int m_uniqueSize;
+    unsigned int m_ringSize;
+
+    // vertex `j` of ring `i`, wrapping around the unique vertices of the ring
+    glm::vec3 ringVertex(size_t i, size_t j) const;
+
+
+public:
+    class BlockIterator
+    {
+    private:
+        const CurveMeshView& m_view;
+        size_t m_ringsPerBlock;
+        size_t m_nextRing;
+        CurveMeshBlock m_block;
+        // vertices of the block with one more ring on each side, which the normals depend on
+        std::vector<glm::vec3> m_paddedVertices;
+
+
+    public:
+        BlockIterator(const CurveMeshView& view, size_t ringsPerBlock);
+
+        // computes the next block, false once all rings have been visited
+        bool next();
+        const CurveMeshBlock& block() const { return m_block; }
+    };
+
+
+    CurveMeshView(const std::vector<glm::vec2>& profile, std::vector<RingFrame> frames, bool seamless = false);
+
+    size_t ringCount() const { return m_frames.size(); }
+    unsigned int ringSize() const { return m_ringSize; }
+    unsigned int segmentIndexCount() const { return m_uniqueSize * 6; }
+    size_t vertexCount() const { return m_frames.size() * m_ringSize; }
+    size_t indexCount() const { return m_frames.size() < 2 ? 0 : (m_frames.size() - 1) * segmentIndexCount(); }
+    bool isSeamless() const { return m_seamless; }
+    const std::vector<RingFrame>& frames() const { return m_frames; }
+
+    glm::vec3 vertex(size_t i) const;
+    glm::vec3 normal(size_t i) const;
+    glm::vec2 uv(size_t i) const;
+    unsigned int index(size_t i) const;
+
+    CurveMeshViewRange<glm::vec3> vertices() const { return CurveMeshViewRange<glm::vec3>(this, &CurveMeshView::vertex, vertexCount()); }
+    CurveMeshViewRange<glm::vec3> normals() const { return CurveMeshViewRange<glm::vec3>(this, &CurveMeshView::normal, vertexCount()); }
+    // empty for seamless meshes, like CurveMeshData::uvs
+    CurveMeshViewRange<glm::vec2> uvs() const { return CurveMeshViewRange<glm::vec2>(this, &CurveMeshView::uv, m_seamless ? 0 : vertexCount()); }
+    CurveMeshViewRange<unsigned int> indices() const { return CurveMeshViewRange<unsigned int>(this, &CurveMeshView::index, indexCount()); }
+
+    // Visits the mesh `ringsPerBlock` rings at a time. Much faster than the element ranges for reading everything,
+    // since every ring is transformed as a whole and only once.
+    BlockIterator blocks(size_t ringsPerBlock = 256) const { return BlockIterator(*this, ringsPerBlock); }
+};
+
+// view of the mesh extrudeProfile would make from the same arguments, only `seamless` of the options applies
+template<typename T>
+CurveMeshView makeCurveMeshView(const std::vector<glm::vec2>& profile, const std::vector<ExtrusionPointT<T>>& extrusionPoints, bool seamless = false, const glm::vec<3, T>& origin = glm::vec<3, T>(T(0)));
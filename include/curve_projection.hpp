@@ -0,0 +1,37 @@
+#pragma once
+
+#include "bezier_curve.hpp"
+#include "bounding_box.hpp"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+
+// Hierarchy of bounding boxes over a rational Bezier curve, obtained by recursively splitting the curve in half.
+// Since every piece of the curve is a rational Bezier curve itself, it lies within the bounds of its own control points.
+// Boxes are stored as a complete binary tree, where children of node `i` are at `2i` and `2i + 1` (root has index 1).
+struct CurveProjectionTree
+{
+    unsigned int degree = 0;
+    std::vector<BoundingBox> nodes;
+    // control points of every leaf piece in homogeneous coordinates (position * ratio, ratio), degree + 1 per leaf
+    std::vector<glm::vec4> leafPoints;
+};
+
+struct CurveProjection
+{
+    glm::vec3 position; // the closest point on the curve
+    float t;            // curve parameter of said point, in the same range that plotBezierCurve uses
+    float distance;
+};
+
+
+// Ratios of all points should be positive.
+// The curve is split into 2^depth pieces.
+CurveProjectionTree buildCurveProjectionTree(const std::vector<BezierCurvePoint>& points, unsigned int depth = 6);
+
+CurveProjection projectPointOntoCurve(const CurveProjectionTree& tree, glm::vec3 point);
+
+// Answers many queries at once using multiple threads
+std::vector<CurveProjection> projectPointsOntoCurve(const CurveProjectionTree& tree, const std::vector<glm::vec3>& points);
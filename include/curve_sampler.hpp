@@ -0,0 +1,122 @@
+#pragma once
+
+#include "bezier_curve.hpp"
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <vector>
+
+
+// Common interface of all curve types the extruder can follow.
+// Every sampler evaluates its curve natively, together with exact derivatives.
+template<typename T>
+class CurveSamplerT
+{
+public:
+    virtual ~CurveSamplerT() = default;
+
+    // segmentCount + 1 samples evenly spaced in the parameter of the curve, from its start to its end.
+    // Derivatives are with respect to that parameter. Empty if the curve is not valid.
+    virtual std::vector<BezierCurveSampleT<T>> sample(unsigned int segmentCount) const = 0;
+};
+
+typedef CurveSamplerT<float> CurveSampler;
+typedef CurveSamplerT<double> CurveSamplerD;
+
+
+
+// ============= BEZIER ============= //
+
+// single rational Bezier curve, same as plotBezierCurve and sampleBezierCurve
+template<typename T>
+class BezierCurveSamplerT : public CurveSamplerT<T>
+{
+private:
+    std::vector<BezierCurvePointT<T>> m_points;
+
+
+public:
+    BezierCurveSamplerT(const std::vector<BezierCurvePointT<T>>& points);
+
+    std::vector<BezierCurveSampleT<T>> sample(unsigned int segmentCount) const override;
+};
+
+typedef BezierCurveSamplerT<float> BezierCurveSampler;
+typedef BezierCurveSamplerT<double> BezierCurveSamplerD;
+
+
+
+// ============= PIECEWISE CUBIC ============= //
+
+// Curve made of cubic spans, each stored as polynomial coefficients in the power basis (a*t^3 + b*t^2 + c*t + d).
+// Every span covers a unit interval of the curve parameter.
+// Evaluation is the same few multiply-adds for all samples, no matter what kind of spline the spans came from.
+template<typename T>
+class PiecewiseCubicSamplerT : public CurveSamplerT<T>
+{
+protected:
+    std::vector<std::array<glm::vec<3, T>, 4>> m_spans;
+
+
+public:
+    std::vector<BezierCurveSampleT<T>> sample(unsigned int segmentCount) const override;
+
+    size_t spanCount() const { return m_spans.size(); }
+};
+
+// Catmull-Rom spline passing through all the given points.
+// `alpha` picks the parametrization of the spans: 0 is uniform, 0.5 centripetal (no cusps or self-intersections
+// within a span) and 1 chordal. The first and last span get a control point mirrored across their end.
+template<typename T>
+class CatmullRomSamplerT : public PiecewiseCubicSamplerT<T>
+{
+public:
+    // needs at least 2 points
+    CatmullRomSamplerT(const std::vector<glm::vec<3, T>>& points, T alpha = T(0.5));
+};
+
+typedef CatmullRomSamplerT<float> CatmullRomSampler;
+typedef CatmullRomSamplerT<double> CatmullRomSamplerD;
+
+// Uniform cubic B-spline, with one span for every 4 consecutive control points.
+// The curve doesn't pass through the control points, repeat the first and last one 3 times to make it end at them.
+template<typename T>
+class UniformBSplineSamplerT : public PiecewiseCubicSamplerT<T>
+{
+public:
+    // needs at least 4 control points
+    UniformBSplineSamplerT(const std::vector<glm::vec<3, T>>& controlPoints);
+};
+
+typedef UniformBSplineSamplerT<float> UniformBSplineSampler;
+typedef UniformBSplineSamplerT<double> UniformBSplineSamplerD;
+
+
+
+// ============= NURBS ============= //
+
+// Non-uniform rational B-spline of any degree, evaluated with the Cox-de Boor recursion.
+// Control points use `ratio` as their weight.
+// Samples are produced in increasing order of the parameter, so the knot span of every sample is found
+// by stepping forward from the span of the previous one instead of searching the whole knot vector.
+template<typename T>
+class NurbsSamplerT : public CurveSamplerT<T>
+{
+private:
+    unsigned int m_degree;
+    // control points in homogeneous coordinates (position * weight, weight)
+    std::vector<glm::vec<4, T>> m_points;
+    std::vector<T> m_knots;
+
+
+public:
+    // Knots must be non-decreasing and there must be controlPoints.size() + degree + 1 of them.
+    // Without knots, a clamped uniform knot vector is made, so that the curve starts and ends at the end points.
+    NurbsSamplerT(const std::vector<BezierCurvePointT<T>>& controlPoints, unsigned int degree, const std::vector<T>& knots = std::vector<T>());
+
+    std::vector<BezierCurveSampleT<T>> sample(unsigned int segmentCount) const override;
+};
+
+typedef NurbsSamplerT<float> NurbsSampler;
+typedef NurbsSamplerT<double> NurbsSamplerD;
@@ -0,0 +1,131 @@
+#pragma once
+
+#include "bezier_curve.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+// Compact storage for large numbers of curves. Control points of all curves are kept one after another in a single buffer,
+// quantized relative to the bounding box of their curve: 16 bits per axis and 8 bits for the ratio, 8 bytes per point.
+// On every axis, a point is at most 1/131070 of its curve's box size away from the original position.
+// Ratios are stored in steps of 1/255 of the curve's largest ratio, positive ratios never drop below one step,
+// so that a curve can't lose the weight of its ends.
+
+struct PackedCurvePoint
+{
+    uint16_t position[3];
+    uint8_t ratio;
+    uint8_t reserved;
+};
+
+// dequantization parameters of a single curve: position = boxMin + q * positionStep, ratio = q * ratioStep
+struct PackedCurveBounds
+{
+    float boxMin[3];
+    float positionStep[3];
+    float ratioStep;
+};
+
+// Zero-copy view of one curve in a store. Points are dequantized when they're read.
+class PackedCurveView
+{
+private:
+    const PackedCurvePoint *m_points;
+    size_t m_count;
+    const PackedCurveBounds *m_bounds;
+
+public:
+    PackedCurveView(const PackedCurvePoint *points, size_t count, const PackedCurveBounds *bounds)
+    : m_points(points), m_count(count), m_bounds(bounds) {}
+
+    size_t size() const { return m_count; }
+
+    BezierCurvePoint operator[](size_t i) const
+    {
+        const PackedCurvePoint& p = m_points[i];
+        const PackedCurveBounds& b = *m_bounds;
+
+        BezierCurvePoint point;
+        point.position = glm::vec3(
+            b.boxMin[0] + float(p.position[0]) * b.positionStep[0],
+            b.boxMin[1] + float(p.position[1]) * b.positionStep[1],
+            b.boxMin[2] + float(p.position[2]) * b.positionStep[2]
+        );
+        point.ratio = float(p.ratio) * b.ratioStep;
+        return point;
+    }
+
+    std::vector<BezierCurvePoint> unpack() const;
+};
+
+// Zero-copy view of a whole store, either of a PackedCurveStore or of a raw store image in memory, e.g. a mapped file.
+// Curve `i` has points [offsets[i], offsets[i + 1]).
+struct PackedCurveStoreView
+{
+    size_t curveCount;
+    const PackedCurveBounds *bounds;
+    const uint32_t *offsets;
+    const PackedCurvePoint *points;
+
+    PackedCurveView curve(size_t i) const
+    {
+        return PackedCurveView(points + offsets[i], offsets[i + 1] - offsets[i], bounds + i);
+    }
+};
+
+class PackedCurveStore
+{
+private:
+    std::vector<PackedCurveBounds> m_bounds;
+    std::vector<uint32_t> m_offsets;
+    std::vector<PackedCurvePoint> m_points;
+
+public:
+    static const size_t INVALID_CURVE = ~size_t(0);
+
+    PackedCurveStore();
+
+    // quantizes the curve and appends it to the store, returns its index or INVALID_CURVE if the store is full
+    size_t add(const std::vector<BezierCurvePoint>& points);
+    void reserve(size_t curveCount, size_t pointCount);
+    void clear();
+
+    // takes over the contents of a store view, e.g. of a mapped file that is about to be closed
+    void assign(const PackedCurveStoreView& view);
+    // Takes over the arrays without copying them, `offsets` must have one more element than `bounds` and describe `points`.
+    // Returns false and leaves the store alone if they don't fit together.
+    bool assign(std::vector<PackedCurveBounds> bounds, std::vector<uint32_t> offsets, std::vector<PackedCurvePoint> points);
+
+    size_t curveCount() const { return m_bounds.size(); }
+    size_t pointCount() const { return m_points.size(); }
+    // bytes taken by the packed curves
+    size_t byteSize() const;
+
+    PackedCurveView curve(size_t i) const { return view().curve(i); }
+    PackedCurveStoreView view() const;
+};
+
+
+// ============= FILES ============= //
+
+// A store file starts with a header and the bounds of all curves, each section starting at a multiple of 8 bytes, all little-endian.
+// Then either the offsets and points follow as they are in memory, so that the file can be mapped and used with viewPackedCurveStoreImage,
+// or the curves are delta-coded as variable-length integers. That has to be decoded when loading, but it takes around
+// a quarter less space for curves with tens of closely spaced points. For curves with only a few points it doesn't pay off.
+
+// returns false if the file could not be written
+bool savePackedCurveStore(const PackedCurveStoreView& store, const char *path, bool deltaCoded);
+
+// loads a file written in either way into `store`, returns false if it's missing or damaged
+bool loadPackedCurveStore(PackedCurveStore& store, const char *path);
+
+// Views a store image that is already in memory, e.g. a mapped file, without copying it.
+// The image must not be delta-coded and must be aligned to 8 bytes. Returns false if it's not a valid image.
+bool viewPackedCurveStoreImage(const void *data, size_t size, PackedCurveStoreView& view);
+
+
+// plotBezierCurve and sampleBezierCurve that read the quantized points directly
+std::vector<glm::vec3> plotBezierCurve(const PackedCurveView& curve, unsigned int segmentCount);
+std::vector<BezierCurveSample> sampleBezierCurve(const PackedCurveView& curve, unsigned int segmentCount);
@@ -0,0 +1,262 @@
+#pragma once
+
+#include "curve_mesh.hpp"
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdio>
+#include <vector>
+
+
+// Extruder specialized for profiles with a number of vertices known at compile time,
+// along with constexpr generators of the usual shapes.
+// Meshes are identical to the ones made by the regular extrudeProfile.
+
+
+// ============= CONSTEXPR TRIGONOMETRY ============= //
+// std::sin and std::cos can't be used in constant expressions
+
+constexpr double FIXED_PROFILE_PI = 3.14159265358979323846;
+
+// Taylor series of sine, after reducing the angle to [-pi, pi]
+constexpr double constexprSin(double x)
+{
+    long long turns = (long long)((x + FIXED_PROFILE_PI) / (2.0 * FIXED_PROFILE_PI));
+    if(x + FIXED_PROFILE_PI < 0.0)
+    {
+        turns--;
+    }
+    x -= turns * 2.0 * FIXED_PROFILE_PI;
+
+    double term = x;
+    double sum = x;
+    for (int n = 1; n < 13; n++)
+    {
+        term *= -x * x / ((2 * n) * (2 * n + 1));
+        sum += term;
+    }
+
+    return sum;
+}
+
+constexpr double constexprCos(double x)
+{
+    return constexprSin(x + FIXED_PROFILE_PI / 2.0);
+}
+
+
+
+// ============= PROFILE GENERATORS ============= //
+// all profiles are counter-clockwise around the (0,0) origin
+
+// regular polygon with N sides, starting at (radius, 0)
+template<size_t N>
+constexpr std::array<glm::vec2, N> circleProfile(float radius)
+{
+    static_assert(N >= 3, "A circle needs at least 3 sides");
+
+    std::array<glm::vec2, N> profile{};
+    for (size_t i = 0; i < N; i++)
+    {
+        const double angle = 2.0 * FIXED_PROFILE_PI * i / N;
+        profile[i] = glm::vec2(float(radius * constexprCos(angle)), float(radius * constexprSin(angle)));
+    }
+
+    return profile;
+}
+
+constexpr std::array<glm::vec2, 4> rectangleProfile(float width, float height)
+{
+    return {
+        glm::vec2(width * 0.5f, -height * 0.5f),
+        glm::vec2(width * 0.5f, height * 0.5f),
+        glm::vec2(-width * 0.5f, height * 0.5f),
+        glm::vec2(-width * 0.5f, -height * 0.5f)
+    };
+}
+
+// rectangle with every corner replaced by a quarter circle made of `CornerSegments` edges,
+// `radius` should not be bigger than half of the shorter side
+template<size_t CornerSegments>
+constexpr std::array<glm::vec2, 4 * (CornerSegments + 1)> roundedRectangleProfile(float width, float height, float radius)
+{
+    static_assert(CornerSegments >= 1, "A rounded corner needs at least 1 segment");
+
+    std::array<glm::vec2, 4 * (CornerSegments + 1)> profile{};
+
+    // starting from the bottom right corner
+    const float centerX[4] = { width * 0.5f - radius, width * 0.5f - radius, -width * 0.5f + radius, -width * 0.5f + radius };
+    const float centerY[4] = { -height * 0.5f + radius, height * 0.5f - radius, height * 0.5f - radius, -height * 0.5f + radius };
+
+    for (size_t corner = 0; corner < 4; corner++)
+    {
+        for (size_t k = 0; k <= CornerSegments; k++)
+        {
+            const double angle = FIXED_PROFILE_PI * 0.5 * (double(corner) - 1.0 + double(k) / CornerSegments);
+            profile[corner * (CornerSegments + 1) + k] = glm::vec2(
+                float(centerX[corner] + radius * constexprCos(angle)),
+                float(centerY[corner] + radius * constexprSin(angle))
+            );
+        }
+    }
+
+    return profile;
+}
+
+
+
+// ============= EXTRUDER ============= //
+
+// index pattern of a single segment of the tube, relative to the first vertex of its first ring
+template<size_t N>
+constexpr std::array<unsigned int, N * 6> fixedSegmentIndices(bool seamless)
+{
+    std::array<unsigned int, N * 6> indices{};
+
+    const unsigned int ringSize = seamless ? N : N + 1;
+    for (unsigned int j = 0; j < N; j++)
+    {
+        const unsigned int jNext = seamless ? (j + 1) % N : j + 1;
+
+        indices[j * 6 + 0] = j;
+        indices[j * 6 + 1] = jNext;
+        indices[j * 6 + 2] = ringSize + jNext;
+
+        indices[j * 6 + 3] = j;
+        indices[j * 6 + 4] = ringSize + jNext;
+        indices[j * 6 + 5] = ringSize + j;
+    }
+
+    return indices;
+}
+
+// Same as extrudeProfile, with the per-ring loops of normals and indices unrolled for the given profile size
+template<size_t N, typename T>
+CurveMeshData extrudeProfile(const std::array<glm::vec2, N>& profile, const std::vector<ExtrusionPointT<T>>& extrusionPoints, const ExtrusionOptions& options = ExtrusionOptions(), const glm::vec<3, T>& origin = glm::vec<3, T>(T(0)))
+{
+    static_assert(N >= 3, "Profile needs at least 3 vertices");
+
+    static constexpr std::array<unsigned int, N * 6> SEAMED_INDICES = fixedSegmentIndices<N>(false);
+    static constexpr std::array<unsigned int, N * 6> SEAMLESS_INDICES = fixedSegmentIndices<N>(true);
+
+    CurveMeshData mesh{};
+
+    if(extrusionPoints.size() < 2)
+    {
+        printf("[ERROR][%s(%d)] Not enough points to construct a mesh\n", __FILE__, __LINE__);
+        return mesh;
+    }
+
+    const std::vector<RingFrame> frames = computeRingFrames(extrusionPoints, origin, options);
+    if(isExtrusionCancelled(options))
+    {
+        return mesh;
+    }
+
+    const size_t ringCount = frames.size();
+    const size_t ringSize = options.seamless ? N : N + 1;
+
+
+    // ============= VERTICES ============= //
+    float px[N], py[N];
+    for (size_t j = 0; j < N; j++)
+    {
+        px[j] = profile[j].x;
+        py[j] = profile[j].y;
+    }
+
+    mesh.ringSize = ringSize;
+    mesh.vertices.resize(ringCount * ringSize);
+    for (size_t i = 0; i < ringCount; i++)
+    {
+        if(i % CANCELLATION_CHECK_INTERVAL == 0 && isExtrusionCancelled(options))
+        {
+            return CurveMeshData{};
+        }
+
+        glm::vec3 *ring = &mesh.vertices[i * ringSize];
+        transformProfileRing(px, py, N, frames[i], ring);
+        if(!options.seamless)
+        {
+            ring[N] = ring[0];
+        }
+    }
+
+
+    // ============= UVS ============= //
+    if(!options.seamless)
+    {
+        appendTubeUvs(mesh, ringCount, ringSize);
+    }
+
+
+    // ============= NORMALS ============= //
+    mesh.normals.resize(ringCount * ringSize);
+    for (size_t i = 0; i < ringCount; i++)
+    {
+        if(i % CANCELLATION_CHECK_INTERVAL == 0 && isExtrusionCancelled(options))
+        {
+            return CurveMeshData{};
+        }
+
+        const glm::vec3 *ring = &mesh.vertices[i * ringSize];
+        const glm::vec3 *prevRing = i > 0 ? ring - ringSize : nullptr;
+        const glm::vec3 *nextRing = i + 1 < ringCount ? ring + ringSize : nullptr;
+        glm::vec3 *normals = &mesh.normals[i * ringSize];
+
+        // ring neighbours wrap around the N unique vertices
+        for (size_t j = 0; j < N; j++)
+        {
+            normals[j] = computeTubeNormal(ring[j], ring[(j + N - 1) % N], ring[(j + 1) % N], prevRing ? &prevRing[j] : nullptr, nextRing ? &nextRing[j] : nullptr);
+        }
+        if(!options.seamless)
+        {
+            normals[N] = normals[0];
+        }
+    }
+
+
+    // ============= INDICES ============= //
+    const std::array<unsigned int, N * 6>& pattern = options.seamless ? SEAMLESS_INDICES : SEAMED_INDICES;
+
+    mesh.segmentIndexCount = N * 6;
+    mesh.indices.resize((ringCount - 1) * N * 6);
+    for (size_t i = 0; i < ringCount - 1; i++)
+    {
+        unsigned int *segment = &mesh.indices[i * N * 6];
+        const unsigned int firstVertex = i * ringSize;
+
+        for (size_t k = 0; k < N * 6; k++)
+        {
+            segment[k] = firstVertex + pattern[k];
+        }
+    }
+
+
+    // ============= CAPS AND BOUNDS ============= //
+    const std::vector<glm::vec2> profileVector(profile.begin(), profile.end());
+    if(options.startCap)
+    {
+        appendCap(mesh, profileVector, frames.front(), true, !options.seamless);
+    }
+    if(options.endCap)
+    {
+        appendCap(mesh, profileVector, frames.back(), false, !options.seamless);
+    }
+
+    if(options.computeSegmentBounds)
+    {
+        float radius = 0.f;
+        for(const auto& v : profile)
+        {
+            radius = glm::max(radius, glm::length(v));
+        }
+
+        computeSegmentBounds(frames, radius, mesh.segmentBounds);
+    }
+
+
+    return mesh;
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "curve_mesh.hpp"
+
+
+// All exporters write binary, little-endian files and return false if the file could not be written.
+// Normals and UVs are only written if there is one for every vertex.
+
+// glTF 2.0 binary container with a single mesh and node
+bool exportGlb(const CurveMeshData& mesh, const char *path);
+
+// binary STL, facet normals are computed from the triangles
+bool exportStl(const CurveMeshData& mesh, const char *path);
+
+// binary little-endian PLY with per-vertex position, normal and texture coordinates
+bool exportPly(const CurveMeshData& mesh, const char *path);
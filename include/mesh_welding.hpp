@@ -0,0 +1,19 @@
+#pragma once
+
+#include "curve_mesh.hpp"
+
+
+struct WeldOptions
+{
+    // vertices closer to each other than this are merged into one
+    float tolerance = 1e-5f;
+
+    // If true, vertices are only merged if their normals and UVs match as well and the attributes are kept.
+    // Otherwise the welded mesh has positions and indices only.
+    bool keepAttributes = false;
+};
+
+// Merges coincident vertices and drops triangles that become degenerate or duplicated in the process,
+// as well as vertices no triangle refers to anymore.
+// The result has no ring structure, so ringSize, segmentIndexCount and segmentBounds are left empty.
+CurveMeshData weldMesh(const CurveMeshData& mesh, const WeldOptions& options = WeldOptions());
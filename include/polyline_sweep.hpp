@@ -0,0 +1,46 @@
+#pragma once
+
+#include "curve_mesh.hpp"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+
+enum class PolylineJoint
+{
+    // the segments meet in the plane halfway between them, in a sharp corner
+    Miter,
+    // the corner is cut off by a short straight segment
+    Bevel,
+    // the corner is replaced by an arc
+    Round,
+};
+
+struct PolylineSweepOptions
+{
+    PolylineJoint joint = PolylineJoint::Miter;
+
+    // Miter joints where the profile would get stretched by more than this are bevelled instead.
+    // The stretch is 1 / cos(turn / 2), the same ratio as the miter limit of SVG strokes.
+    // It also bounds the stretch where no joint fits, e.g. where the polyline doubles back on itself.
+    float miterLimit = 4.f;
+
+    // Radius of bevelled and rounded corners, in multiples of the profile's radius.
+    // At 1 or less the inside of the bend pinches. Corners are made smaller where the segments are too short to fit them.
+    float cornerRadius = 2.f;
+    // largest turn between two segments of a rounded corner, in radians
+    float roundStepAngle = 0.2f;
+
+    // points where the polyline turns by less than this angle, in radians, are dropped,
+    // so that straight runs are extruded as single segments
+    float collinearAngle = 1e-3f;
+};
+
+// Extrudes the profile along a polyline with sharp corners, joining the segments as requested by the options.
+// The profile is carried along the polyline without twisting, starting from the frame extrudeProfile would give the first point.
+// Mitered and bevelled corners are creases, their rings are repeated so that each side gets its own normals;
+// ringSize, segmentIndexCount and segmentBounds describe the mesh as usual, with the repeated rings not counted as segments.
+// profile vertices should be given in a counter-clockwise order around a (0,0) origin to avoid inverted normals
+template<typename T>
+CurveMeshData extrudeProfileAlongPolyline(const std::vector<glm::vec2>& profile, const std::vector<glm::vec<3, T>>& polyline, const PolylineSweepOptions& sweepOptions = PolylineSweepOptions(), const ExtrusionOptions& options = ExtrusionOptions(), const glm::vec<3, T>& origin = glm::vec<3, T>(T(0)));
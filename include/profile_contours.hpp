@@ -0,0 +1,51 @@
+#pragma once
+
+#include "curve_mesh.hpp"
+#include "curve_sampler.hpp"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+
+// One closed loop of a profile made of several, e.g. the inner wall of a hollow pipe or one cable of a bundle
+struct ProfileContour
+{
+    std::vector<glm::vec2> vertices;
+    // Holes are cut out of the outer contour around them and get their faces turned towards the hole.
+    // Any winding is accepted, outer contours are extruded counter-clockwise and holes clockwise.
+    bool isHole = false;
+};
+
+// where the pieces of one contour are in MultiContourMeshData::mesh
+struct ContourRange
+{
+    // The tube of the contour starts at firstVertex with its rings one after another, followed by its caps if it has any.
+    unsigned int firstVertex;
+    unsigned int vertexCount;
+    unsigned int firstIndex;
+    unsigned int indexCount;
+
+    // like CurveMeshData::ringSize and segmentIndexCount, for this contour alone
+    unsigned int ringSize;
+    unsigned int segmentIndexCount;
+};
+
+struct MultiContourMeshData
+{
+    // All contours in one mesh, one after another. ringSize and segmentIndexCount are left at 0 since they differ between
+    // the contours, segmentBounds are shared by all of them.
+    CurveMeshData mesh;
+    // one per contour, in the order they were given
+    std::vector<ContourRange> contours;
+};
+
+// Extrudes every contour along the same extrusion points, with the frames computed only once for all of them.
+// Caps are added to outer contours without holes inside them; the cap triangulation can't cut out holes,
+// so outer contours with holes and the holes themselves stay open.
+template<typename T>
+MultiContourMeshData extrudeProfileContours(std::vector<ProfileContour> contours, const std::vector<ExtrusionPointT<T>>& extrusionPoints, const ExtrusionOptions& options = ExtrusionOptions(), const glm::vec<3, T>& origin = glm::vec<3, T>(T(0)));
+
+// same as above, along a curve sampled into `segmentCount` segments like extrudeProfileWithCurve does
+template<typename T>
+MultiContourMeshData extrudeProfileContoursWithCurve(const std::vector<ProfileContour>& contours, const CurveSamplerT<T>& curve, unsigned int segmentCount, const ExtrusionOptions& options = ExtrusionOptions(), const glm::vec<3, T>& origin = glm::vec<3, T>(T(0)));
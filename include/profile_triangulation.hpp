@@ -0,0 +1,12 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+
+// Splits a simple (possibly concave) closed profile into triangles using ear clipping.
+// Returned indices point into `profile` and every triangle is wound counter-clockwise,
+// regardless of the winding of the profile itself.
+// Results are cached per thread, so repeated calls for the same profile are cheap.
+std::vector<unsigned int> triangulateProfile(const std::vector<glm::vec2>& profile);
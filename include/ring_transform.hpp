@@ -0,0 +1,34 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <vector>
+
+
+// Placement of the profile plane at a single extrusion point.
+// A profile vertex (x, y) lands at `position + x * right + y * up`.
+struct RingFrame
+{
+    glm::vec3 position;
+    glm::vec3 right;
+    glm::vec3 up;
+};
+
+// Profile coordinates kept in separate arrays, so that they can be transformed in wide batches
+struct ProfileSoA
+{
+    std::vector<float> x;
+    std::vector<float> y;
+};
+
+ProfileSoA makeProfileSoA(const std::vector<glm::vec2>& profile);
+
+// Transforms `count` profile vertices by the frame and writes them to `out` in the usual AoS layout.
+// Uses the widest kernel supported by the CPU the program runs on.
+void transformProfileRing(const float *x, const float *y, size_t count, const RingFrame& frame, glm::vec3 *out);
+
+void transformProfileRing(const ProfileSoA& profile, const RingFrame& frame, glm::vec3 *out);
+
+// Name of the kernel picked at runtime, e.g. "avx2" or "scalar"
+const char *ringTransformKernelName();
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "bounding_box.hpp"
+#include "curve_mesh.hpp"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+
+// Nodes are stored in depth-first order, so the left child of an inner node always directly follows it
+struct BvhNode
+{
+    BoundingBox bounds;
+    // for leaves the index of the first entry in SegmentBvh::segments, for inner nodes the index of the right child
+    unsigned int offset;
+    // number of segments in a leaf, 0 for inner nodes
+    unsigned int segmentCount;
+};
+
+struct SegmentBvh
+{
+    std::vector<BvhNode> nodes;
+    // indices of segments referenced by the leaves
+    std::vector<unsigned int> segments;
+};
+
+struct CurveMeshHit
+{
+    unsigned int segment;
+    unsigned int triangle; // index of the first of triangle's indices in CurveMeshData::indices divided by 3
+    float distance;
+    glm::vec3 position;
+};
+
+
+// Builds a linear BVH by sorting the boxes along a Morton curve.
+// Big inputs are processed on multiple threads.
+SegmentBvh buildSegmentBvh(const std::vector<BoundingBox>& bounds);
+
+// Appends indices of all segments whose bounds are hit by the ray within `maxDistance`
+void raycastSegmentBvh(const SegmentBvh& bvh, glm::vec3 origin, glm::vec3 direction, float maxDistance, std::vector<unsigned int>& segments);
+
+// Planes are stored as (normal, distance) with normals pointing towards the inside of the frustum
+void extractFrustumPlanes(const glm::mat4& viewProjection, glm::vec4 planes[6]);
+
+// Appends indices of all segments whose bounds are at least partially inside the frustum
+void cullSegmentBvh(const SegmentBvh& bvh, const glm::vec4 planes[6], std::vector<unsigned int>& segments);
+
+// Finds the closest triangle of the mesh hit by the ray.
+// The BVH must have been built from mesh.segmentBounds.
+bool pickCurveMesh(const CurveMeshData& mesh, const SegmentBvh& bvh, glm::vec3 origin, glm::vec3 direction, CurveMeshHit& hit);
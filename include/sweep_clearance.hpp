@@ -0,0 +1,76 @@
+#pragma once
+
+#include "curve_mesh.hpp"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+
+// All points within `radius` of the segment from `a` to `b`
+struct Capsule
+{
+    glm::vec3 a;
+    glm::vec3 b;
+    float radius;
+};
+
+// Distance between the surfaces of two capsules, negative if they overlap
+float capsuleDistance(const Capsule& c0, const Capsule& c1);
+
+// Bounds of the segments of a sweep, one capsule between every two rings.
+// The capsule runs between the ring centers with the radius of the bigger ring, so it contains the whole surface
+// extrudeProfile makes between the two rings, whatever the roll of the rings.
+template<typename T>
+std::vector<Capsule> makeSweepCapsules(const std::vector<glm::vec2>& profile, const std::vector<ExtrusionPointT<T>>& extrusionPoints, const glm::vec<3, T>& origin = glm::vec<3, T>(T(0)));
+
+struct ClearanceOptions
+{
+    // smallest allowed distance between the surfaces of two sweeps
+    float clearance = 0.f;
+    // also look for sweeps that run into themselves and for bends tighter than the profile
+    bool checkSelf = true;
+    // most bytes the spatial hash grid may take, 0 for half of the physical memory
+    size_t memoryLimit = 0;
+};
+
+// Two segments that come closer than the clearance. For segments of the same sweep, sweepA == sweepB and segmentA < segmentB.
+struct ClearanceViolation
+{
+    unsigned int sweepA;
+    unsigned int segmentA;
+    unsigned int sweepB;
+    unsigned int segmentB;
+    // distance between the capsules, negative if they overlap
+    float distance;
+};
+
+// A point of a sweep where the curve bends tighter than the profile reaches, so the surface folds over itself
+struct TightBend
+{
+    unsigned int sweep;
+    // index of the ring, the bend is between segments point - 1 and point
+    unsigned int point;
+    // radius of the circle through this point and its neighbours
+    float bendRadius;
+    float profileRadius;
+};
+
+struct ClearanceReport
+{
+    // False if the check had to give up, because there were too many segments or the grid would need more than the memory limit.
+    // Violations are missing then, so an incomplete report must not be taken for a clear one.
+    bool complete = true;
+
+    // sorted by sweepA, segmentA, sweepB, segmentB
+    std::vector<ClearanceViolation> violations;
+    std::vector<TightBend> tightBends;
+};
+
+// Finds all pairs of segments of different sweeps, and with checkSelf also of the same sweep, that come closer than the clearance.
+// Candidate pairs are found by putting the boxes of all capsules into a spatial hash grid, then the capsules themselves are tested,
+// both on multiple threads. Capsules longer than a cell are split into pieces for the grid, so long straight segments stay cheap.
+// Segments of the same sweep are only compared if they are more than half a circle of the profile's radius apart along the sweep,
+// since closer ones touch wherever the sweep bends; bends that are too tight are reported as TightBend instead.
+// Gives up with ClearanceReport::complete cleared if the segments don't fit the grid or ClearanceOptions::memoryLimit.
+ClearanceReport checkSweepClearance(const std::vector<std::vector<Capsule>>& sweeps, const ClearanceOptions& options = ClearanceOptions());
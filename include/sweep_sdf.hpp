@@ -0,0 +1,61 @@
+#pragma once
+
+#include "curve_mesh.hpp"
+#include "ring_transform.hpp"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+
+const int SDF_BLOCK_SIZE = 8;
+const int SDF_BLOCK_VOXELS = SDF_BLOCK_SIZE * SDF_BLOCK_SIZE * SDF_BLOCK_SIZE;
+
+// Signed distances to the surface of one or more sweeps, negative inside, stored only near the surface.
+// Distances are sampled at the corners of voxels, voxel (x, y, z) sits at (x, y, z) * voxelSize.
+// The grid is split into blocks of SDF_BLOCK_SIZE^3 voxels and only blocks within `bandWidth` of a surface are kept.
+// Distances are clamped to [-bandWidth, bandWidth].
+struct SparseSdfGrid
+{
+    float voxelSize = 0.f;
+    float bandWidth = 0.f;
+
+    // Block coordinates in units of blocks, sorted by x, then y, then z.
+    // Voxel (x, y, z) of block `i` is distances[i * SDF_BLOCK_VOXELS + (z * SDF_BLOCK_SIZE + y) * SDF_BLOCK_SIZE + x].
+    std::vector<glm::ivec3> blocks;
+    std::vector<float> distances;
+};
+
+// A sweep as the baker sees it, the profile placed at every ring
+struct SweepSdfSource
+{
+    std::vector<glm::vec2> profile;
+    std::vector<RingFrame> frames;
+};
+
+// profile vertices in counter-clockwise order, like for extrudeProfile
+template<typename T>
+SweepSdfSource makeSweepSdfSource(const std::vector<glm::vec2>& profile, const std::vector<ExtrusionPointT<T>>& extrusionPoints, const glm::vec<3, T>& origin = glm::vec<3, T>(T(0)));
+
+struct SdfBakeOptions
+{
+    float voxelSize = 0.05f;
+    // distances are only computed this far from the surfaces, in units of length
+    float bandWidth = 0.2f;
+};
+
+// Bakes the distance to the union of the sweeps straight from their rings, without making meshes.
+// A point is measured against every segment nearby: it's projected onto the segment's axis, placed in the profile plane
+// interpolated between the two rings there and measured against the profile polygon. The ends of every sweep are closed
+// with flat caps, as with ExtrusionOptions::startCap and endCap. Distances are signed per segment and the smallest one is kept,
+// so overlapping sweeps and sweeps crossing themselves measure the inside to the surface of their union, not to surfaces buried in it.
+// Blocks are baked in parallel, each against the segments whose bounds reach it, with wide SIMD where the CPU supports it.
+SparseSdfGrid bakeSweepSdf(const std::vector<SweepSdfSource>& sweeps, const SdfBakeOptions& options = SdfBakeOptions());
+
+// Trilinearly interpolated distance at the given point, bandWidth where no block is stored
+float sampleSparseSdf(const SparseSdfGrid& grid, const glm::vec3& position);
+
+// Writes the grid to a little-endian binary file: "SSDF", format version, block size, block count (all uint32),
+// voxel size and band width (float), then the block coordinates (3 int32 each) and the distances of all blocks.
+// Returns false if the file could not be written.
+bool exportSparseSdf(const SparseSdfGrid& grid, const char *path);
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+
+struct TrackKey
+{
+    float time; // position along the sweep in range [0, 1]
+    float value;
+};
+
+// Piecewise linear track, keys must be sorted by time.
+// Values before the first and after the last key are held constant.
+typedef std::vector<TrackKey> KeyframeTrack;
+
+// Properties animated along the length of a sweep, an empty track leaves the property at its default
+struct SweepTracks
+{
+    KeyframeTrack scale; // profile scale, 1 by default, values closer to 0 than MIN_RING_SCALE are pushed away from it
+    KeyframeTrack roll;  // additional roll in radians, 0 by default
+    KeyframeTrack blend; // mix factor between the source and target profile, 0 by default
+};
+
+// Evaluates the track at `count` evenly spaced times covering [0, 1] and writes the values to `out`.
+// Done in a single pass over the keys, with a branchless inner loop over all samples between two keys.
+void evaluateTrack(const KeyframeTrack& track, float defaultValue, size_t count, float *out);
@@ -0,0 +1,160 @@
+#include "async_extruder.hpp"
+
+#include <algorithm> // std::max
+#include <exception>
+
+
+AsyncExtruder::AsyncExtruder(unsigned int threadCount)
+: m_stopping(false)
+{
+    if(threadCount == 0)
+    {
+        threadCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+    }
+
+    m_workers.reserve(threadCount);
+    for (unsigned int i = 0; i < threadCount; i++)
+    {
+        m_workers.emplace_back(&AsyncExtruder::workerLoop, this);
+    }
+}
+
+AsyncExtruder::~AsyncExtruder()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+        for(auto& latest : m_latest)
+        {
+            latest.second->cancelled = true;
+        }
+    }
+    m_wakeUp.notify_all();
+
+    for(auto& worker : m_workers)
+    {
+        worker.join();
+    }
+
+    // nobody is going to pick these up anymore
+    for(auto& task : m_queue)
+    {
+        task->promise.set_value(CurveMeshData{});
+    }
+}
+
+void AsyncExtruder::workerLoop()
+{
+    while(true)
+    {
+        std::shared_ptr<Task> task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wakeUp.wait(lock, [this]() { return m_stopping || !m_queue.empty(); });
+
+            if(m_stopping)
+            {
+                return;
+            }
+
+            task = std::move(m_queue.front());
+            m_queue.pop_front();
+        }
+
+        // superseded tasks that didn't get to start are resolved right away
+        CurveMeshData mesh;
+        std::exception_ptr error;
+        if(!task->cancelled)
+        {
+            try
+            {
+                mesh = task->job(&task->cancelled);
+            }
+            catch(...)
+            {
+                error = std::current_exception();
+            }
+        }
+        if(task->cancelled)
+        {
+            mesh = CurveMeshData{};
+            error = nullptr;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_latest.find(task->key);
+            if(it != m_latest.end() && it->second == task)
+            {
+                m_latest.erase(it);
+            }
+        }
+
+        if(error)
+        {
+            task->promise.set_exception(error);
+        }
+        else
+        {
+            task->promise.set_value(std::move(mesh));
+        }
+    }
+}
+
+std::future<CurveMeshData> AsyncExtruder::submit(unsigned int key, ExtrusionJob job)
+{
+    auto task = std::make_shared<Task>();
+    task->key = key;
+    task->job = std::move(job);
+    task->cancelled = false;
+
+    std::future<CurveMeshData> future = task->promise.get_future();
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        std::shared_ptr<Task>& latest = m_latest[key];
+        if(latest)
+        {
+            latest->cancelled = true;
+        }
+        latest = task;
+
+        m_queue.push_back(std::move(task));
+    }
+    m_wakeUp.notify_one();
+
+    return future;
+}
+
+std::future<CurveMeshData> AsyncExtruder::submitProfileWithCurve(unsigned int key, const std::vector<glm::vec2>& profile, const std::vector<BezierCurvePoint>& curvePoints, unsigned int segmentCount, const ExtrusionOptions& options)
+{
+    return submit(key, [profile, curvePoints, segmentCount, options](const std::atomic<bool> *cancelled) {
+        ExtrusionOptions jobOptions = options;
+        jobOptions.cancelled = cancelled;
+        return extrudeProfileWithCurve(profile, curvePoints, segmentCount, jobOptions);
+    });
+}
+
+void AsyncExtruder::cancel(unsigned int key)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto it = m_latest.find(key);
+    if(it != m_latest.end())
+    {
+        it->second->cancelled = true;
+        m_latest.erase(it);
+    }
+}
+
+void AsyncExtruder::cancelAll()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    for(auto& latest : m_latest)
+    {
+        latest.second->cancelled = true;
+    }
+    m_latest.clear();
+}
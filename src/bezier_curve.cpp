@@ -1,6 +1,10 @@
-#include "bezier_curve.hpp"
+#include "bezier_curve_points.hpp"
 
-static std::vector<std::vector<int>> pascalTriangle {
+#include <deque>
+#include <mutex>
+
+// rows are never moved once added, so references to them stay valid while other threads expand the triangle
+static std::deque<std::vector<int>> pascalTriangle {
     {1},
     {1,1},
     {1,2,1},
@@ -8,22 +12,19 @@ static std::vector<std::vector<int>> pascalTriangle {
     {1,4,6,4,1},
     {1,5,10,10,5,1}
 };
+static std::mutex pascalTriangleMutex;
 
-static const std::vector<int>& expandPascalTriangle(unsigned int degree)
+const std::vector<int>& expandPascalTriangle(unsigned int degree)
 {
-    if(degree < pascalTriangle.size())
-    {
-        return pascalTriangle[degree];
-    }
+    std::lock_guard<std::mutex> lock(pascalTriangleMutex);
 
-    static std::vector<int> newRow;
     while(degree >= pascalTriangle.size())
     {
-        newRow.clear();
-        newRow.reserve(degree + 1);
-
         const std::vector<int>& prevRow = pascalTriangle.back();
 
+        std::vector<int> newRow;
+        newRow.reserve(prevRow.size() + 1);
+
         newRow.push_back(1);
         for (size_t i = 0; i < prevRow.size() - 1; i++)
         {
@@ -31,56 +32,83 @@ static const std::vector<int>& expandPascalTriangle(unsigned int degree)
         }
         newRow.push_back(1);
 
-        pascalTriangle.push_back(newRow);
+        pascalTriangle.push_back(std::move(newRow));
     }
 
     return pascalTriangle[degree];
 }
 
 
-std::vector<glm::vec3> plotBezierCurve(const std::vector<BezierCurvePoint>& points, unsigned int segmentCount)
+template<typename T>
+BezierCurveSampleT<T> rationalCurveSample(const glm::vec<4, T>& h, const glm::vec<4, T>& dh, const glm::vec<4, T>& ddh)
 {
-    std::vector<glm::vec3> result;
+    BezierCurveSampleT<T> sample;
+    sample.position = glm::vec<3, T>(h) / h.w;
+    sample.firstDerivative = (glm::vec<3, T>(dh) - sample.position * dh.w) / h.w;
+    sample.secondDerivative = (glm::vec<3, T>(ddh) - sample.firstDerivative * (T(2) * dh.w) - sample.position * ddh.w) / h.w;
 
-    if(points.size() < 2)
-    {
-        return result;
-    }
+    const T speed = glm::length(sample.firstDerivative);
+    sample.curvature = speed > T(0) ? glm::length(glm::cross(sample.firstDerivative, sample.secondDerivative)) / (speed * speed * speed) : T(0);
 
-    if(points.size() == 2 || segmentCount == 0 || segmentCount == 1)
-    {
-        result.push_back(points[0].position);
-        result.push_back(points[1].position);
-        return result;
-    }
+    return sample;
+}
 
 
-    const unsigned int BEZIER_DEGREE = points.size() - 1;
-    const float STEP = 1.f / segmentCount;
+template<typename T>
+std::vector<glm::vec<3, T>> plotBezierCurve(const std::vector<BezierCurvePointT<T>>& points, unsigned int segmentCount)
+{
+    return plotBezierCurvePoints<T>(points, segmentCount);
+}
 
-    result.reserve(segmentCount + 1);
-    result.push_back(points[0].position);
+template<typename T>
+std::vector<BezierCurveSampleT<T>> sampleBezierCurve(const std::vector<BezierCurvePointT<T>>& points, unsigned int segmentCount)
+{
+    return sampleBezierCurvePoints<T>(points, segmentCount);
+}
 
-    float t = STEP;
-    const std::vector<int>& pascalRow = expandPascalTriangle(BEZIER_DEGREE);
-    for(size_t i = 0; i < segmentCount - 1; i++)
+template<typename T>
+BezierCurveSampleT<T> evaluateBezierCurve(const glm::vec<4, T> *points, unsigned int degree, T t)
+{
+    glm::vec<4, T> work[64];
+    for (unsigned int i = 0; i <= degree; i++)
     {
-        float sum(0.f);
-        glm::vec3 sumWeighed(0.f);
+        work[i] = points[i];
+    }
 
-        for (size_t j = 0; j < pascalRow.size(); j++)
+    // de Casteljau down to the last three points, from which both derivatives can be read
+    const unsigned int stopLevel = degree >= 2 ? 2 : degree;
+    for (unsigned int count = degree; count > stopLevel; count--)
+    {
+        for (unsigned int i = 0; i < count; i++)
         {
-            float component = points[j].ratio * (float)pascalRow[j] * (float)std::pow((1 - t), BEZIER_DEGREE - j) * (float)std::pow(t, j);
-            sum += component;
-            sumWeighed += points[j].position * component;
+            work[i] = work[i] + (work[i + 1] - work[i]) * t;
         }
-
-        result.push_back(sumWeighed / sum);
-        t += STEP;
     }
 
-    result.push_back(points[points.size() - 1].position);
+    glm::vec<4, T> h, dh, ddh(T(0));
+    if(degree >= 2)
+    {
+        glm::vec<4, T> r0 = work[0] + (work[1] - work[0]) * t;
+        glm::vec<4, T> r1 = work[1] + (work[2] - work[1]) * t;
 
+        h = r0 + (r1 - r0) * t;
+        dh = (r1 - r0) * T(degree);
+        ddh = (work[2] - work[1] * T(2) + work[0]) * T(degree * (degree - 1));
+    }
+    else
+    {
+        h = work[0] + (work[1] - work[0]) * t;
+        dh = work[1] - work[0];
+    }
 
-    return result;
+    return rationalCurveSample(h, dh, ddh);
 }
+
+template std::vector<glm::vec<3, float>> plotBezierCurve(const std::vector<BezierCurvePointT<float>>& points, unsigned int segmentCount);
+template std::vector<glm::vec<3, double>> plotBezierCurve(const std::vector<BezierCurvePointT<double>>& points, unsigned int segmentCount);
+template std::vector<BezierCurveSampleT<float>> sampleBezierCurve(const std::vector<BezierCurvePointT<float>>& points, unsigned int segmentCount);
+template std::vector<BezierCurveSampleT<double>> sampleBezierCurve(const std::vector<BezierCurvePointT<double>>& points, unsigned int segmentCount);
+template BezierCurveSampleT<float> evaluateBezierCurve(const glm::vec<4, float> *points, unsigned int degree, float t);
+template BezierCurveSampleT<double> evaluateBezierCurve(const glm::vec<4, double> *points, unsigned int degree, double t);
+template BezierCurveSampleT<float> rationalCurveSample(const glm::vec<4, float>& h, const glm::vec<4, float>& dh, const glm::vec<4, float>& ddh);
+template BezierCurveSampleT<double> rationalCurveSample(const glm::vec<4, double>& h, const glm::vec<4, double>& dh, const glm::vec<4, double>& ddh);
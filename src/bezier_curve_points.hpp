@@ -0,0 +1,158 @@
+#pragma once
+
+// Internals of the Bezier curve module, shared with the modules that evaluate curves stored in other forms
+
+#include "bezier_curve.hpp"
+
+#include <vector>
+
+
+// row `degree` of Pascal's triangle, safe to call from multiple threads
+const std::vector<int>& expandPascalTriangle(unsigned int degree);
+
+// Bernstein polynomials of degrees n, n-1 and n-2 at a single parameter,
+// sharing the powers of t and (1 - t) between all of them
+template<typename T>
+struct BernsteinBasis
+{
+    unsigned int degree;
+    const std::vector<int> *pascalRows[3];
+    std::vector<T> tPowers;
+    std::vector<T> uPowers;
+
+    BernsteinBasis(unsigned int degree)
+    : degree(degree), tPowers(degree + 1), uPowers(degree + 1)
+    {
+        for (unsigned int k = 0; k < 3; k++)
+        {
+            pascalRows[k] = degree >= k ? &expandPascalTriangle(degree - k) : nullptr;
+        }
+    }
+
+    void setParameter(T t)
+    {
+        tPowers[0] = uPowers[0] = T(1);
+        for (unsigned int k = 1; k <= degree; k++)
+        {
+            tPowers[k] = tPowers[k - 1] * t;
+            uPowers[k] = uPowers[k - 1] * (T(1) - t);
+        }
+    }
+
+    // sum of `points` weighted by the basis of degree n - `lowering`
+    template<typename V>
+    V combine(const std::vector<V>& points, unsigned int lowering) const
+    {
+        const unsigned int m = degree - lowering;
+        const std::vector<int>& row = *pascalRows[lowering];
+
+        V sum(T(0));
+        for (unsigned int i = 0; i <= m; i++)
+        {
+            sum += points[i] * (T(row[i]) * tPowers[i] * uPowers[m - i]);
+        }
+        return sum;
+    }
+};
+
+// `Points` is anything indexable that gives BezierCurvePointT<T>, so that packed curves are read without unpacking them first
+template<typename T, typename Points>
+std::vector<glm::vec<3, T>> plotBezierCurvePoints(const Points& points, unsigned int segmentCount)
+{
+    std::vector<glm::vec<3, T>> result;
+
+    if(points.size() < 2)
+    {
+        return result;
+    }
+
+    if(points.size() == 2 || segmentCount == 0 || segmentCount == 1)
+    {
+        result.push_back(points[0].position);
+        result.push_back(points[points.size() - 1].position);
+        return result;
+    }
+
+
+    const unsigned int BEZIER_DEGREE = points.size() - 1;
+
+    std::vector<glm::vec<4, T>> homogeneous(points.size());
+    for (size_t j = 0; j < points.size(); j++)
+    {
+        const BezierCurvePointT<T> point = points[j];
+        homogeneous[j] = glm::vec<4, T>(point.position * point.ratio, point.ratio);
+    }
+
+    result.reserve(segmentCount + 1);
+    result.push_back(points[0].position);
+
+    BernsteinBasis<T> basis(BEZIER_DEGREE);
+    for(size_t i = 1; i < segmentCount; i++)
+    {
+        // computed from the index every time, so that rounding errors don't pile up along the curve
+        basis.setParameter(T(i) / T(segmentCount));
+
+        glm::vec<4, T> h = basis.combine(homogeneous, 0);
+        result.push_back(glm::vec<3, T>(h) / h.w);
+    }
+
+    result.push_back(points[points.size() - 1].position);
+
+
+    return result;
+}
+
+template<typename T, typename Points>
+std::vector<BezierCurveSampleT<T>> sampleBezierCurvePoints(const Points& points, unsigned int segmentCount)
+{
+    std::vector<BezierCurveSampleT<T>> result;
+
+    if(points.size() < 2)
+    {
+        return result;
+    }
+
+    // like in plotBezierCurve, a straight line is not divided
+    if(points.size() == 2 || segmentCount == 0)
+    {
+        segmentCount = 1;
+    }
+
+    const unsigned int degree = points.size() - 1;
+
+    // homogeneous control points of the curve and of its first two derivatives (hodographs)
+    std::vector<glm::vec<4, T>> homogeneous(degree + 1), firstHodograph(degree), secondHodograph(degree >= 2 ? degree - 1 : 0);
+    for (size_t j = 0; j <= degree; j++)
+    {
+        const BezierCurvePointT<T> point = points[j];
+        homogeneous[j] = glm::vec<4, T>(point.position * point.ratio, point.ratio);
+    }
+    for (size_t j = 0; j < firstHodograph.size(); j++)
+    {
+        firstHodograph[j] = (homogeneous[j + 1] - homogeneous[j]) * T(degree);
+    }
+    for (size_t j = 0; j < secondHodograph.size(); j++)
+    {
+        secondHodograph[j] = (firstHodograph[j + 1] - firstHodograph[j]) * T(degree - 1);
+    }
+
+    result.resize(segmentCount + 1);
+
+    BernsteinBasis<T> basis(degree);
+    for (size_t i = 0; i <= segmentCount; i++)
+    {
+        basis.setParameter(T(i) / T(segmentCount));
+
+        result[i] = rationalCurveSample(
+            basis.combine(homogeneous, 0),
+            basis.combine(firstHodograph, 1),
+            degree >= 2 ? basis.combine(secondHodograph, 2) : glm::vec<4, T>(T(0))
+        );
+    }
+
+    // the ends of the curve are exactly at the first and last point
+    result.front().position = points[0].position;
+    result.back().position = points[degree].position;
+
+    return result;
+}
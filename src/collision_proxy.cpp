@@ -0,0 +1,245 @@
+#include "collision_proxy.hpp"
+
+#include <algorithm> // std::sort, std::unique, std::max, std::min
+#include <cmath>
+#include <cstdio>
+#include <limits>
+
+
+static float cross2D(const glm::vec2& o, const glm::vec2& a, const glm::vec2& b)
+{
+    return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+}
+
+std::vector<glm::vec2> convexHull2D(std::vector<glm::vec2> points)
+{
+    std::sort(points.begin(), points.end(), [](const glm::vec2& a, const glm::vec2& b) {
+        return a.x != b.x ? a.x < b.x : a.y < b.y;
+    });
+    points.erase(std::unique(points.begin(), points.end()), points.end());
+
+    if(points.size() < 3)
+    {
+        return points;
+    }
+
+    // Andrew's monotone chain, lower half and then upper half
+    std::vector<glm::vec2> hull(2 * points.size());
+    size_t count = 0;
+    for (size_t i = 0; i < points.size(); i++)
+    {
+        while(count >= 2 && cross2D(hull[count - 2], hull[count - 1], points[i]) <= 0.f)
+        {
+            count--;
+        }
+        hull[count++] = points[i];
+    }
+    for (size_t i = points.size() - 1, lowerCount = count + 1; i > 0; i--)
+    {
+        while(count >= lowerCount && cross2D(hull[count - 2], hull[count - 1], points[i - 1]) <= 0.f)
+        {
+            count--;
+        }
+        hull[count++] = points[i - 1];
+    }
+
+    // the first point was added again at the end
+    hull.resize(count - 1);
+    return hull;
+}
+
+// distance from the profile's origin to the closest edge of its hull, 0 if the origin is not inside
+static float hullInradius(const std::vector<glm::vec2>& hull)
+{
+    if(hull.size() < 3)
+    {
+        return 0.f;
+    }
+
+    float inradius = std::numeric_limits<float>::max();
+    for (size_t i = 0; i < hull.size(); i++)
+    {
+        const glm::vec2& a = hull[i];
+        const glm::vec2& b = hull[(i + 1) % hull.size()];
+        inradius = std::min(inradius, cross2D(a, b, glm::vec2(0.f)) / glm::length(b - a));
+    }
+    return std::max(inradius, 0.f);
+}
+
+static float segmentPointDistance(const glm::vec3& a, const glm::vec3& b, const glm::vec3& p)
+{
+    const glm::vec3 ab = b - a;
+    const float lengthSquared = glm::dot(ab, ab);
+    const float t = lengthSquared > 0.f ? glm::clamp(glm::dot(p - a, ab) / lengthSquared, 0.f, 1.f) : 0.f;
+    return glm::length(a + ab * t - p);
+}
+
+template<typename T>
+CollisionProxy buildCollisionProxy(const std::vector<glm::vec2>& profile, const std::vector<ExtrusionPointT<T>>& extrusionPoints, const CollisionProxyOptions& options, const glm::vec<3, T>& origin)
+{
+    CollisionProxy proxy;
+    proxy.type = options.type;
+
+    if(extrusionPoints.size() < 2 || profile.empty())
+    {
+        printf("[ERROR][%s(%d)] Not enough points to make a collision proxy\n", __FILE__, __LINE__);
+        return proxy;
+    }
+
+    const std::vector<glm::vec2> hull = convexHull2D(profile);
+    const ProfileSoA hullSoA = makeProfileSoA(hull);
+
+    float profileRadius = 0.f;
+    for(const auto& vertex : hull)
+    {
+        profileRadius = std::max(profileRadius, glm::length(vertex));
+    }
+
+    // a capsule is at most this much bigger than the profile in any direction
+    if(proxy.type == CollisionProxyType::Automatic)
+    {
+        proxy.type = profileRadius - hullInradius(hull) <= options.tolerance ? CollisionProxyType::Capsules : CollisionProxyType::ConvexHulls;
+    }
+
+    const size_t ringCount = extrusionPoints.size();
+
+    // capsules only need the centers and sizes of the rings, not their orientation
+    std::vector<RingFrame> frames(ringCount);
+    std::vector<float> ringRadius(ringCount);
+    std::vector<float> distances(ringCount);
+    for (size_t i = 0; i < ringCount; i++)
+    {
+        if(proxy.type == CollisionProxyType::Capsules)
+        {
+            frames[i].position = glm::vec3(extrusionPoints[i].position - origin);
+        }
+        else
+        {
+            frames[i] = computeRingFrame(extrusionPoints[i], origin);
+        }
+        ringRadius[i] = profileRadius * std::abs(extrusionPoints[i].scale);
+        distances[i] = i > 0 ? distances[i - 1] + glm::length(frames[i].position - frames[i - 1].position) : 0.f;
+    }
+
+    // largest distance between the rings inside a piece from `first` to `last` and the piece, stops early once it's over the tolerance
+    auto pieceError = [&](size_t first, size_t last) -> float {
+        float error = 0.f;
+
+        if(proxy.type == CollisionProxyType::Capsules)
+        {
+            float minRadius = ringRadius[first], maxRadius = ringRadius[first];
+            for (size_t k = first + 1; k <= last && error <= options.tolerance; k++)
+            {
+                minRadius = std::min(minRadius, ringRadius[k]);
+                maxRadius = std::max(maxRadius, ringRadius[k]);
+                error = std::max(error, segmentPointDistance(frames[first].position, frames[last].position, frames[k].position));
+            }
+            return std::max(error, maxRadius - minRadius);
+        }
+
+        // hull vertices of the rings in between are compared with the vertices interpolated between the first and last ring
+        const float length = distances[last] - distances[first];
+        for (size_t k = first + 1; k < last && error <= options.tolerance; k++)
+        {
+            const float s = length > 0.f ? (distances[k] - distances[first]) / length : 0.f;
+            for (size_t m = 0; m < hull.size(); m++)
+            {
+                auto place = [&](const RingFrame& frame) {
+                    return frame.position + hull[m].x * frame.right + hull[m].y * frame.up;
+                };
+                const glm::vec3 expected = place(frames[first]) * (1.f - s) + place(frames[last]) * s;
+                error = std::max(error, glm::length(place(frames[k]) - expected));
+            }
+        }
+        return error;
+    };
+
+    const size_t maxSegments = std::max(options.maxSegmentsPerPiece, 1u);
+
+    proxy.firstRing.push_back(0);
+    if(proxy.type == CollisionProxyType::ConvexHulls)
+    {
+        proxy.hullOffsets.push_back(0);
+    }
+
+    size_t first = 0;
+    while(first < ringCount - 1)
+    {
+        // The piece grows in doubling steps while it stays within the tolerance and then the exact end is found by bisection,
+        // so that long pieces don't have their rings checked over and over.
+        const size_t lastAllowed = std::min(first + maxSegments, ringCount - 1);
+        size_t last = first + 1;
+        if(options.tolerance > 0.f)
+        {
+            size_t tooFar = lastAllowed + 1;
+            for (size_t step = 1; last < lastAllowed; step *= 2)
+            {
+                const size_t next = std::min(last + step, lastAllowed);
+                if(pieceError(first, next) > options.tolerance)
+                {
+                    tooFar = next;
+                    break;
+                }
+                last = next;
+            }
+            while(tooFar - last > 1)
+            {
+                const size_t middle = last + (tooFar - last) / 2;
+                if(pieceError(first, middle) <= options.tolerance)
+                {
+                    last = middle;
+                }
+                else
+                {
+                    tooFar = middle;
+                }
+            }
+        }
+
+        if(proxy.type == CollisionProxyType::Capsules)
+        {
+            float radius = 0.f;
+            for (size_t k = first; k <= last; k++)
+            {
+                radius = std::max(radius, ringRadius[k]);
+            }
+            proxy.capsules.push_back({frames[first].position, frames[last].position, radius});
+        }
+        else
+        {
+            const size_t offset = proxy.hullPoints.size();
+            proxy.hullPoints.resize(offset + 2 * hull.size());
+            transformProfileRing(hullSoA, frames[first], &proxy.hullPoints[offset]);
+            transformProfileRing(hullSoA, frames[last], &proxy.hullPoints[offset + hull.size()]);
+            proxy.hullOffsets.push_back(proxy.hullPoints.size());
+        }
+
+        proxy.firstRing.push_back(last);
+        first = last;
+    }
+
+    return proxy;
+}
+
+template<typename T>
+CollisionProxy buildCollisionProxyWithCurve(const std::vector<glm::vec2>& profile, const CurveSamplerT<T>& curve, unsigned int segmentCount, const CollisionProxyOptions& options, const glm::vec<3, T>& origin)
+{
+    auto samples = curve.sample(segmentCount);
+
+    if(samples.size() < 2)
+    {
+        printf("[ERROR][%s(%d)] Not enough points to plot a curve\n", __FILE__, __LINE__);
+        CollisionProxy proxy;
+        proxy.type = options.type;
+        return proxy;
+    }
+
+    return buildCollisionProxy(profile, computeExtrusionPoints(samples), options, origin);
+}
+
+
+
+template CollisionProxy buildCollisionProxy(const std::vector<glm::vec2>&, const std::vector<ExtrusionPointT<float>>&, const CollisionProxyOptions&, const glm::vec<3, float>&);
+template CollisionProxy buildCollisionProxy(const std::vector<glm::vec2>&, const std::vector<ExtrusionPointT<double>>&, const CollisionProxyOptions&, const glm::vec<3, double>&);
+template CollisionProxy buildCollisionProxyWithCurve(const std::vector<glm::vec2>&, const CurveSamplerT<float>&, unsigned int, const CollisionProxyOptions&, const glm::vec<3, float>&);
+template CollisionProxy buildCollisionProxyWithCurve(const std::vector<glm::vec2>&, const CurveSamplerT<double>&, unsigned int, const CollisionProxyOptions&, const glm::vec<3, double>&);
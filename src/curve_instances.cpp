@@ -0,0 +1,173 @@
+#include "curve_instances.hpp"
+
+#include "parallel_for.hpp"
+
+#include <algorithm> // std::min, std::upper_bound
+#include <cmath> // std::cos, std::sin, std::floor
+#include <cstdint>
+#include <cstdio>
+
+
+const size_t MIN_INSTANCES_PER_THREAD = 16384;
+
+
+// random number in range [-1, 1] that depends only on its arguments, so instances can be placed in any order
+static float jitterRandom(uint32_t seed, uint32_t index, uint32_t channel)
+{
+    uint32_t h = seed * 0x9E3779B9u ^ index * 0x85EBCA6Bu ^ channel * 0xC2B2AE35u;
+    h ^= h >> 16;
+    h *= 0x7FEB352Du;
+    h ^= h >> 15;
+    h *= 0x846CA68Bu;
+    h ^= h >> 16;
+
+    return float(h >> 8) * (2.f / 16777216.f) - 1.f;
+}
+
+template<typename T>
+std::vector<InstanceTransform> placeInstances(const std::vector<ExtrusionPointT<T>>& extrusionPoints, const InstancePlacement& placement, const glm::vec<3, T>& origin)
+{
+    std::vector<InstanceTransform> instances;
+
+    if(extrusionPoints.size() < 2)
+    {
+        printf("[ERROR][%s(%d)] Not enough points to place instances along\n", __FILE__, __LINE__);
+        return instances;
+    }
+    if(placement.spacing < 0.f || (placement.spacing == 0.f && placement.count == 0))
+    {
+        printf("[ERROR][%s(%d)] Either a positive spacing or a count of instances is needed\n", __FILE__, __LINE__);
+        return instances;
+    }
+    if(!(placement.offset >= 0.f))
+    {
+        printf("[ERROR][%s(%d)] Offset of the first instance can't be negative\n", __FILE__, __LINE__);
+        return instances;
+    }
+
+    const size_t ringCount = extrusionPoints.size();
+
+    // distance of every ring from the start, kept in the precision of the curve
+    std::vector<T> distances(ringCount);
+    distances[0] = T(0);
+    for (size_t i = 1; i < ringCount; i++)
+    {
+        distances[i] = distances[i - 1] + glm::length(extrusionPoints[i].position - extrusionPoints[i - 1].position);
+    }
+    const T length = distances.back();
+
+    // counted in the precision of the curve first, a tiny spacing could overflow size_t
+    T requestedCount = T(placement.count);
+    if(placement.spacing > 0.f)
+    {
+        requestedCount = T(placement.offset) <= length ? std::floor((length - T(placement.offset)) / T(placement.spacing)) + T(1) : T(0);
+    }
+    if(!(requestedCount <= T(MAX_INSTANCE_COUNT)))
+    {
+        printf("[ERROR][%s(%d)] More than %zu instances to place\n", __FILE__, __LINE__, MAX_INSTANCE_COUNT);
+        return instances;
+    }
+    const size_t instanceCount = size_t(requestedCount);
+
+    // the third axis is interpolated along with the other two, rolling the instances doesn't change it
+    std::vector<RingFrame> frames(ringCount);
+    std::vector<glm::vec3> forwards(ringCount);
+    parallelFor(ringCount, MIN_INSTANCES_PER_THREAD, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+        {
+            frames[i] = computeRingFrame(extrusionPoints[i], origin);
+            forwards[i] = glm::normalize(glm::cross(frames[i].right, frames[i].up)) * glm::length(frames[i].right);
+        }
+    });
+
+    instances.resize(instanceCount);
+    parallelFor(instanceCount, MIN_INSTANCES_PER_THREAD, [&](size_t begin, size_t end) {
+        size_t ring = 0;
+        for (size_t k = begin; k < end; k++)
+        {
+            T distance;
+            if(placement.spacing > 0.f)
+            {
+                distance = T(placement.offset) + T(k) * T(placement.spacing);
+            }
+            else
+            {
+                distance = instanceCount > 1 ? length * T(k) / T(instanceCount - 1) : T(0);
+            }
+
+            if(placement.jitterDistance > 0.f)
+            {
+                distance = glm::clamp(distance + T(placement.jitterDistance * jitterRandom(placement.seed, k, 0)), T(0), length);
+            }
+
+            // the first ring of the segment the instance is on; found by a search for the first instance of every
+            // thread, after that instances are mostly in order and stepping from the previous segment is enough
+            if(k == begin)
+            {
+                ring = std::upper_bound(distances.begin(), distances.end(), distance) - distances.begin();
+                ring = ring > 0 ? ring - 1 : 0;
+            }
+            while(ring + 2 < ringCount && distance > distances[ring + 1])
+            {
+                ring++;
+            }
+            while(ring > 0 && distance < distances[ring])
+            {
+                ring--;
+            }
+            ring = std::min(ring, ringCount - 2);
+
+            const T segmentLength = distances[ring + 1] - distances[ring];
+            const float t = segmentLength > T(0) ? float(glm::clamp((distance - distances[ring]) / segmentLength, T(0), T(1))) : 0.f;
+
+            const RingFrame& a = frames[ring];
+            const RingFrame& b = frames[ring + 1];
+
+            InstanceTransform& instance = instances[k];
+            instance.position = a.position + (b.position - a.position) * t;
+            instance.right = a.right + (b.right - a.right) * t;
+            instance.up = a.up + (b.up - a.up) * t;
+            instance.forward = forwards[ring] + (forwards[ring + 1] - forwards[ring]) * t;
+
+            if(placement.jitterRoll != 0.f)
+            {
+                const float angle = placement.jitterRoll * jitterRandom(placement.seed, k, 1);
+                const float c = std::cos(angle);
+                const float s = std::sin(angle);
+
+                const glm::vec3 right = instance.right;
+                instance.right = right * c + instance.up * s;
+                instance.up = instance.up * c - right * s;
+            }
+
+            if(placement.jitterOffset != glm::vec2(0.f))
+            {
+                instance.position += instance.right * (placement.jitterOffset.x * jitterRandom(placement.seed, k, 2))
+                                   + instance.up * (placement.jitterOffset.y * jitterRandom(placement.seed, k, 3));
+            }
+        }
+    });
+
+    return instances;
+}
+
+template<typename T>
+std::vector<InstanceTransform> placeInstancesWithCurve(const CurveSamplerT<T>& curve, unsigned int segmentCount, const InstancePlacement& placement, const glm::vec<3, T>& origin)
+{
+    auto samples = curve.sample(segmentCount);
+
+    if(samples.size() < 2)
+    {
+        printf("[ERROR][%s(%d)] Not enough points to plot a curve\n", __FILE__, __LINE__);
+        return std::vector<InstanceTransform>();
+    }
+
+    return placeInstances(computeExtrusionPoints(samples), placement, origin);
+}
+
+
+
+template std::vector<InstanceTransform> placeInstances(const std::vector<ExtrusionPointT<float>>&, const InstancePlacement&, const glm::vec<3, float>&);
+template std::vector<InstanceTransform> placeInstances(const std::vector<ExtrusionPointT<double>>&, const InstancePlacement&, const glm::vec<3, double>&);
+template std::vector<InstanceTransform> placeInstancesWithCurve(const CurveSamplerT<float>&, unsigned int, const InstancePlacement&, const glm::vec<3, float>&);
+template std::vector<InstanceTransform> placeInstancesWithCurve(const CurveSamplerT<double>&, unsigned int, const InstancePlacement&, const glm::vec<3, double>&);
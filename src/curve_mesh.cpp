@@ -1,191 +1,612 @@
 #include "curve_mesh.hpp"
 
+#include "profile_triangulation.hpp"
+
 #include <glm/gtx/rotate_vector.hpp>
 
-#include <algorithm> // std::for_each
-#include <cmath> // std::acos
+#include <algorithm> // std::max
+#include <cmath> // std::acos, std::copysign
 #include <cstdio>
 
 
 const glm::vec3 PROFILE_NORMAL = glm::vec3(0.f, 0.f, 1.f);
 
-CurveMeshData extrudeProfile(std::vector<glm::vec2> profile, const std::vector<ExtrusionPoint>& extrusionPoints)
+template<typename T>
+RingFrame computeRingFrame(const ExtrusionPointT<T>& ep, const glm::vec<3, T>& origin)
 {
-    CurveMeshData mesh{};
+    // only the position needs the full precision, the rest is relative to it anyway
+    glm::vec3 direction = glm::normalize(glm::vec3(ep.direction));
+    // the angle of rotation of the direction vector
+    float rotationAngle = std::acos(glm::dot(PROFILE_NORMAL, direction));
+    // the vector around which said direction vector is rotated
+    glm::vec3 rotationNormal;
+    // avoid calculating with NaN value
+    if(direction == PROFILE_NORMAL || direction == -PROFILE_NORMAL)
+    {
+        rotationNormal = {1.f, 0.f, 0.f};
+    }
+    else
+    {
+        rotationNormal = glm::cross(PROFILE_NORMAL, direction);
+    }
+
+    // profile vertices lie in the XY plane, so it's enough to transform the two axes;
+    // first by the angle the direction vector makes with base vector of the profile, then by the roll angle
+    glm::vec3 right = glm::rotate(glm::vec3(1.f, 0.f, 0.f), rotationAngle, rotationNormal);
+    right = glm::rotate(right, ep.roll, direction);
+    glm::vec3 up = glm::rotate(glm::vec3(0.f, 1.f, 0.f), rotationAngle, rotationNormal);
+    up = glm::rotate(up, ep.roll, direction);
+
+    // a ring squeezed into a point would leave the normals around it undefined
+    const float scale = std::abs(ep.scale) < MIN_RING_SCALE ? std::copysign(MIN_RING_SCALE, ep.scale) : ep.scale;
 
-    if(extrusionPoints.size() < 2)
+    return {glm::vec3(ep.position - origin), right * scale, up * scale};
+}
+
+template<typename T>
+std::vector<RingFrame> computeRingFrames(const std::vector<ExtrusionPointT<T>>& extrusionPoints, const glm::vec<3, T>& origin, const ExtrusionOptions& options)
+{
+    std::vector<RingFrame> frames(extrusionPoints.size());
+    for (size_t i = 0; i < extrusionPoints.size(); i++)
     {
-        printf("[ERROR][%s(%d)] Not enough points to construct a mesh", __FILE__, __LINE__);
-        return mesh;
+        if(i % CANCELLATION_CHECK_INTERVAL == 0 && isExtrusionCancelled(options))
+        {
+            return std::vector<RingFrame>();
+        }
+
+        frames[i] = computeRingFrame(extrusionPoints[i], origin);
     }
 
-    // so that indexing is easier and texture wrapping across a segment is possible
-    profile.push_back(profile[0]);
-    const int profileSize = profile.size();
+    return frames;
+}
 
+void appendCap(CurveMeshData& mesh, const std::vector<glm::vec2>& profile, const RingFrame& frame, bool facesBackwards, bool withUvs)
+{
+    const std::vector<unsigned int> triangles = triangulateProfile(profile);
+    const unsigned int firstVertex = mesh.vertices.size();
 
+    mesh.vertices.resize(firstVertex + profile.size());
+    transformProfileRing(makeProfileSoA(profile), frame, &mesh.vertices[firstVertex]);
 
-    // ============= VERTICES ============= //
-    // each vertex of the profile is being transformed for every extrusion point
-    // and added to the `vertices` vector
-    for(const auto& ep : extrusionPoints)
+    glm::vec3 normal = glm::normalize(glm::cross(frame.right, frame.up));
+    if(facesBackwards)
     {
-        glm::vec3 direction = glm::normalize(ep.direction);
-        // the angle of rotation of the direction vector
-        float rotationAngle = std::acos(glm::dot(PROFILE_NORMAL, direction));
-        // the vector around which said direction vector is rotated
-        glm::vec3 rotationNormal;
-        // avoid calculating with NaN value
-        if(direction == PROFILE_NORMAL || direction == -PROFILE_NORMAL)
+        normal = -normal;
+    }
+    mesh.normals.insert(mesh.normals.end(), profile.size(), normal);
+
+    // the profile is mapped onto the texture as is
+    if(withUvs)
+    {
+        mesh.uvs.insert(mesh.uvs.end(), profile.begin(), profile.end());
+    }
+
+    for (size_t i = 0; i < triangles.size(); i += 3)
+    {
+        // triangles are counter-clockwise when looking at the profile from the front,
+        // so the cap facing against the extrusion direction needs the opposite winding
+        mesh.indices.push_back(firstVertex + triangles[i]);
+        if(facesBackwards)
         {
-            rotationNormal = {1.f, 0.f, 0.f};
+            mesh.indices.push_back(firstVertex + triangles[i + 2]);
+            mesh.indices.push_back(firstVertex + triangles[i + 1]);
         }
         else
         {
-            rotationNormal = glm::cross(PROFILE_NORMAL, direction);
+            mesh.indices.push_back(firstVertex + triangles[i + 1]);
+            mesh.indices.push_back(firstVertex + triangles[i + 2]);
         }
-        
-        for (size_t j = 0; j < profileSize - 1; j++)
+    }
+}
+
+void appendTubeUvs(CurveMeshData& mesh, size_t ringCount, size_t ringSize)
+{
+    mesh.uvs.reserve(mesh.uvs.size() + ringCount * ringSize);
+    for (size_t i = 0; i < ringCount; i++)
+    {
+        for (size_t j = 0; j < ringSize; j++)
         {
-            // initialize the vertex with profile coords
-            glm::vec3 vert = {profile[j].x, profile[j].y, 0.f};
-            
-            // rotate the vertex by the angle the direction vector makes with base vector of the profile
-            vert = glm::rotate(vert, rotationAngle, rotationNormal);
-            // now rotate the vertex by the roll angle
-            vert = glm::rotate(vert, ep.roll, direction);
-            // move vertex to the position
-            vert += ep.position;
-            
-            mesh.vertices.push_back(vert);
+            mesh.uvs.push_back(glm::vec2(float(j) / float(ringSize - 1), float(i)));
         }
-        mesh.vertices.push_back( *(mesh.vertices.end() - (profileSize - 1)) ); // for that one repeated vertex
     }
+}
 
+// mixes the two profiles by the factor of `blend`
+static void blendProfiles(const ProfileSoA& from, const ProfileSoA& to, float blend, ProfileSoA& out)
+{
+    for (size_t j = 0; j < from.x.size(); j++)
+    {
+        out.x[j] = from.x[j] + (to.x[j] - from.x[j]) * blend;
+        out.y[j] = from.y[j] + (to.y[j] - from.y[j]) * blend;
+    }
+}
 
+static std::vector<glm::vec2> profileFromSoA(const ProfileSoA& soa)
+{
+    std::vector<glm::vec2> profile(soa.x.size());
+    for (size_t j = 0; j < profile.size(); j++)
+    {
+        profile[j] = glm::vec2(soa.x[j], soa.y[j]);
+    }
 
-    // ============= UVS ============= //
-    for (size_t i = 0; i < extrusionPoints.size(); i++)
+    return profile;
+}
+
+// distance of the furthest profile vertex from the origin
+static float profileRadius(const std::vector<glm::vec2>& profile)
+{
+    float radius = 0.f;
+    for(const auto& v : profile)
+    {
+        radius = std::max(radius, glm::length(v));
+    }
+
+    return radius;
+}
+
+// every ring lies within a disc of the profile's radius spanned by the frame's axes,
+// so a segment is bounded by the boxes of the discs at both of its ends
+void computeSegmentBounds(const std::vector<RingFrame>& frames, float radius, std::vector<BoundingBox>& bounds)
+{
+    auto ringBounds = [radius](const RingFrame& frame) -> BoundingBox {
+        glm::vec3 extent = radius * glm::sqrt(frame.right * frame.right + frame.up * frame.up);
+        return {frame.position - extent, frame.position + extent};
+    };
+
+    bounds.resize(frames.size() - 1);
+
+    BoundingBox prev = ringBounds(frames[0]);
+    for (size_t i = 0; i < bounds.size(); i++)
+    {
+        BoundingBox next = ringBounds(frames[i + 1]);
+
+        bounds[i] = prev;
+        expandBoundingBox(bounds[i], next);
+
+        prev = next;
+    }
+}
+
+// `targetSoA` and `blend` are optional - if given, the profile at every ring
+// is a mix between `profileSoA` and `targetSoA` weighted by the ring's element of `blend`
+// returns false if the extrusion gets cancelled, with the mesh left half done
+static bool appendBlendedTube(CurveMeshData& mesh, const ProfileSoA& profileSoA, const ProfileSoA *targetSoA, const float *blend, const std::vector<RingFrame>& frames, const ExtrusionOptions& options)
+{
+    // unless the mesh is seamless, the first vertex is repeated at the end of every ring
+    // so that texture wrapping across a segment is possible
+    const size_t seamSize = options.seamless ? 0 : 1;
+    const size_t uniqueSize = profileSoA.x.size();
+    const size_t profileSize = uniqueSize + seamSize;
+
+    // the tube goes after whatever the mesh holds already
+    const size_t firstVertex = mesh.vertices.size();
+
+    ProfileSoA blendedSoA;
+    if(targetSoA)
+    {
+        blendedSoA = profileSoA;
+    }
+
+    // profile used at a given ring
+    auto ringProfile = [&](size_t i) -> const ProfileSoA& {
+        if(!targetSoA)
+        {
+            return profileSoA;
+        }
+
+        blendProfiles(profileSoA, *targetSoA, blend[i], blendedSoA);
+        return blendedSoA;
+    };
+
+
+
+    // ============= VERTICES ============= //
+    // each vertex of the profile is being transformed for every extrusion point
+    // and written to its ring in the `vertices` vector
+    mesh.vertices.resize(firstVertex + frames.size() * profileSize);
+    for (size_t i = 0; i < frames.size(); i++)
     {
-        // a texture will be wrapped around a single segment and will repeat with every segment
-        for (size_t j = 0; j < profileSize; j++)
+        if(i % CANCELLATION_CHECK_INTERVAL == 0 && isExtrusionCancelled(options))
+        {
+            return false;
+        }
+
+        glm::vec3 *ring = &mesh.vertices[firstVertex + i * profileSize];
+
+        transformProfileRing(ringProfile(i), frames[i], ring);
+        if(seamSize > 0)
         {
-            mesh.uvs.push_back(glm::vec2(
-                float(j) / float(profileSize - 1),
-                float(i)
-            ));
+            ring[profileSize - 1] = ring[0]; // for that one repeated vertex
         }
     }
 
 
 
+    // ============= UVS ============= //
+    if(!options.seamless)
+    {
+        appendTubeUvs(mesh, frames.size(), profileSize);
+    }
+
+
+
     // ============= NORMALS ============= //
-    // calculate normal based on the faces of the next curve mesh segment
-    auto calcNormalAfter = [&](int i, int j) -> glm::vec3 {
-        glm::vec3 vThis = mesh.vertices[i * profileSize + j];
+    mesh.normals.resize(firstVertex + frames.size() * profileSize);
+    for (size_t i = 0; i < frames.size(); i++)
+    {
+        if(i % CANCELLATION_CHECK_INTERVAL == 0 && isExtrusionCancelled(options))
+        {
+            return false;
+        }
+
+        const glm::vec3 *ring = &mesh.vertices[firstVertex + i * profileSize];
+        const glm::vec3 *prevRing = i > 0 ? ring - profileSize : nullptr;
+        const glm::vec3 *nextRing = i + 1 < frames.size() ? ring + profileSize : nullptr;
+        glm::vec3 *normals = &mesh.normals[firstVertex + i * profileSize];
 
-        glm::vec3 vRight = mesh.vertices[i * profileSize + j + 1];
-        
-        glm::vec3 vUp = mesh.vertices[(i + 1) * profileSize + j];
-        
-        glm::vec3 vLeft;
-        if(j > 0) {
-            vLeft = mesh.vertices[i * profileSize + j - 1];
-        } else {
-            vLeft = mesh.vertices[(i + 1) * profileSize - 2];
+        // neighbours along the ring wrap around the unique vertices, so the seam vertex never has to be looked up
+        for (size_t j = 0; j < uniqueSize; j++)
+        {
+            const size_t left = (j + uniqueSize - 1) % uniqueSize;
+            const size_t right = (j + 1) % uniqueSize;
+            normals[j] = computeTubeNormal(ring[j], ring[left], ring[right], prevRing ? &prevRing[j] : nullptr, nextRing ? &nextRing[j] : nullptr);
+        }
+        // the repeated vertex shares the normal of the first one
+        if(seamSize > 0)
+        {
+            normals[profileSize - 1] = normals[0];
         }
+    }
 
-        glm::vec3 n1 = glm::cross(vRight - vThis, vUp - vThis);
-        glm::vec3 n2 = glm::cross(vUp - vThis, vLeft - vThis);
 
-        return glm::normalize(n1 + n2);
-    };
+    // ============= INDICES ============= //
+    for (size_t i = 0; i < frames.size() - 1; i++)
+    {
+        if(i % CANCELLATION_CHECK_INTERVAL == 0 && isExtrusionCancelled(options))
+        {
+            return false;
+        }
+
+        const size_t ring = firstVertex + i * profileSize;
+        const size_t nextRing = ring + profileSize;
+        for (size_t j = 0; j < uniqueSize; j++)
+        {
+            // without the seam the last quad of the ring closes back onto the first vertex
+            const size_t jNext = seamSize > 0 ? j + 1 : (j + 1) % uniqueSize;
 
-    // calculate normal based on the faces of the previous curve mesh segment
-    auto calcNormalBefore = [&](int i, int j) -> glm::vec3 {
-        glm::vec3 vThis = mesh.vertices[i * profileSize + j];
+            mesh.indices.push_back(ring + j);
+            mesh.indices.push_back(ring + jNext);
+            mesh.indices.push_back(nextRing + jNext);
 
-        glm::vec3 vLeft;
-        if(j > 0) {
-            vLeft = mesh.vertices[i * profileSize + j - 1];
-        } else {
-            vLeft = mesh.vertices[(i + 1) * profileSize - 2];
+            mesh.indices.push_back(ring + j);
+            mesh.indices.push_back(nextRing + jNext);
+            mesh.indices.push_back(nextRing + j);
         }
+    }
+
+    return true;
+}
+
+bool appendTube(CurveMeshData& mesh, const std::vector<glm::vec2>& profile, const std::vector<RingFrame>& frames, const ExtrusionOptions& options)
+{
+    if(frames.size() < 2)
+    {
+        printf("[ERROR][%s(%d)] Not enough frames to construct a tube\n", __FILE__, __LINE__);
+        return false;
+    }
+
+    return appendBlendedTube(mesh, makeProfileSoA(profile), nullptr, nullptr, frames, options);
+}
+
+static CurveMeshData extrudeBlendedProfile(const std::vector<glm::vec2>& profile, const std::vector<glm::vec2> *targetProfile, const float *blend, const std::vector<RingFrame>& frames, const ExtrusionOptions& options)
+{
+    CurveMeshData mesh{};
+
+    // the frames may be missing because of it
+    if(isExtrusionCancelled(options))
+    {
+        return mesh;
+    }
+
+    if(frames.size() < 2)
+    {
+        printf("[ERROR][%s(%d)] Not enough points to construct a mesh", __FILE__, __LINE__);
+        return mesh;
+    }
 
-        glm::vec3 vDown = mesh.vertices[(i - 1) * profileSize + j];
+    const ProfileSoA profileSoA = makeProfileSoA(profile);
+    ProfileSoA targetSoA;
+    if(targetProfile)
+    {
+        targetSoA = makeProfileSoA(*targetProfile);
+    }
 
-        glm::vec3 vRight = mesh.vertices[i * profileSize + j + 1];
+    mesh.ringSize = profile.size() + (options.seamless ? 0 : 1);
+    mesh.segmentIndexCount = profile.size() * 6;
+    if(!appendBlendedTube(mesh, profileSoA, targetProfile ? &targetSoA : nullptr, blend, frames, options) || isExtrusionCancelled(options))
+    {
+        return CurveMeshData{};
+    }
 
-        glm::vec3 n1 = glm::cross(vLeft - vThis, vDown - vThis);
-        glm::vec3 n2 = glm::cross(vDown - vThis, vRight - vThis);
+    // profile used at a given ring
+    auto ringProfile = [&](size_t i) -> std::vector<glm::vec2> {
+        if(!targetProfile)
+        {
+            return profile;
+        }
 
-        return glm::normalize(n1 + n2);
+        ProfileSoA blendedSoA = profileSoA;
+        blendProfiles(profileSoA, targetSoA, blend[i], blendedSoA);
+        return profileFromSoA(blendedSoA);
     };
 
+    // ============= CAPS ============= //
+    if(options.startCap)
+    {
+        appendCap(mesh, ringProfile(0), frames.front(), true, !options.seamless);
+    }
+    if(options.endCap)
+    {
+        appendCap(mesh, ringProfile(frames.size() - 1), frames.back(), false, !options.seamless);
+    }
 
-    for (size_t j = 0; j < profile.size(); j++)
+
+
+    // ============= BOUNDS ============= //
+    if(options.computeSegmentBounds)
+    {
+        // a blend of two profiles never reaches further than the bigger of them
+        float radius = profileRadius(profile);
+        if(targetProfile)
+        {
+            radius = std::max(radius, profileRadius(*targetProfile));
+        }
+
+        computeSegmentBounds(frames, radius, mesh.segmentBounds);
+    }
+
+
+
+    return mesh;
+}
+
+template<typename T>
+CurveMeshData extrudeProfile(std::vector<glm::vec2> profile, const std::vector<ExtrusionPointT<T>>& extrusionPoints, const ExtrusionOptions& options, const glm::vec<3, T>& origin)
+{
+    return extrudeBlendedProfile(profile, nullptr, nullptr, computeRingFrames(extrusionPoints, origin, options), options);
+}
+
+template<typename T>
+CurveMeshData extrudeMorphedProfile(const std::vector<glm::vec2>& profileFrom, const std::vector<glm::vec2>& profileTo, const std::vector<ExtrusionPointT<T>>& extrusionPoints, const std::vector<float>& blend, const ExtrusionOptions& options, const glm::vec<3, T>& origin)
+{
+    if(profileFrom.size() != profileTo.size())
+    {
+        printf("[ERROR][%s(%d)] Profiles to morph between must have the same number of vertices", __FILE__, __LINE__);
+        return CurveMeshData{};
+    }
+    if(blend.size() != extrusionPoints.size())
     {
-        mesh.normals.push_back(calcNormalAfter(0, j));
+        printf("[ERROR][%s(%d)] There must be a blend factor for every extrusion point", __FILE__, __LINE__);
+        return CurveMeshData{};
     }
-    mesh.normals.push_back( *(mesh.normals.end() - (profileSize - 1)) ); // for that one repeated vertex
 
-    for (size_t i = 1; i < extrusionPoints.size() - 1; i++)
+    return extrudeBlendedProfile(profileFrom, &profileTo, blend.data(), computeRingFrames(extrusionPoints, origin, options), options);
+}
+
+// removes the first and/or the last ring of a mesh without caps together with the segments they belong to
+static void dropEndRings(CurveMeshData& mesh, bool dropFirst, bool dropLast)
+{
+    const unsigned int ringSize = mesh.ringSize;
+    const unsigned int segmentIndexCount = mesh.segmentIndexCount;
+
+    if(dropLast)
     {
-        for (size_t j = 0; j < profile.size() - 1; j++)
+        mesh.vertices.resize(mesh.vertices.size() - ringSize);
+        mesh.normals.resize(mesh.normals.size() - ringSize);
+        mesh.uvs.resize(mesh.uvs.size() - std::min<size_t>(mesh.uvs.size(), ringSize));
+        mesh.indices.resize(mesh.indices.size() - segmentIndexCount);
+        if(!mesh.segmentBounds.empty())
         {
-            glm::vec3 nBefore = calcNormalBefore(i, j);
-            glm::vec3 nAfter = calcNormalAfter(i, j);
-            mesh.normals.push_back(glm::normalize(nBefore + nAfter));
+            mesh.segmentBounds.pop_back();
         }
-        mesh.normals.push_back( *(mesh.normals.end() - (profileSize - 1)) );
     }
 
-    for (size_t j = 0; j < profile.size(); j++)
+    if(dropFirst)
+    {
+        mesh.vertices.erase(mesh.vertices.begin(), mesh.vertices.begin() + ringSize);
+        mesh.normals.erase(mesh.normals.begin(), mesh.normals.begin() + ringSize);
+        mesh.uvs.erase(mesh.uvs.begin(), mesh.uvs.begin() + std::min<size_t>(mesh.uvs.size(), ringSize));
+        mesh.indices.erase(mesh.indices.begin(), mesh.indices.begin() + segmentIndexCount);
+        for(unsigned int& index : mesh.indices)
+        {
+            index -= ringSize;
+        }
+        if(!mesh.segmentBounds.empty())
+        {
+            mesh.segmentBounds.erase(mesh.segmentBounds.begin());
+        }
+    }
+}
+
+template<typename T>
+std::vector<CurveMeshChunk> extrudeProfileChunked(const std::vector<glm::vec2>& profile, const std::vector<ExtrusionPointT<T>>& extrusionPoints, unsigned int segmentsPerChunk, const ExtrusionOptions& options)
+{
+    std::vector<CurveMeshChunk> chunks;
+
+    if(extrusionPoints.size() < 2 || segmentsPerChunk == 0)
     {
-        mesh.normals.push_back(calcNormalBefore(extrusionPoints.size() - 1, j));
+        printf("[ERROR][%s(%d)] Not enough points to construct a mesh", __FILE__, __LINE__);
+        return chunks;
     }
-    mesh.normals.push_back( *(mesh.normals.end() - (profileSize - 1)) );
 
+    const size_t segmentCount = extrusionPoints.size() - 1;
+    chunks.resize((segmentCount + segmentsPerChunk - 1) / segmentsPerChunk);
 
-    // ============= INDICES ============= //
-    for (size_t i = 0; i < extrusionPoints.size() - 1; i++)
+    // caps are added separately to the first and last chunk
+    ExtrusionOptions tubeOptions = options;
+    tubeOptions.startCap = tubeOptions.endCap = false;
+
+    for (size_t c = 0; c < chunks.size(); c++)
     {
-        for (size_t j = 0; j < profileSize - 1; j++)
+        if(isExtrusionCancelled(options))
+        {
+            return std::vector<CurveMeshChunk>();
+        }
+
+        const size_t first = c * segmentsPerChunk;
+        const size_t last = std::min(first + segmentsPerChunk, segmentCount);
+
+        // the origin is put in the middle of the chunk, so that the vertices are as close to it as possible
+        const glm::vec<3, T> origin = extrusionPoints[(first + last) / 2].position;
+
+        // the rings next to the chunk are extruded as well, so that the normals at its boundaries
+        // are computed just like they would be for the whole mesh, then they're dropped
+        const size_t paddedFirst = first > 0 ? first - 1 : first;
+        const size_t paddedLast = last < segmentCount ? last + 1 : last;
+
+        std::vector<RingFrame> frames(paddedLast - paddedFirst + 1);
+        for (size_t i = 0; i < frames.size(); i++)
+        {
+            frames[i] = computeRingFrame(extrusionPoints[paddedFirst + i], origin);
+        }
+
+        CurveMeshData mesh = extrudeBlendedProfile(profile, nullptr, nullptr, frames, tubeOptions);
+        dropEndRings(mesh, paddedFirst < first, paddedLast > last);
+
+        // texture coordinates continue from the previous chunk
+        for(glm::vec2& uv : mesh.uvs)
         {
-            mesh.indices.push_back(i * profileSize + j);
-            mesh.indices.push_back(i * profileSize + (j + 1));
-            mesh.indices.push_back((i + 1) * profileSize + (j + 1));
+            uv.y += float(paddedFirst);
+        }
 
-            mesh.indices.push_back(i * profileSize + j);
-            mesh.indices.push_back((i + 1) * profileSize + (j + 1));
-            mesh.indices.push_back((i + 1) * profileSize + j);
+        if(c == 0 && options.startCap)
+        {
+            appendCap(mesh, profile, computeRingFrame(extrusionPoints[first], origin), true, !options.seamless);
+        }
+        if(c == chunks.size() - 1 && options.endCap)
+        {
+            appendCap(mesh, profile, computeRingFrame(extrusionPoints[last], origin), false, !options.seamless);
         }
+
+        chunks[c].origin = glm::dvec3(origin);
+        chunks[c].mesh = std::move(mesh);
     }
 
+    return chunks;
+}
 
+template<typename T>
+std::vector<ExtrusionPointT<T>> computeExtrusionPoints(const std::vector<glm::vec<3, T>>& curve)
+{
+    std::vector<ExtrusionPointT<T>> extrusionPoints;
+    extrusionPoints.reserve(curve.size());
 
-    return mesh;
+    extrusionPoints.push_back({curve[0], curve[1] - curve[0], 0.f});
+    for (size_t i = 1; i < curve.size() - 1; i++)
+    {
+        extrusionPoints.push_back({curve[i], curve[i + 1] - curve[i - 1], 0.f});
+    }
+    extrusionPoints.push_back({curve[curve.size() - 1], curve[curve.size() - 1] - curve[curve.size() - 2], 0.f});
+
+    return extrusionPoints;
+}
+
+template<typename T>
+std::vector<ExtrusionPointT<T>> computeExtrusionPoints(const std::vector<BezierCurveSampleT<T>>& samples)
+{
+    std::vector<ExtrusionPointT<T>> extrusionPoints(samples.size());
+
+    for (size_t i = 0; i < samples.size(); i++)
+    {
+        glm::vec<3, T> direction = samples[i].firstDerivative;
+        if(glm::dot(direction, direction) == T(0))
+        {
+            const size_t prev = i > 0 ? i - 1 : i;
+            const size_t next = i + 1 < samples.size() ? i + 1 : i;
+            direction = samples[next].position - samples[prev].position;
+        }
+
+        extrusionPoints[i] = {samples[i].position, direction, 0.f};
+    }
+
+    return extrusionPoints;
 }
 
 // All elements besides the first and last in curvePoints are treated as control points
-CurveMeshData extrudeProfileWithCurve(const std::vector<glm::vec2>& profile, const std::vector<BezierCurvePoint>& curvePoints, unsigned int segmentCount)
+template<typename T>
+CurveMeshData extrudeProfileWithCurve(const std::vector<glm::vec2>& profile, const std::vector<BezierCurvePointT<T>>& curvePoints, unsigned int segmentCount, const ExtrusionOptions& options, const glm::vec<3, T>& origin)
+{
+    return extrudeProfileWithCurve(profile, BezierCurveSamplerT<T>(curvePoints), segmentCount, options, origin);
+}
+
+template<typename T>
+CurveMeshData extrudeProfileWithCurve(const std::vector<glm::vec2>& profile, const CurveSamplerT<T>& curve, unsigned int segmentCount, const ExtrusionOptions& options, const glm::vec<3, T>& origin)
 {
-    auto curve = plotBezierCurve(curvePoints, segmentCount);
+    auto samples = curve.sample(segmentCount);
+
+    if(samples.size() < 2)
+    {
+        printf("[ERROR][%s(%d)] Not enough points to plot a curve", __FILE__, __LINE__);
+        return CurveMeshData{};
+    }
+    if(isExtrusionCancelled(options))
+    {
+        return CurveMeshData{};
+    }
+
+    return extrudeProfile(profile, computeExtrusionPoints(samples), options, origin);
+}
+
+template<typename T>
+CurveMeshData extrudeMorphedProfileWithCurve(const std::vector<glm::vec2>& profileFrom, const std::vector<glm::vec2>& profileTo, const std::vector<BezierCurvePointT<T>>& curvePoints, unsigned int segmentCount, const SweepTracks& tracks, const ExtrusionOptions& options, const glm::vec<3, T>& origin)
+{
+    auto curve = sampleBezierCurve(curvePoints, segmentCount);
 
     if(curve.size() < 2)
     {
         printf("[ERROR][%s(%d)] Not enough points to plot a curve", __FILE__, __LINE__);
         return CurveMeshData{};
     }
+    if(isExtrusionCancelled(options))
+    {
+        return CurveMeshData{};
+    }
 
-    std::vector<ExtrusionPoint> extrusionPoints(curve.size());
+    std::vector<ExtrusionPointT<T>> extrusionPoints = computeExtrusionPoints(curve);
 
-    extrusionPoints.push_back({curve[0], curve[1] - curve[0], 0.f});
-    for (size_t i = 1; i < curve.size() - 1; i++)
+    // all tracks are sampled at once for every ring
+    std::vector<float> scale(curve.size()), roll(curve.size()), blend(curve.size());
+    evaluateTrack(tracks.scale, 1.f, curve.size(), scale.data());
+    evaluateTrack(tracks.roll, 0.f, curve.size(), roll.data());
+    evaluateTrack(tracks.blend, 0.f, curve.size(), blend.data());
+
+    for (size_t i = 0; i < extrusionPoints.size(); i++)
     {
-        extrusionPoints.push_back({curve[i], curve[i + 1] - curve[i - 1], 0.f});
+        extrusionPoints[i].roll = roll[i];
+        extrusionPoints[i].scale = scale[i];
     }
-    extrusionPoints.push_back({curve[curve.size() - 1], curve[curve.size() - 1] - curve[curve.size() - 2], 0.f});
 
-    return extrudeProfile(profile, extrusionPoints);
-}
\ No newline at end of file
+    if(profileTo.empty())
+    {
+        return extrudeProfile(profileFrom, extrusionPoints, options, origin);
+    }
+
+    return extrudeMorphedProfile(profileFrom, profileTo, extrusionPoints, blend, options, origin);
+}
+
+
+
+#define INSTANTIATE_EXTRUDERS(T) \
+    template RingFrame computeRingFrame(const ExtrusionPointT<T>&, const glm::vec<3, T>&); \
+    template std::vector<RingFrame> computeRingFrames(const std::vector<ExtrusionPointT<T>>&, const glm::vec<3, T>&, const ExtrusionOptions&); \
+    template std::vector<ExtrusionPointT<T>> computeExtrusionPoints(const std::vector<glm::vec<3, T>>&); \
+    template std::vector<ExtrusionPointT<T>> computeExtrusionPoints(const std::vector<BezierCurveSampleT<T>>&); \
+    template CurveMeshData extrudeProfile(std::vector<glm::vec2>, const std::vector<ExtrusionPointT<T>>&, const ExtrusionOptions&, const glm::vec<3, T>&); \
+    template CurveMeshData extrudeProfileWithCurve(const std::vector<glm::vec2>&, const std::vector<BezierCurvePointT<T>>&, unsigned int, const ExtrusionOptions&, const glm::vec<3, T>&); \
+    template CurveMeshData extrudeProfileWithCurve(const std::vector<glm::vec2>&, const CurveSamplerT<T>&, unsigned int, const ExtrusionOptions&, const glm::vec<3, T>&); \
+    template CurveMeshData extrudeMorphedProfile(const std::vector<glm::vec2>&, const std::vector<glm::vec2>&, const std::vector<ExtrusionPointT<T>>&, const std::vector<float>&, const ExtrusionOptions&, const glm::vec<3, T>&); \
+    template CurveMeshData extrudeMorphedProfileWithCurve(const std::vector<glm::vec2>&, const std::vector<glm::vec2>&, const std::vector<BezierCurvePointT<T>>&, unsigned int, const SweepTracks&, const ExtrusionOptions&, const glm::vec<3, T>&); \
+    template std::vector<CurveMeshChunk> extrudeProfileChunked(const std::vector<glm::vec2>&, const std::vector<ExtrusionPointT<T>>&, unsigned int, const ExtrusionOptions&);
+
+INSTANTIATE_EXTRUDERS(float)
+INSTANTIATE_EXTRUDERS(double)
@@ -0,0 +1,191 @@
+#include "curve_mesh_view.hpp"
+
+#include <algorithm> // std::max, std::min
+#include <cstdio>
+
+
+CurveMeshView::CurveMeshView(const std::vector<glm::vec2>& profile, std::vector<RingFrame> frames, bool seamless)
+: m_profile(makeProfileSoA(profile)), m_frames(std::move(frames)), m_seamless(seamless),
+  m_uniqueSize(profile.size()), m_ringSize(profile.size() + (seamless ? 0 : 1))
+{
+    if(m_frames.size() < 2)
+    {
+        printf("[ERROR][%s(%d)] Not enough points to construct a mesh\n", __FILE__, __LINE__);
+        m_frames.clear();
+    }
+}
+
+glm::vec3 CurveMeshView::ringVertex(size_t i, size_t j) const
+{
+    glm::vec3 v;
+    transformProfileRing(&m_profile.x[j], &m_profile.y[j], 1, m_frames[i], &v);
+    return v;
+}
+
+glm::vec3 CurveMeshView::vertex(size_t i) const
+{
+    // the seam vertex repeats the first one
+    return ringVertex(i / m_ringSize, (i % m_ringSize) % m_uniqueSize);
+}
+
+glm::vec3 CurveMeshView::normal(size_t i) const
+{
+    const size_t ring = i / m_ringSize;
+    const size_t j = (i % m_ringSize) % m_uniqueSize;
+    const bool hasDown = ring > 0;
+    const bool hasUp = ring + 1 < m_frames.size();
+
+    const glm::vec3 down = hasDown ? ringVertex(ring - 1, j) : glm::vec3(0.f);
+    const glm::vec3 up = hasUp ? ringVertex(ring + 1, j) : glm::vec3(0.f);
+
+    return computeTubeNormal(ringVertex(ring, j), ringVertex(ring, (j + m_uniqueSize - 1) % m_uniqueSize), ringVertex(ring, (j + 1) % m_uniqueSize),
+                             hasDown ? &down : nullptr, hasUp ? &up : nullptr);
+}
+
+glm::vec2 CurveMeshView::uv(size_t i) const
+{
+    return glm::vec2(float(i % m_ringSize) / float(m_ringSize - 1), float(i / m_ringSize));
+}
+
+unsigned int CurveMeshView::index(size_t i) const
+{
+    const size_t segment = i / segmentIndexCount();
+    const size_t k = i % segmentIndexCount();
+    const size_t j = k / 6;
+    const size_t jNext = m_seamless ? (j + 1) % m_uniqueSize : j + 1;
+
+    // same two triangles per quad as the extruder makes
+    const size_t first = segment * m_ringSize;
+    const size_t next = first + m_ringSize;
+    switch(k % 6)
+    {
+        case 0: return first + j;
+        case 1: return first + jNext;
+        case 2: return next + jNext;
+        case 3: return first + j;
+        case 4: return next + jNext;
+        default: return next + j;
+    }
+}
+
+
+
+// ============= BLOCKS ============= //
+
+CurveMeshView::BlockIterator::BlockIterator(const CurveMeshView& view, size_t ringsPerBlock)
+: m_view(view), m_ringsPerBlock(std::max<size_t>(ringsPerBlock, 1)), m_nextRing(0)
+{
+}
+
+bool CurveMeshView::BlockIterator::next()
+{
+    const CurveMeshView& view = m_view;
+    const size_t ringCount = view.m_frames.size();
+    const size_t ringSize = view.m_ringSize;
+    const size_t uniqueSize = view.m_uniqueSize;
+
+    if(m_nextRing >= ringCount)
+    {
+        return false;
+    }
+
+    const size_t first = m_nextRing;
+    const size_t last = std::min(first + m_ringsPerBlock, ringCount);
+    const size_t paddedFirst = first > 0 ? first - 1 : 0;
+    const size_t paddedLast = std::min(last + 1, ringCount);
+    m_nextRing = last;
+
+    m_block.firstRing = first;
+    m_block.ringCount = last - first;
+
+    // ============= VERTICES ============= //
+    m_paddedVertices.resize((paddedLast - paddedFirst) * ringSize);
+    for (size_t i = paddedFirst; i < paddedLast; i++)
+    {
+        glm::vec3 *ring = &m_paddedVertices[(i - paddedFirst) * ringSize];
+
+        transformProfileRing(view.m_profile, view.m_frames[i], ring);
+        if(!view.m_seamless)
+        {
+            ring[ringSize - 1] = ring[0];
+        }
+    }
+
+    const glm::vec3 *blockVertices = &m_paddedVertices[(first - paddedFirst) * ringSize];
+    m_block.vertices.assign(blockVertices, blockVertices + m_block.ringCount * ringSize);
+
+    // ============= NORMALS ============= //
+    m_block.normals.resize(m_block.ringCount * ringSize);
+    for (size_t i = first; i < last; i++)
+    {
+        const glm::vec3 *ring = &m_paddedVertices[(i - paddedFirst) * ringSize];
+        const glm::vec3 *prevRing = i > 0 ? ring - ringSize : nullptr;
+        const glm::vec3 *nextRing = i + 1 < ringCount ? ring + ringSize : nullptr;
+        glm::vec3 *normals = &m_block.normals[(i - first) * ringSize];
+
+        for (size_t j = 0; j < uniqueSize; j++)
+        {
+            normals[j] = computeTubeNormal(ring[j], ring[(j + uniqueSize - 1) % uniqueSize], ring[(j + 1) % uniqueSize],
+                                           prevRing ? &prevRing[j] : nullptr, nextRing ? &nextRing[j] : nullptr);
+        }
+        if(!view.m_seamless)
+        {
+            normals[ringSize - 1] = normals[0];
+        }
+    }
+
+    // ============= UVS ============= //
+    m_block.uvs.clear();
+    if(!view.m_seamless)
+    {
+        m_block.uvs.resize(m_block.ringCount * ringSize);
+        for (size_t i = first; i < last; i++)
+        {
+            for (size_t j = 0; j < ringSize; j++)
+            {
+                m_block.uvs[(i - first) * ringSize + j] = glm::vec2(float(j) / float(ringSize - 1), float(i));
+            }
+        }
+    }
+
+    // ============= INDICES ============= //
+    const size_t lastSegment = std::min(last, ringCount - 1);
+    const size_t indexCount = view.segmentIndexCount();
+
+    m_block.indices.clear();
+    m_block.indices.reserve(lastSegment > first ? (lastSegment - first) * indexCount : 0);
+    for (size_t i = first; i < lastSegment; i++)
+    {
+        for (size_t j = 0; j < uniqueSize; j++)
+        {
+            const size_t jNext = view.m_seamless ? (j + 1) % uniqueSize : j + 1;
+
+            m_block.indices.push_back(i * ringSize + j);
+            m_block.indices.push_back(i * ringSize + jNext);
+            m_block.indices.push_back((i + 1) * ringSize + jNext);
+
+            m_block.indices.push_back(i * ringSize + j);
+            m_block.indices.push_back((i + 1) * ringSize + jNext);
+            m_block.indices.push_back((i + 1) * ringSize + j);
+        }
+    }
+
+    return true;
+}
+
+
+
+template<typename T>
+CurveMeshView makeCurveMeshView(const std::vector<glm::vec2>& profile, const std::vector<ExtrusionPointT<T>>& extrusionPoints, bool seamless, const glm::vec<3, T>& origin)
+{
+    std::vector<RingFrame> frames(extrusionPoints.size());
+    for (size_t i = 0; i < extrusionPoints.size(); i++)
+    {
+        frames[i] = computeRingFrame(extrusionPoints[i], origin);
+    }
+
+    return CurveMeshView(profile, std::move(frames), seamless);
+}
+
+template CurveMeshView makeCurveMeshView(const std::vector<glm::vec2>&, const std::vector<ExtrusionPointT<float>>&, bool, const glm::vec<3, float>&);
+template CurveMeshView makeCurveMeshView(const std::vector<glm::vec2>&, const std::vector<ExtrusionPointT<double>>&, bool, const glm::vec<3, double>&);
@@ -0,0 +1,240 @@
+#include "curve_projection.hpp"
+
+#include "parallel_for.hpp"
+
+#include <cmath> // std::sqrt
+#include <cstdio>
+#include <limits>
+
+
+const unsigned int MAX_TREE_DEPTH = 16;
+const unsigned int NEWTON_ITERATIONS = 8;
+const unsigned int NEWTON_MAX_STEP_HALVINGS = 8;
+// number of evenly spaced samples in a leaf, the best of which is used as a starting point for Newton's method
+const unsigned int LEAF_SEED_SAMPLES = 5;
+
+
+// splits homogeneous control points at t=0.5 with de Casteljau's algorithm
+static void splitInHalf(const glm::vec4 *points, unsigned int count, glm::vec4 *left, glm::vec4 *right)
+{
+    glm::vec4 work[64];
+    for (unsigned int i = 0; i < count; i++)
+    {
+        work[i] = points[i];
+    }
+
+    for (unsigned int level = 0; level < count; level++)
+    {
+        left[level] = work[0];
+        right[count - 1 - level] = work[count - 1 - level];
+
+        for (unsigned int i = 0; i + 1 < count - level; i++)
+        {
+            work[i] = (work[i] + work[i + 1]) * 0.5f;
+        }
+    }
+}
+
+static void buildNode(CurveProjectionTree& tree, unsigned int node, unsigned int leafBegin, const glm::vec4 *points, unsigned int depth)
+{
+    const unsigned int count = tree.degree + 1;
+
+    BoundingBox box;
+    for (unsigned int i = 0; i < count; i++)
+    {
+        expandBoundingBox(box, glm::vec3(points[i]) / points[i].w);
+    }
+    tree.nodes[node] = box;
+
+    if(depth == 0)
+    {
+        for (unsigned int i = 0; i < count; i++)
+        {
+            tree.leafPoints[leafBegin * count + i] = points[i];
+        }
+        return;
+    }
+
+    glm::vec4 left[64], right[64];
+    splitInHalf(points, count, left, right);
+
+    const unsigned int halfLeaves = 1u << (depth - 1);
+    buildNode(tree, node * 2, leafBegin, left, depth - 1);
+    buildNode(tree, node * 2 + 1, leafBegin + halfLeaves, right, depth - 1);
+}
+
+CurveProjectionTree buildCurveProjectionTree(const std::vector<BezierCurvePoint>& points, unsigned int depth)
+{
+    CurveProjectionTree tree;
+
+    if(points.size() < 2)
+    {
+        printf("[ERROR][%s(%d)] Not enough points to construct a curve", __FILE__, __LINE__);
+        return tree;
+    }
+    if(points.size() > 64)
+    {
+        printf("[ERROR][%s(%d)] Curves of degree higher than 63 are not supported", __FILE__, __LINE__);
+        return tree;
+    }
+
+    if(depth > MAX_TREE_DEPTH)
+    {
+        depth = MAX_TREE_DEPTH;
+    }
+
+    tree.degree = points.size() - 1;
+    tree.nodes.resize(2u << depth);
+    tree.leafPoints.resize((1u << depth) * points.size());
+
+    std::vector<glm::vec4> homogeneous(points.size());
+    for (size_t i = 0; i < points.size(); i++)
+    {
+        homogeneous[i] = glm::vec4(points[i].position * points[i].ratio, points[i].ratio);
+    }
+
+    buildNode(tree, 1, 0, homogeneous.data(), depth);
+
+    return tree;
+}
+
+
+
+static float distanceSquaredToBox(const BoundingBox& box, glm::vec3 point)
+{
+    glm::vec3 d = glm::max(glm::max(box.min - point, point - box.max), glm::vec3(0.f));
+    return glm::dot(d, d);
+}
+
+// finds the closest point on a single leaf piece, returns squared distance
+static float projectOntoLeaf(const CurveProjectionTree& tree, unsigned int leaf, glm::vec3 point, float& s, glm::vec3& position)
+{
+    const glm::vec4 *points = &tree.leafPoints[leaf * (tree.degree + 1)];
+
+    float bestS = 0.f;
+    float bestDist = std::numeric_limits<float>::max();
+    for (unsigned int k = 0; k < LEAF_SEED_SAMPLES; k++)
+    {
+        float sample = float(k) / float(LEAF_SEED_SAMPLES - 1);
+        glm::vec3 diff = evaluateBezierCurve(points, tree.degree, sample).position - point;
+        float dist = glm::dot(diff, diff);
+        if(dist < bestDist)
+        {
+            bestDist = dist;
+            bestS = sample;
+        }
+    }
+
+    // Newton's method on the derivative of the squared distance
+    float current = bestS;
+    for (unsigned int k = 0; k < NEWTON_ITERATIONS; k++)
+    {
+        BezierCurveSample e = evaluateBezierCurve(points, tree.degree, current);
+        glm::vec3 diff = e.position - point;
+
+        float f = glm::dot(diff, e.firstDerivative);
+        float df = glm::dot(e.firstDerivative, e.firstDerivative) + glm::dot(diff, e.secondDerivative);
+        if(df <= 0.f)
+        {
+            break;
+        }
+
+        // halve the step until it actually gets closer
+        float step = f / df;
+        bool improved = false;
+        for (unsigned int h = 0; h < NEWTON_MAX_STEP_HALVINGS && !improved; h++, step *= 0.5f)
+        {
+            float next = glm::clamp(current - step, 0.f, 1.f);
+            glm::vec3 nextDiff = evaluateBezierCurve(points, tree.degree, next).position - point;
+            float nextDist = glm::dot(nextDiff, nextDiff);
+            if(nextDist < bestDist)
+            {
+                bestDist = nextDist;
+                bestS = current = next;
+                improved = true;
+            }
+        }
+
+        if(!improved)
+        {
+            break;
+        }
+    }
+
+    s = bestS;
+    position = evaluateBezierCurve(points, tree.degree, bestS).position;
+    return bestDist;
+}
+
+CurveProjection projectPointOntoCurve(const CurveProjectionTree& tree, glm::vec3 point)
+{
+    CurveProjection result{glm::vec3(0.f), 0.f, std::numeric_limits<float>::max()};
+
+    if(tree.nodes.empty())
+    {
+        return result;
+    }
+
+    const unsigned int leafCount = tree.nodes.size() / 2;
+    float bestDist = std::numeric_limits<float>::max();
+
+    unsigned int stack[2 * MAX_TREE_DEPTH + 2];
+    size_t stackSize = 0;
+    stack[stackSize++] = 1;
+
+    while(stackSize > 0)
+    {
+        const unsigned int node = stack[--stackSize];
+
+        if(distanceSquaredToBox(tree.nodes[node], point) >= bestDist)
+        {
+            continue;
+        }
+
+        if(node >= leafCount)
+        {
+            const unsigned int leaf = node - leafCount;
+
+            float s;
+            glm::vec3 position;
+            float dist = projectOntoLeaf(tree, leaf, point, s, position);
+            if(dist < bestDist)
+            {
+                bestDist = dist;
+                result.position = position;
+                result.t = (float(leaf) + s) / float(leafCount);
+            }
+            continue;
+        }
+
+        // visit the closer child first, so that the further one is more likely to get pruned
+        const unsigned int left = node * 2, right = node * 2 + 1;
+        if(distanceSquaredToBox(tree.nodes[left], point) < distanceSquaredToBox(tree.nodes[right], point))
+        {
+            stack[stackSize++] = right;
+            stack[stackSize++] = left;
+        }
+        else
+        {
+            stack[stackSize++] = left;
+            stack[stackSize++] = right;
+        }
+    }
+
+    result.distance = std::sqrt(bestDist);
+    return result;
+}
+
+std::vector<CurveProjection> projectPointsOntoCurve(const CurveProjectionTree& tree, const std::vector<glm::vec3>& points)
+{
+    std::vector<CurveProjection> results(points.size());
+
+    parallelFor(points.size(), 256, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+        {
+            results[i] = projectPointOntoCurve(tree, points[i]);
+        }
+    });
+
+    return results;
+}
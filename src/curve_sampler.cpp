@@ -0,0 +1,347 @@
+#include "curve_sampler.hpp"
+
+#include <algorithm> // std::fill, std::min, std::swap
+#include <cmath> // std::pow
+#include <cstdio>
+
+
+// ============= BEZIER ============= //
+
+template<typename T>
+BezierCurveSamplerT<T>::BezierCurveSamplerT(const std::vector<BezierCurvePointT<T>>& points)
+: m_points(points)
+{
+}
+
+template<typename T>
+std::vector<BezierCurveSampleT<T>> BezierCurveSamplerT<T>::sample(unsigned int segmentCount) const
+{
+    return sampleBezierCurve(m_points, segmentCount);
+}
+
+
+
+// ============= PIECEWISE CUBIC ============= //
+
+template<typename T>
+std::vector<BezierCurveSampleT<T>> PiecewiseCubicSamplerT<T>::sample(unsigned int segmentCount) const
+{
+    std::vector<BezierCurveSampleT<T>> result;
+
+    if(m_spans.empty())
+    {
+        return result;
+    }
+
+    if(segmentCount == 0)
+    {
+        segmentCount = 1;
+    }
+
+    const size_t lastSpan = m_spans.size() - 1;
+
+    result.resize(segmentCount + 1);
+    for (size_t i = 0; i <= segmentCount; i++)
+    {
+        const T u = T(m_spans.size()) * T(i) / T(segmentCount);
+        const size_t span = std::min(size_t(u), lastSpan);
+        const T t = u - T(span);
+
+        const glm::vec<3, T>& a = m_spans[span][0];
+        const glm::vec<3, T>& b = m_spans[span][1];
+        const glm::vec<3, T>& c = m_spans[span][2];
+        const glm::vec<3, T>& d = m_spans[span][3];
+
+        BezierCurveSampleT<T>& s = result[i];
+        s.position = ((a * t + b) * t + c) * t + d;
+        s.firstDerivative = (a * (T(3) * t) + b * T(2)) * t + c;
+        s.secondDerivative = a * (T(6) * t) + b * T(2);
+
+        const T speed = glm::length(s.firstDerivative);
+        s.curvature = speed > T(0) ? glm::length(glm::cross(s.firstDerivative, s.secondDerivative)) / (speed * speed * speed) : T(0);
+    }
+
+    return result;
+}
+
+template<typename T>
+CatmullRomSamplerT<T>::CatmullRomSamplerT(const std::vector<glm::vec<3, T>>& points, T alpha)
+{
+    if(points.size() < 2)
+    {
+        printf("[ERROR][%s(%d)] Catmull-Rom spline needs at least 2 points\n", __FILE__, __LINE__);
+        return;
+    }
+
+    // parameter distance between two neighbouring points, coincident points fall back to uniform spacing
+    auto knotInterval = [alpha](const glm::vec<3, T>& from, const glm::vec<3, T>& to) -> T {
+        T interval = std::pow(glm::length(to - from), alpha);
+        return interval > T(0) ? interval : T(1);
+    };
+
+    const size_t n = points.size();
+    this->m_spans.resize(n - 1);
+
+    for (size_t k = 0; k < n - 1; k++)
+    {
+        const glm::vec<3, T>& p1 = points[k];
+        const glm::vec<3, T>& p2 = points[k + 1];
+        const glm::vec<3, T> p0 = k > 0 ? points[k - 1] : p1 * T(2) - p2;
+        const glm::vec<3, T> p3 = k + 2 < n ? points[k + 2] : p2 * T(2) - p1;
+
+        const T t01 = knotInterval(p0, p1);
+        const T t12 = knotInterval(p1, p2);
+        const T t23 = knotInterval(p2, p3);
+
+        // tangents at both ends of the span, scaled to the unit interval the span is evaluated over
+        const glm::vec<3, T> m1 = p2 - p1 + ((p1 - p0) / t01 - (p2 - p0) / (t01 + t12)) * t12;
+        const glm::vec<3, T> m2 = p2 - p1 + ((p3 - p2) / t23 - (p3 - p1) / (t12 + t23)) * t12;
+
+        // cubic Hermite in the power basis
+        this->m_spans[k] = {
+            (p1 - p2) * T(2) + m1 + m2,
+            (p2 - p1) * T(3) - m1 * T(2) - m2,
+            m1,
+            p1
+        };
+    }
+}
+
+template<typename T>
+UniformBSplineSamplerT<T>::UniformBSplineSamplerT(const std::vector<glm::vec<3, T>>& controlPoints)
+{
+    if(controlPoints.size() < 4)
+    {
+        printf("[ERROR][%s(%d)] Uniform B-spline needs at least 4 control points\n", __FILE__, __LINE__);
+        return;
+    }
+
+    this->m_spans.resize(controlPoints.size() - 3);
+
+    for (size_t k = 0; k < this->m_spans.size(); k++)
+    {
+        const glm::vec<3, T>& p0 = controlPoints[k];
+        const glm::vec<3, T>& p1 = controlPoints[k + 1];
+        const glm::vec<3, T>& p2 = controlPoints[k + 2];
+        const glm::vec<3, T>& p3 = controlPoints[k + 3];
+
+        // basis matrix of the uniform cubic B-spline
+        this->m_spans[k] = {
+            (p3 - p0 + (p1 - p2) * T(3)) / T(6),
+            (p0 - p1 * T(2) + p2) / T(2),
+            (p2 - p0) / T(2),
+            (p0 + p1 * T(4) + p2) / T(6)
+        };
+    }
+}
+
+
+
+// ============= NURBS ============= //
+
+template<typename T>
+NurbsSamplerT<T>::NurbsSamplerT(const std::vector<BezierCurvePointT<T>>& controlPoints, unsigned int degree, const std::vector<T>& knots)
+: m_degree(degree)
+{
+    const size_t n = controlPoints.size();
+
+    if(degree == 0 || n <= degree)
+    {
+        printf("[ERROR][%s(%d)] NURBS of degree %u needs more than %u control points\n", __FILE__, __LINE__, degree, degree);
+        return;
+    }
+
+    if(knots.empty())
+    {
+        // clamped: degree + 1 repeated knots at both ends, evenly spaced ones in between
+        m_knots.resize(n + degree + 1);
+        for (size_t i = 0; i < m_knots.size(); i++)
+        {
+            if(i <= degree)
+            {
+                m_knots[i] = T(0);
+            }
+            else if(i >= n)
+            {
+                m_knots[i] = T(1);
+            }
+            else
+            {
+                m_knots[i] = T(i - degree) / T(n - degree);
+            }
+        }
+    }
+    else
+    {
+        if(knots.size() != n + degree + 1)
+        {
+            printf("[ERROR][%s(%d)] Expected %zu knots, got %zu\n", __FILE__, __LINE__, n + degree + 1, knots.size());
+            return;
+        }
+        for (size_t i = 1; i < knots.size(); i++)
+        {
+            if(knots[i] < knots[i - 1])
+            {
+                printf("[ERROR][%s(%d)] Knots must be non-decreasing\n", __FILE__, __LINE__);
+                return;
+            }
+        }
+        if(!(knots[degree] < knots[n]))
+        {
+            printf("[ERROR][%s(%d)] Curve has an empty parameter range\n", __FILE__, __LINE__);
+            return;
+        }
+
+        m_knots = knots;
+    }
+
+    m_points.resize(n);
+    for (size_t i = 0; i < n; i++)
+    {
+        m_points[i] = glm::vec<4, T>(controlPoints[i].position * controlPoints[i].ratio, controlPoints[i].ratio);
+    }
+}
+
+template<typename T>
+std::vector<BezierCurveSampleT<T>> NurbsSamplerT<T>::sample(unsigned int segmentCount) const
+{
+    std::vector<BezierCurveSampleT<T>> result;
+
+    if(m_points.empty())
+    {
+        return result;
+    }
+
+    if(segmentCount == 0)
+    {
+        segmentCount = 1;
+    }
+
+    const unsigned int p = m_degree;
+    const size_t n = m_points.size();
+    const T uStart = m_knots[p];
+    const T uEnd = m_knots[n];
+    // derivatives above the degree are zero
+    const unsigned int derivativeCount = std::min(p, 2u);
+
+    // scratch tables of the basis function algorithm (The NURBS Book, A2.3), reused for all samples
+    std::vector<T> left(p + 1), right(p + 1);
+    std::vector<T> ndu((p + 1) * (p + 1));
+    std::vector<T> coefficients(2 * (p + 1));
+    std::vector<T> derivatives(3 * (p + 1));
+    auto nduAt = [&](unsigned int row, unsigned int column) -> T& { return ndu[row * (p + 1) + column]; };
+    auto coefficientAt = [&](unsigned int row, unsigned int column) -> T& { return coefficients[row * (p + 1) + column]; };
+    auto derivativeAt = [&](unsigned int row, unsigned int column) -> T& { return derivatives[row * (p + 1) + column]; };
+
+    result.resize(segmentCount + 1);
+
+    size_t span = p;
+    for (size_t s = 0; s <= segmentCount; s++)
+    {
+        const T u = s == segmentCount ? uEnd : uStart + (uEnd - uStart) * T(s) / T(segmentCount);
+
+        // knot span cache, the parameter only ever grows
+        while(span < n - 1 && u >= m_knots[span + 1])
+        {
+            span++;
+        }
+
+        // basis functions of all degrees up to p, built up with the Cox-de Boor recursion
+        nduAt(0, 0) = T(1);
+        for (unsigned int j = 1; j <= p; j++)
+        {
+            left[j] = u - m_knots[span + 1 - j];
+            right[j] = m_knots[span + j] - u;
+
+            T saved = T(0);
+            for (unsigned int r = 0; r < j; r++)
+            {
+                nduAt(j, r) = right[r + 1] + left[j - r];
+                const T temp = nduAt(r, j - 1) / nduAt(j, r);
+                nduAt(r, j) = saved + right[r + 1] * temp;
+                saved = left[j - r] * temp;
+            }
+            nduAt(j, j) = saved;
+        }
+
+        std::fill(derivatives.begin(), derivatives.end(), T(0));
+        for (unsigned int j = 0; j <= p; j++)
+        {
+            derivativeAt(0, j) = nduAt(j, p);
+        }
+
+        // derivatives of the basis functions
+        for (unsigned int r = 0; r <= p; r++)
+        {
+            unsigned int s1 = 0, s2 = 1;
+            coefficientAt(0, 0) = T(1);
+
+            for (unsigned int k = 1; k <= derivativeCount; k++)
+            {
+                T d = T(0);
+                const int rk = int(r) - int(k);
+                const int pk = int(p) - int(k);
+
+                if(rk >= 0)
+                {
+                    coefficientAt(s2, 0) = coefficientAt(s1, 0) / nduAt(pk + 1, rk);
+                    d = coefficientAt(s2, 0) * nduAt(rk, pk);
+                }
+
+                const int j1 = rk >= -1 ? 1 : -rk;
+                const int j2 = int(r) - 1 <= pk ? int(k) - 1 : int(p) - int(r);
+                for (int j = j1; j <= j2; j++)
+                {
+                    coefficientAt(s2, j) = (coefficientAt(s1, j) - coefficientAt(s1, j - 1)) / nduAt(pk + 1, rk + j);
+                    d += coefficientAt(s2, j) * nduAt(rk + j, pk);
+                }
+
+                if(int(r) <= pk)
+                {
+                    coefficientAt(s2, k) = -coefficientAt(s1, k - 1) / nduAt(pk + 1, r);
+                    d += coefficientAt(s2, k) * nduAt(r, pk);
+                }
+
+                derivativeAt(k, r) = d;
+                std::swap(s1, s2);
+            }
+        }
+
+        T factor = T(p);
+        for (unsigned int k = 1; k <= derivativeCount; k++)
+        {
+            for (unsigned int j = 0; j <= p; j++)
+            {
+                derivativeAt(k, j) *= factor;
+            }
+            factor *= T(p - k);
+        }
+
+        // homogeneous point and its derivatives, then back to 3D
+        glm::vec<4, T> h(T(0)), dh(T(0)), ddh(T(0));
+        for (unsigned int j = 0; j <= p; j++)
+        {
+            const glm::vec<4, T>& point = m_points[span - p + j];
+            h += point * derivativeAt(0, j);
+            dh += point * derivativeAt(1, j);
+            ddh += point * derivativeAt(2, j);
+        }
+
+        result[s] = rationalCurveSample(h, dh, ddh);
+    }
+
+    return result;
+}
+
+
+
+template class BezierCurveSamplerT<float>;
+template class BezierCurveSamplerT<double>;
+template class PiecewiseCubicSamplerT<float>;
+template class PiecewiseCubicSamplerT<double>;
+template class CatmullRomSamplerT<float>;
+template class CatmullRomSamplerT<double>;
+template class UniformBSplineSamplerT<float>;
+template class UniformBSplineSamplerT<double>;
+template class NurbsSamplerT<float>;
+template class NurbsSamplerT<double>;
@@ -0,0 +1,465 @@
+#include "curve_store.hpp"
+
+#include "bezier_curve_points.hpp"
+
+#include <algorithm> // std::min, std::max
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+
+std::vector<BezierCurvePoint> PackedCurveView::unpack() const
+{
+    std::vector<BezierCurvePoint> points(m_count);
+    for (size_t i = 0; i < m_count; i++)
+    {
+        points[i] = (*this)[i];
+    }
+    return points;
+}
+
+std::vector<glm::vec3> plotBezierCurve(const PackedCurveView& curve, unsigned int segmentCount)
+{
+    return plotBezierCurvePoints<float>(curve, segmentCount);
+}
+
+std::vector<BezierCurveSample> sampleBezierCurve(const PackedCurveView& curve, unsigned int segmentCount)
+{
+    return sampleBezierCurvePoints<float>(curve, segmentCount);
+}
+
+
+
+// ============= STORE ============= //
+
+static const uint32_t MAX_QUANTIZED_POSITION = 65535;
+static const uint32_t MAX_QUANTIZED_RATIO = 255;
+
+static uint32_t quantize(float value, float min, float step, uint32_t maxValue)
+{
+    if(!(step > 0.0f))
+    {
+        return 0;
+    }
+
+    const float q = std::round((value - min) / step);
+    return q <= 0.0f ? 0 : q >= float(maxValue) ? maxValue : uint32_t(q);
+}
+
+static bool validOffsets(const uint32_t *offsets, size_t curveCount)
+{
+    if(offsets[0] != 0)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < curveCount; i++)
+    {
+        if(offsets[i + 1] < offsets[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+PackedCurveStore::PackedCurveStore()
+: m_offsets{0}
+{
+}
+
+size_t PackedCurveStore::add(const std::vector<BezierCurvePoint>& points)
+{
+    if(m_points.size() + points.size() > UINT32_MAX)
+    {
+        printf("[ERROR][%s(%d)] Too many points in one store\n", __FILE__, __LINE__);
+        return INVALID_CURVE;
+    }
+
+    glm::vec3 boxMin(0.0f), boxMax(0.0f);
+    float maxRatio = 0.0f;
+    if(!points.empty())
+    {
+        boxMin = boxMax = points[0].position;
+    }
+    for(const auto& point : points)
+    {
+        boxMin = glm::min(boxMin, point.position);
+        boxMax = glm::max(boxMax, point.position);
+        maxRatio = std::max(maxRatio, point.ratio);
+    }
+
+    PackedCurveBounds bounds;
+    for (int k = 0; k < 3; k++)
+    {
+        bounds.boxMin[k] = boxMin[k];
+        bounds.positionStep[k] = (boxMax[k] - boxMin[k]) / float(MAX_QUANTIZED_POSITION);
+    }
+    bounds.ratioStep = maxRatio / float(MAX_QUANTIZED_RATIO);
+
+    for(const auto& point : points)
+    {
+        PackedCurvePoint packed;
+        for (int k = 0; k < 3; k++)
+        {
+            packed.position[k] = quantize(point.position[k], bounds.boxMin[k], bounds.positionStep[k], MAX_QUANTIZED_POSITION);
+        }
+        // a positive ratio rounded down to 0 would leave the curve without weight around the point, e.g. NaN at the ends
+        packed.ratio = quantize(point.ratio, 0.0f, bounds.ratioStep, MAX_QUANTIZED_RATIO);
+        if(point.ratio > 0.0f && packed.ratio == 0)
+        {
+            packed.ratio = 1;
+        }
+        packed.reserved = 0;
+
+        m_points.push_back(packed);
+    }
+
+    m_bounds.push_back(bounds);
+    m_offsets.push_back(m_points.size());
+
+    return m_bounds.size() - 1;
+}
+
+void PackedCurveStore::reserve(size_t curveCount, size_t pointCount)
+{
+    m_bounds.reserve(curveCount);
+    m_offsets.reserve(curveCount + 1);
+    m_points.reserve(pointCount);
+}
+
+void PackedCurveStore::clear()
+{
+    m_bounds.clear();
+    m_offsets.assign(1, 0);
+    m_points.clear();
+}
+
+void PackedCurveStore::assign(const PackedCurveStoreView& view)
+{
+    m_bounds.assign(view.bounds, view.bounds + view.curveCount);
+    m_offsets.assign(view.offsets, view.offsets + view.curveCount + 1);
+    m_points.assign(view.points, view.points + view.offsets[view.curveCount]);
+}
+
+bool PackedCurveStore::assign(std::vector<PackedCurveBounds> bounds, std::vector<uint32_t> offsets, std::vector<PackedCurvePoint> points)
+{
+    if(offsets.size() != bounds.size() + 1 || !validOffsets(offsets.data(), bounds.size()) || offsets.back() != points.size())
+    {
+        return false;
+    }
+
+    m_bounds = std::move(bounds);
+    m_offsets = std::move(offsets);
+    m_points = std::move(points);
+    return true;
+}
+
+size_t PackedCurveStore::byteSize() const
+{
+    return m_bounds.size() * sizeof(PackedCurveBounds) + m_offsets.size() * sizeof(uint32_t) + m_points.size() * sizeof(PackedCurvePoint);
+}
+
+PackedCurveStoreView PackedCurveStore::view() const
+{
+    return PackedCurveStoreView{m_bounds.size(), m_bounds.data(), m_offsets.data(), m_points.data()};
+}
+
+
+
+// ============= FILES ============= //
+
+static const char STORE_MAGIC[4] = {'P', 'C', 'S', 'T'};
+static const uint32_t STORE_VERSION = 1;
+static const uint32_t STORE_FLAG_DELTA_CODED = 1;
+
+struct PackedCurveStoreHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t flags;
+    uint32_t pointCount;
+    uint64_t curveCount;
+    // size of the section after the bounds, which holds the offsets and points, or the delta-coded curves
+    uint64_t dataBytes;
+};
+
+static_assert(sizeof(PackedCurvePoint) == 8, "packed points must have no padding");
+static_assert(sizeof(PackedCurveBounds) == 28, "packed bounds must have no padding");
+static_assert(sizeof(PackedCurveStoreHeader) == 32, "store header must have no padding");
+
+static size_t alignTo8(size_t size)
+{
+    return (size + 7) & ~size_t(7);
+}
+
+// byte offsets of the sections of a store with the given number of curves, the offsets and points are only there if it's not delta-coded
+struct StoreLayout
+{
+    size_t bounds;
+    size_t offsets;
+    size_t points;
+
+    StoreLayout(size_t curveCount)
+    {
+        bounds = sizeof(PackedCurveStoreHeader);
+        offsets = bounds + alignTo8(curveCount * sizeof(PackedCurveBounds));
+        points = offsets + alignTo8((curveCount + 1) * sizeof(uint32_t));
+    }
+};
+
+// A delta-coded curve is its point count followed by the differences between the x, y, z and ratio of each point and the previous one.
+// The first position is relative to zero and the first ratio to the largest one, which every curve has.
+// Differences are zigzag-coded, so that small negative ones stay small, and everything is written 7 bits per byte.
+static void writeVarint(std::vector<uint8_t>& out, uint32_t value)
+{
+    while(value >= 0x80)
+    {
+        out.push_back(uint8_t(value) | 0x80);
+        value >>= 7;
+    }
+    out.push_back(uint8_t(value));
+}
+
+static bool readVarint(const uint8_t *&data, const uint8_t *end, uint32_t& value)
+{
+    value = 0;
+    for (int shift = 0; shift <= 28; shift += 7)
+    {
+        if(data == end)
+        {
+            return false;
+        }
+
+        const uint8_t byte = *data++;
+        value |= uint32_t(byte & 0x7f) << shift;
+        if(!(byte & 0x80))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void deltaEncodeCurve(std::vector<uint8_t>& out, const PackedCurvePoint *points, size_t count)
+{
+    writeVarint(out, count);
+
+    int32_t prev[4] = {0, 0, 0, MAX_QUANTIZED_RATIO};
+    for (size_t i = 0; i < count; i++)
+    {
+        const int32_t current[4] = {points[i].position[0], points[i].position[1], points[i].position[2], points[i].ratio};
+        for (int k = 0; k < 4; k++)
+        {
+            const int32_t delta = current[k] - prev[k];
+            writeVarint(out, (uint32_t(delta) << 1) ^ uint32_t(delta >> 31));
+            prev[k] = current[k];
+        }
+    }
+}
+
+// appends the decoded points, returns false if the data runs out or doesn't fit the quantized ranges
+static bool deltaDecodeCurve(const uint8_t *&data, const uint8_t *end, std::vector<PackedCurvePoint>& points)
+{
+    static const int32_t maxValue[4] = {MAX_QUANTIZED_POSITION, MAX_QUANTIZED_POSITION, MAX_QUANTIZED_POSITION, MAX_QUANTIZED_RATIO};
+
+    uint32_t count;
+    if(!readVarint(data, end, count) || count > size_t(end - data))
+    {
+        return false;
+    }
+
+    int32_t prev[4] = {0, 0, 0, MAX_QUANTIZED_RATIO};
+    for (size_t i = 0; i < count; i++)
+    {
+        for (int k = 0; k < 4; k++)
+        {
+            uint32_t zigzag;
+            if(!readVarint(data, end, zigzag))
+            {
+                return false;
+            }
+
+            const int32_t value = prev[k] + (int32_t(zigzag >> 1) ^ -int32_t(zigzag & 1));
+            if(value < 0 || value > maxValue[k])
+            {
+                return false;
+            }
+            prev[k] = value;
+        }
+
+        PackedCurvePoint point;
+        point.position[0] = prev[0];
+        point.position[1] = prev[1];
+        point.position[2] = prev[2];
+        point.ratio = prev[3];
+        point.reserved = 0;
+        points.push_back(point);
+    }
+
+    return true;
+}
+
+static bool writePadded(FILE *file, const void *data, size_t size)
+{
+    static const uint8_t zeros[8] = {};
+
+    const size_t padding = alignTo8(size) - size;
+    return (size == 0 || fwrite(data, 1, size, file) == size) && (padding == 0 || fwrite(zeros, 1, padding, file) == padding);
+}
+
+bool savePackedCurveStore(const PackedCurveStoreView& store, const char *path, bool deltaCoded)
+{
+    FILE *file = fopen(path, "wb");
+    if(!file)
+    {
+        return false;
+    }
+
+    const size_t pointCount = store.offsets[store.curveCount];
+    const StoreLayout layout(store.curveCount);
+
+    // delta-coded curves are encoded whole, to know their size for the header
+    std::vector<uint8_t> encoded;
+    if(deltaCoded)
+    {
+        encoded.reserve(pointCount * 4 + store.curveCount);
+        for (size_t i = 0; i < store.curveCount; i++)
+        {
+            deltaEncodeCurve(encoded, store.points + store.offsets[i], store.offsets[i + 1] - store.offsets[i]);
+        }
+    }
+
+    PackedCurveStoreHeader header;
+    memcpy(header.magic, STORE_MAGIC, sizeof(header.magic));
+    header.version = STORE_VERSION;
+    header.flags = deltaCoded ? STORE_FLAG_DELTA_CODED : 0;
+    header.pointCount = pointCount;
+    header.curveCount = store.curveCount;
+    header.dataBytes = deltaCoded ? encoded.size() : layout.points - layout.offsets + pointCount * sizeof(PackedCurvePoint);
+
+    bool ok = writePadded(file, &header, sizeof(header));
+    ok = ok && writePadded(file, store.bounds, store.curveCount * sizeof(PackedCurveBounds));
+    if(deltaCoded)
+    {
+        ok = ok && writePadded(file, encoded.data(), encoded.size());
+    }
+    else
+    {
+        ok = ok && writePadded(file, store.offsets, (store.curveCount + 1) * sizeof(uint32_t));
+        ok = ok && writePadded(file, store.points, pointCount * sizeof(PackedCurvePoint));
+    }
+
+    return fclose(file) == 0 && ok;
+}
+
+bool loadPackedCurveStore(PackedCurveStore& store, const char *path)
+{
+    FILE *file = fopen(path, "rb");
+    if(!file)
+    {
+        return false;
+    }
+
+    PackedCurveStoreHeader header;
+    if(fread(&header, sizeof(header), 1, file) != 1 || memcmp(header.magic, STORE_MAGIC, sizeof(header.magic)) != 0 || header.version != STORE_VERSION
+       || header.curveCount >= UINT32_MAX)
+    {
+        printf("[ERROR][%s(%d)] %s is not a curve store\n", __FILE__, __LINE__, path);
+        fclose(file);
+        return false;
+    }
+
+    // every section has to fit in the file before anything is sized by the header
+    const StoreLayout layout(header.curveCount);
+    const bool isDeltaCoded = header.flags & STORE_FLAG_DELTA_CODED;
+    long fileSize = -1;
+    if(fseek(file, 0, SEEK_END) == 0)
+    {
+        fileSize = ftell(file);
+    }
+    const uint64_t dataEnd = isDeltaCoded ? layout.offsets + header.dataBytes : layout.points + uint64_t(header.pointCount) * sizeof(PackedCurvePoint);
+    // each delta-coded point takes at least a byte per coordinate
+    const bool isSizeValid = fileSize >= 0 && header.dataBytes <= uint64_t(fileSize) && dataEnd <= uint64_t(fileSize)
+                             && (!isDeltaCoded || header.pointCount <= header.dataBytes / 4);
+    if(!isSizeValid || fseek(file, layout.bounds, SEEK_SET) != 0)
+    {
+        printf("[ERROR][%s(%d)] Curve store %s is damaged\n", __FILE__, __LINE__, path);
+        fclose(file);
+        return false;
+    }
+
+    std::vector<PackedCurveBounds> bounds(header.curveCount);
+    std::vector<uint32_t> offsets(header.curveCount + 1);
+    std::vector<PackedCurvePoint> points;
+
+    // sections are read straight into place, padding is skipped
+    bool ok = fread(bounds.data(), sizeof(PackedCurveBounds), bounds.size(), file) == bounds.size();
+    ok = ok && fseek(file, layout.offsets, SEEK_SET) == 0;
+
+    if(ok && isDeltaCoded)
+    {
+        std::vector<uint8_t> encoded(header.dataBytes);
+        ok = fread(encoded.data(), 1, encoded.size(), file) == encoded.size();
+
+        points.reserve(header.pointCount);
+        const uint8_t *data = encoded.data();
+        const uint8_t *end = data + encoded.size();
+        for (size_t i = 0; ok && i < header.curveCount; i++)
+        {
+            ok = deltaDecodeCurve(data, end, points) && points.size() <= header.pointCount;
+            offsets[i + 1] = points.size();
+        }
+    }
+    else if(ok)
+    {
+        points.resize(header.pointCount);
+        ok = fread(offsets.data(), sizeof(uint32_t), offsets.size(), file) == offsets.size();
+        ok = ok && fseek(file, layout.points, SEEK_SET) == 0 && fread(points.data(), sizeof(PackedCurvePoint), points.size(), file) == points.size();
+    }
+
+    fclose(file);
+
+    if(!ok || points.size() != header.pointCount || !store.assign(std::move(bounds), std::move(offsets), std::move(points)))
+    {
+        printf("[ERROR][%s(%d)] Curve store %s is damaged\n", __FILE__, __LINE__, path);
+        return false;
+    }
+
+    return true;
+}
+
+bool viewPackedCurveStoreImage(const void *data, size_t size, PackedCurveStoreView& view)
+{
+    const uint8_t *bytes = (const uint8_t *)data;
+
+    if(size < sizeof(PackedCurveStoreHeader) || (uintptr_t(data) & 7) != 0)
+    {
+        return false;
+    }
+
+    PackedCurveStoreHeader header;
+    memcpy(&header, bytes, sizeof(header));
+    if(memcmp(header.magic, STORE_MAGIC, sizeof(header.magic)) != 0 || header.version != STORE_VERSION || (header.flags & STORE_FLAG_DELTA_CODED)
+       || header.curveCount >= UINT32_MAX)
+    {
+        return false;
+    }
+
+    const StoreLayout layout(header.curveCount);
+    if(layout.points + uint64_t(header.pointCount) * sizeof(PackedCurvePoint) > size)
+    {
+        return false;
+    }
+
+    const uint32_t *offsets = (const uint32_t *)(bytes + layout.offsets);
+    if(!validOffsets(offsets, header.curveCount) || offsets[header.curveCount] != header.pointCount)
+    {
+        return false;
+    }
+
+    view.curveCount = header.curveCount;
+    view.bounds = (const PackedCurveBounds *)(bytes + layout.bounds);
+    view.offsets = offsets;
+    view.points = (const PackedCurvePoint *)(bytes + layout.points);
+    return true;
+}
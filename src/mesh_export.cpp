@@ -0,0 +1,441 @@
+#include "mesh_export.hpp"
+
+#include <algorithm> // std::min
+#include <cstdint>
+#include <cstdio>
+#include <cstring> // std::memcpy
+#include <string>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <limits.h> // IOV_MAX
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+
+// interleaved records (STL facets, PLY vertices and faces) are assembled in blocks of this size before being written
+const size_t EXPORT_BLOCK_SIZE = 4 << 20;
+
+const uint32_t GLB_MAGIC = 0x46546C67; // "glTF"
+const uint32_t GLB_CHUNK_JSON = 0x4E4F534A; // "JSON"
+const uint32_t GLB_CHUNK_BIN = 0x004E4942; // "BIN\0"
+
+// glTF enums
+const int GLTF_FLOAT = 5126;
+const int GLTF_UNSIGNED_INT = 5125;
+const int GLTF_ARRAY_BUFFER = 34962;
+const int GLTF_ELEMENT_ARRAY_BUFFER = 34963;
+
+
+struct WriteRange
+{
+    const void *data;
+    size_t size;
+};
+
+// Unbuffered output file, every write call hands the given ranges straight to the OS.
+// The data is written as is, so the exporters only work on little-endian machines.
+class OutputFile
+{
+private:
+#ifdef _WIN32
+    FILE *m_file;
+#else
+    int m_fd;
+#endif
+
+public:
+#ifdef _WIN32
+    OutputFile() : m_file(nullptr) {}
+    ~OutputFile() { if(m_file) fclose(m_file); }
+#else
+    OutputFile() : m_fd(-1) {}
+    ~OutputFile() { if(m_fd >= 0) ::close(m_fd); }
+#endif
+
+    bool open(const char *path)
+    {
+#ifdef _WIN32
+        m_file = fopen(path, "wb");
+        return m_file != nullptr;
+#else
+        m_fd = ::open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        return m_fd >= 0;
+#endif
+    }
+
+    bool write(const WriteRange *ranges, size_t count)
+    {
+#ifdef _WIN32
+        for (size_t i = 0; i < count; i++)
+        {
+            if(ranges[i].size > 0 && fwrite(ranges[i].data, 1, ranges[i].size, m_file) != ranges[i].size)
+            {
+                return false;
+            }
+        }
+        return true;
+#else
+        std::vector<iovec> iov;
+        iov.reserve(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            if(ranges[i].size > 0)
+            {
+                iov.push_back({ (void *)ranges[i].data, ranges[i].size });
+            }
+        }
+
+        size_t first = 0;
+        while(first < iov.size())
+        {
+            const int batch = (int)std::min<size_t>(iov.size() - first, IOV_MAX);
+            ssize_t written = ::writev(m_fd, &iov[first], batch);
+            if(written < 0)
+            {
+                return false;
+            }
+
+            // skip whatever was fully written and advance into a partially written range
+            while(first < iov.size() && (size_t)written >= iov[first].iov_len)
+            {
+                written -= iov[first].iov_len;
+                first++;
+            }
+            if(first < iov.size())
+            {
+                iov[first].iov_base = (char *)iov[first].iov_base + written;
+                iov[first].iov_len -= written;
+            }
+        }
+        return true;
+#endif
+    }
+
+    bool write(const void *data, size_t size)
+    {
+        WriteRange range = { data, size };
+        return write(&range, 1);
+    }
+};
+
+
+// collects fixed size records and writes them out whenever the block is full
+class BlockWriter
+{
+private:
+    OutputFile& m_file;
+    std::vector<unsigned char> m_block;
+    size_t m_used;
+    bool m_ok;
+
+public:
+    BlockWriter(OutputFile& file) : m_file(file), m_block(EXPORT_BLOCK_SIZE), m_used(0), m_ok(true) {}
+
+    // returns space for a record of `size` bytes
+    unsigned char *reserve(size_t size)
+    {
+        if(m_used + size > m_block.size())
+        {
+            flush();
+        }
+        unsigned char *record = m_block.data() + m_used;
+        m_used += size;
+        return record;
+    }
+
+    bool flush()
+    {
+        if(m_used > 0)
+        {
+            m_ok = m_ok && m_file.write(m_block.data(), m_used);
+            m_used = 0;
+        }
+        return m_ok;
+    }
+};
+
+
+static bool hasNormals(const CurveMeshData& mesh)
+{
+    return !mesh.vertices.empty() && mesh.normals.size() == mesh.vertices.size();
+}
+
+static bool hasUvs(const CurveMeshData& mesh)
+{
+    return !mesh.vertices.empty() && mesh.uvs.size() == mesh.vertices.size();
+}
+
+static bool openForExport(OutputFile& file, const CurveMeshData& mesh, const char *path)
+{
+    if(mesh.vertices.empty() || mesh.indices.size() % 3 != 0)
+    {
+        printf("[ERROR][%s(%d)] Mesh has no vertices or an incomplete triangle\n", __FILE__, __LINE__);
+        return false;
+    }
+    if(!file.open(path))
+    {
+        printf("[ERROR][%s(%d)] Failed to open file %s for writing\n", __FILE__, __LINE__, path);
+        return false;
+    }
+    return true;
+}
+
+static bool reportWriteError(const char *path)
+{
+    printf("[ERROR][%s(%d)] Failed to write file %s\n", __FILE__, __LINE__, path);
+    return false;
+}
+
+
+
+
+// ============================ GLB ============================
+
+static void appendBufferView(std::string& json, size_t offset, size_t length, int target)
+{
+    char buf[128];
+    snprintf(buf, sizeof(buf), "{\"buffer\":0,\"byteOffset\":%zu,\"byteLength\":%zu,\"target\":%d}", offset, length, target);
+    json += buf;
+}
+
+static void appendAccessor(std::string& json, int bufferView, int componentType, size_t count, const char *type)
+{
+    char buf[128];
+    snprintf(buf, sizeof(buf), "{\"bufferView\":%d,\"componentType\":%d,\"count\":%zu,\"type\":\"%s\"", bufferView, componentType, count, type);
+    json += buf;
+}
+
+bool exportGlb(const CurveMeshData& mesh, const char *path)
+{
+    OutputFile file;
+    if(!openForExport(file, mesh, path))
+    {
+        return false;
+    }
+
+    const bool withNormals = hasNormals(mesh);
+    const bool withUvs = hasUvs(mesh);
+
+    // the only pass over the data, POSITION accessors are required to have bounds
+    BoundingBox bounds;
+    for(const glm::vec3& v : mesh.vertices)
+    {
+        expandBoundingBox(bounds, v);
+    }
+
+    // every attribute gets its own tightly packed buffer view, all element sizes are multiples of 4 so no padding is needed
+    std::vector<WriteRange> binRanges;
+    std::string views, accessors, attributes;
+    size_t binLength = 0;
+    int viewCount = 0;
+
+    auto addView = [&](const void *data, size_t size, int target)
+    {
+        if(viewCount > 0)
+        {
+            views += ',';
+            accessors += ',';
+        }
+        appendBufferView(views, binLength, size, target);
+        binRanges.push_back({ data, size });
+        binLength += size;
+        return viewCount++;
+    };
+
+    char buf[256];
+
+    int view = addView(mesh.vertices.data(), mesh.vertices.size() * sizeof(glm::vec3), GLTF_ARRAY_BUFFER);
+    appendAccessor(accessors, view, GLTF_FLOAT, mesh.vertices.size(), "VEC3");
+    snprintf(buf, sizeof(buf), ",\"min\":[%.9g,%.9g,%.9g],\"max\":[%.9g,%.9g,%.9g]}",
+        bounds.min.x, bounds.min.y, bounds.min.z, bounds.max.x, bounds.max.y, bounds.max.z);
+    accessors += buf;
+    attributes += "\"POSITION\":0";
+
+    if(withNormals)
+    {
+        view = addView(mesh.normals.data(), mesh.normals.size() * sizeof(glm::vec3), GLTF_ARRAY_BUFFER);
+        appendAccessor(accessors, view, GLTF_FLOAT, mesh.normals.size(), "VEC3");
+        accessors += '}';
+        snprintf(buf, sizeof(buf), ",\"NORMAL\":%d", view);
+        attributes += buf;
+    }
+    if(withUvs)
+    {
+        view = addView(mesh.uvs.data(), mesh.uvs.size() * sizeof(glm::vec2), GLTF_ARRAY_BUFFER);
+        appendAccessor(accessors, view, GLTF_FLOAT, mesh.uvs.size(), "VEC2");
+        accessors += '}';
+        snprintf(buf, sizeof(buf), ",\"TEXCOORD_0\":%d", view);
+        attributes += buf;
+    }
+
+    int indicesAccessor = -1;
+    if(!mesh.indices.empty())
+    {
+        indicesAccessor = addView(mesh.indices.data(), mesh.indices.size() * sizeof(unsigned int), GLTF_ELEMENT_ARRAY_BUFFER);
+        appendAccessor(accessors, indicesAccessor, GLTF_UNSIGNED_INT, mesh.indices.size(), "SCALAR");
+        accessors += '}';
+    }
+
+    // accessor i always uses buffer view i
+    std::string json = "{\"asset\":{\"version\":\"2.0\",\"generator\":\"ProfileExtruder\"},\"scene\":0,\"scenes\":[{\"nodes\":[0]}],\"nodes\":[{\"mesh\":0}],";
+    json += "\"meshes\":[{\"primitives\":[{\"attributes\":{" + attributes + "}";
+    if(indicesAccessor >= 0)
+    {
+        json += ",\"indices\":" + std::to_string(indicesAccessor);
+    }
+    json += "}]}],";
+    json += "\"buffers\":[{\"byteLength\":" + std::to_string(binLength) + "}],";
+    json += "\"bufferViews\":[" + views + "],";
+    json += "\"accessors\":[" + accessors + "]}";
+
+    // JSON chunk is padded with spaces, BIN chunk with zeros
+    while(json.size() % 4 != 0)
+    {
+        json += ' ';
+    }
+    static const unsigned char zeros[4] = { 0, 0, 0, 0 };
+    const size_t binPadding = (4 - binLength % 4) % 4;
+
+    const uint32_t jsonChunkHeader[2] = { (uint32_t)json.size(), GLB_CHUNK_JSON };
+    const uint32_t binChunkHeader[2] = { (uint32_t)(binLength + binPadding), GLB_CHUNK_BIN };
+    const uint32_t header[3] = { GLB_MAGIC, 2, (uint32_t)(sizeof(header) + sizeof(jsonChunkHeader) + json.size() + sizeof(binChunkHeader) + binLength + binPadding) };
+
+    std::vector<WriteRange> ranges = {
+        { header, sizeof(header) },
+        { jsonChunkHeader, sizeof(jsonChunkHeader) },
+        { json.data(), json.size() },
+        { binChunkHeader, sizeof(binChunkHeader) }
+    };
+    ranges.insert(ranges.end(), binRanges.begin(), binRanges.end());
+    ranges.push_back({ zeros, binPadding });
+
+    if(!file.write(ranges.data(), ranges.size()))
+    {
+        return reportWriteError(path);
+    }
+    return true;
+}
+
+
+
+
+// ============================ STL ============================
+
+const size_t STL_FACET_SIZE = 50;
+
+bool exportStl(const CurveMeshData& mesh, const char *path)
+{
+    OutputFile file;
+    if(!openForExport(file, mesh, path))
+    {
+        return false;
+    }
+
+    unsigned char header[84] = {};
+    const char title[] = "ProfileExtruder";
+    std::memcpy(header, title, sizeof(title) - 1);
+    const uint32_t triangleCount = (uint32_t)(mesh.indices.size() / 3);
+    std::memcpy(header + 80, &triangleCount, sizeof(triangleCount));
+
+    if(!file.write(header, sizeof(header)))
+    {
+        return reportWriteError(path);
+    }
+
+    BlockWriter writer(file);
+    for (size_t i = 0; i < mesh.indices.size(); i += 3)
+    {
+        const glm::vec3 triangle[3] = {
+            mesh.vertices[mesh.indices[i]],
+            mesh.vertices[mesh.indices[i + 1]],
+            mesh.vertices[mesh.indices[i + 2]]
+        };
+
+        glm::vec3 normal = glm::cross(triangle[1] - triangle[0], triangle[2] - triangle[0]);
+        const float length = glm::length(normal);
+        normal = length > 0.f ? normal / length : glm::vec3(0.f);
+
+        // normal, 3 vertices, 2 bytes of unused attribute count
+        unsigned char *facet = writer.reserve(STL_FACET_SIZE);
+        std::memcpy(facet, &normal, sizeof(glm::vec3));
+        std::memcpy(facet + 12, triangle, sizeof(triangle));
+        facet[48] = facet[49] = 0;
+    }
+
+    if(!writer.flush())
+    {
+        return reportWriteError(path);
+    }
+    return true;
+}
+
+
+
+
+// ============================ PLY ============================
+
+bool exportPly(const CurveMeshData& mesh, const char *path)
+{
+    OutputFile file;
+    if(!openForExport(file, mesh, path))
+    {
+        return false;
+    }
+
+    const bool withNormals = hasNormals(mesh);
+    const bool withUvs = hasUvs(mesh);
+
+    std::string header = "ply\nformat binary_little_endian 1.0\ncomment ProfileExtruder\n";
+    header += "element vertex " + std::to_string(mesh.vertices.size()) + "\n";
+    header += "property float x\nproperty float y\nproperty float z\n";
+    if(withNormals)
+    {
+        header += "property float nx\nproperty float ny\nproperty float nz\n";
+    }
+    if(withUvs)
+    {
+        header += "property float s\nproperty float t\n";
+    }
+    header += "element face " + std::to_string(mesh.indices.size() / 3) + "\n";
+    header += "property list uchar uint vertex_indices\nend_header\n";
+
+    if(!file.write(header.data(), header.size()))
+    {
+        return reportWriteError(path);
+    }
+
+    BlockWriter writer(file);
+
+    const size_t vertexSize = sizeof(glm::vec3) + (withNormals ? sizeof(glm::vec3) : 0) + (withUvs ? sizeof(glm::vec2) : 0);
+    for (size_t i = 0; i < mesh.vertices.size(); i++)
+    {
+        unsigned char *record = writer.reserve(vertexSize);
+        std::memcpy(record, &mesh.vertices[i], sizeof(glm::vec3));
+        record += sizeof(glm::vec3);
+        if(withNormals)
+        {
+            std::memcpy(record, &mesh.normals[i], sizeof(glm::vec3));
+            record += sizeof(glm::vec3);
+        }
+        if(withUvs)
+        {
+            std::memcpy(record, &mesh.uvs[i], sizeof(glm::vec2));
+        }
+    }
+
+    const size_t faceSize = 1 + 3 * sizeof(uint32_t);
+    for (size_t i = 0; i < mesh.indices.size(); i += 3)
+    {
+        unsigned char *record = writer.reserve(faceSize);
+        record[0] = 3;
+        std::memcpy(record + 1, &mesh.indices[i], 3 * sizeof(uint32_t));
+    }
+
+    if(!writer.flush())
+    {
+        return reportWriteError(path);
+    }
+    return true;
+}
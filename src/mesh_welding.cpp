@@ -0,0 +1,201 @@
+#include "mesh_welding.hpp"
+
+#include <algorithm> // std::sort, std::swap
+#include <array>
+#include <cmath> // std::floor
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <unordered_map>
+
+
+const unsigned int NO_VERTEX = std::numeric_limits<unsigned int>::max();
+// normals of merged vertices may differ by roughly one degree at most
+const float WELD_NORMAL_MIN_DOT = 0.9998f;
+
+
+// cell coordinates are wrapped to 21 bits each, far away cells sharing a key only cost a few extra distance checks
+static uint64_t cellKey(int64_t x, int64_t y, int64_t z)
+{
+    const uint64_t mask = (1u << 21) - 1;
+    return ((uint64_t)x & mask) | (((uint64_t)y & mask) << 21) | (((uint64_t)z & mask) << 42);
+}
+
+CurveMeshData weldMesh(const CurveMeshData& mesh, const WeldOptions& options)
+{
+    CurveMeshData welded{};
+
+    if(mesh.indices.size() % 3 != 0)
+    {
+        printf("[ERROR][%s(%d)] Mesh has an incomplete triangle\n", __FILE__, __LINE__);
+        return welded;
+    }
+
+    const bool withNormals = options.keepAttributes && mesh.normals.size() == mesh.vertices.size();
+    const bool withUvs = options.keepAttributes && mesh.uvs.size() == mesh.vertices.size();
+
+    const float tolerance = std::max(options.tolerance, std::numeric_limits<float>::min());
+    const float toleranceSq = tolerance * tolerance;
+    // with cells as big as the tolerance all candidates for merging are in the neighbouring cells
+    const float invCellSize = 1.f / tolerance;
+
+    auto attributesMatch = [&](unsigned int a, unsigned int b) -> bool {
+        if(withNormals && glm::dot(mesh.normals[a], mesh.normals[b]) < WELD_NORMAL_MIN_DOT)
+        {
+            return false;
+        }
+        if(withUvs)
+        {
+            glm::vec2 d = mesh.uvs[a] - mesh.uvs[b];
+            if(glm::dot(d, d) > toleranceSq)
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+
+
+
+    // ============= VERTICES ============= //
+    // input vertex that represents every welded vertex
+    std::vector<unsigned int> representatives;
+    // welded vertex of every input vertex
+    std::vector<unsigned int> remap(mesh.vertices.size());
+
+    // the last welded vertex put in a cell, the others are chained through `nextInCell`
+    std::unordered_map<uint64_t, unsigned int> cells;
+    cells.reserve(mesh.vertices.size());
+    std::vector<unsigned int> nextInCell;
+
+    for (unsigned int i = 0; i < mesh.vertices.size(); i++)
+    {
+        const glm::vec3& p = mesh.vertices[i];
+        const int64_t cx = (int64_t)std::floor(p.x * invCellSize);
+        const int64_t cy = (int64_t)std::floor(p.y * invCellSize);
+        const int64_t cz = (int64_t)std::floor(p.z * invCellSize);
+
+        unsigned int match = NO_VERTEX;
+        for (int dz = -1; dz <= 1 && match == NO_VERTEX; dz++)
+        {
+            for (int dy = -1; dy <= 1 && match == NO_VERTEX; dy++)
+            {
+                for (int dx = -1; dx <= 1 && match == NO_VERTEX; dx++)
+                {
+                    auto it = cells.find(cellKey(cx + dx, cy + dy, cz + dz));
+                    if(it == cells.end())
+                    {
+                        continue;
+                    }
+
+                    for (unsigned int k = it->second; k != NO_VERTEX; k = nextInCell[k])
+                    {
+                        const glm::vec3 d = mesh.vertices[representatives[k]] - p;
+                        if(glm::dot(d, d) <= toleranceSq && attributesMatch(representatives[k], i))
+                        {
+                            match = k;
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+
+        if(match == NO_VERTEX)
+        {
+            match = representatives.size();
+            representatives.push_back(i);
+            nextInCell.push_back(NO_VERTEX);
+
+            auto inserted = cells.emplace(cellKey(cx, cy, cz), match);
+            if(!inserted.second)
+            {
+                nextInCell[match] = inserted.first->second;
+                inserted.first->second = match;
+            }
+        }
+
+        remap[i] = match;
+    }
+
+
+
+    // ============= TRIANGLES ============= //
+    // triangles made of the same vertices are found by sorting their sorted corners,
+    // the first one of every such group is kept regardless of winding
+    std::vector<std::array<unsigned int, 4>> corners; // sorted corners and the triangle index
+    corners.reserve(mesh.indices.size() / 3);
+
+    for (unsigned int t = 0; t < mesh.indices.size() / 3; t++)
+    {
+        unsigned int a = remap[mesh.indices[t * 3]];
+        unsigned int b = remap[mesh.indices[t * 3 + 1]];
+        unsigned int c = remap[mesh.indices[t * 3 + 2]];
+        if(a == b || b == c || a == c)
+        {
+            continue;
+        }
+
+        // twice the area of the triangle
+        const glm::vec3& va = mesh.vertices[representatives[a]];
+        const glm::vec3& vb = mesh.vertices[representatives[b]];
+        const glm::vec3& vc = mesh.vertices[representatives[c]];
+        if(glm::length(glm::cross(vb - va, vc - va)) <= toleranceSq)
+        {
+            continue;
+        }
+
+        if(a > b) std::swap(a, b);
+        if(b > c) std::swap(b, c);
+        if(a > b) std::swap(a, b);
+        corners.push_back({a, b, c, t});
+    }
+
+    std::sort(corners.begin(), corners.end());
+
+    std::vector<unsigned int> keptTriangles;
+    keptTriangles.reserve(corners.size());
+    for (size_t k = 0; k < corners.size(); k++)
+    {
+        if(k == 0 || corners[k][0] != corners[k - 1][0] || corners[k][1] != corners[k - 1][1] || corners[k][2] != corners[k - 1][2])
+        {
+            keptTriangles.push_back(corners[k][3]);
+        }
+    }
+    // restore the original order of triangles
+    std::sort(keptTriangles.begin(), keptTriangles.end());
+
+
+
+    // ============= OUTPUT ============= //
+    // only the vertices of the kept triangles are written, in order of their first use
+    std::vector<unsigned int> outputIndex(representatives.size(), NO_VERTEX);
+    welded.indices.reserve(keptTriangles.size() * 3);
+
+    for(unsigned int t : keptTriangles)
+    {
+        for (unsigned int k = 0; k < 3; k++)
+        {
+            const unsigned int v = remap[mesh.indices[t * 3 + k]];
+            if(outputIndex[v] == NO_VERTEX)
+            {
+                outputIndex[v] = welded.vertices.size();
+
+                const unsigned int source = representatives[v];
+                welded.vertices.push_back(mesh.vertices[source]);
+                if(withNormals)
+                {
+                    welded.normals.push_back(mesh.normals[source]);
+                }
+                if(withUvs)
+                {
+                    welded.uvs.push_back(mesh.uvs[source]);
+                }
+            }
+
+            welded.indices.push_back(outputIndex[v]);
+        }
+    }
+
+    return welded;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <algorithm> // std::min, std::max
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+
+// Splits range [0, count) into contiguous chunks of at least `minChunkSize` elements, 0 counts as 1,
+// and calls `body(begin, end)` for each of them on a separate thread.
+// Small ranges are processed on the calling thread.
+template<typename Body>
+void parallelFor(size_t count, size_t minChunkSize, const Body& body)
+{
+    size_t threadCount = std::thread::hardware_concurrency();
+    if(threadCount == 0)
+    {
+        threadCount = 1;
+    }
+    minChunkSize = std::max<size_t>(minChunkSize, 1);
+    threadCount = std::min(threadCount, (count + minChunkSize - 1) / minChunkSize);
+
+    if(threadCount <= 1)
+    {
+        if(count > 0)
+        {
+            body(size_t(0), count);
+        }
+        return;
+    }
+
+    const size_t chunkSize = (count + threadCount - 1) / threadCount;
+
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount - 1);
+    for (size_t t = 1; t < threadCount; t++)
+    {
+        const size_t begin = t * chunkSize;
+        const size_t end = std::min(begin + chunkSize, count);
+        if(begin < end)
+        {
+            threads.emplace_back([&body, begin, end]() { body(begin, end); });
+        }
+    }
+
+    // the first chunk is handled by the calling thread
+    body(size_t(0), std::min(chunkSize, count));
+
+    for(auto& thread : threads)
+    {
+        thread.join();
+    }
+}
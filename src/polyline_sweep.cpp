@@ -0,0 +1,276 @@
+#include "polyline_sweep.hpp"
+
+#include <glm/gtx/rotate_vector.hpp>
+
+#include <algorithm> // std::min, std::max
+#include <cmath>
+#include <cstdio>
+
+
+// a point of the path after the corners are made, creases split the mesh into separately shaded pieces
+struct PathPoint
+{
+    glm::vec3 position;
+    bool crease;
+};
+
+static float turnAngle(const glm::vec3& from, const glm::vec3& to)
+{
+    return std::atan2(glm::length(glm::cross(from, to)), glm::dot(from, to));
+}
+
+// axis that turns `from` into `to`, any axis perpendicular to `from` when they point in opposite directions
+static glm::vec3 turnAxis(const glm::vec3& from, const glm::vec3& to)
+{
+    const glm::vec3 axis = glm::cross(from, to);
+    const float length = glm::length(axis);
+    if(length > 1e-6f)
+    {
+        return axis / length;
+    }
+
+    const glm::vec3 other = std::abs(from.x) < 0.9f ? glm::vec3(1.f, 0.f, 0.f) : glm::vec3(0.f, 1.f, 0.f);
+    return glm::normalize(glm::cross(from, other));
+}
+
+// points closer than `mergeDistance` to the previous one are merged into it
+static void appendPathPoint(std::vector<PathPoint>& path, const glm::vec3& position, bool crease, float mergeDistance)
+{
+    // corners that take up their whole segments meet in the middle of it
+    if(!path.empty() && glm::length(position - path.back().position) < mergeDistance)
+    {
+        path.back().crease = path.back().crease || crease;
+        return;
+    }
+    path.push_back({position, crease});
+}
+
+// drops repeated points and points in the middle of straight runs
+template<typename T>
+static std::vector<glm::vec3> simplifyPolyline(const std::vector<glm::vec<3, T>>& polyline, const glm::vec<3, T>& origin, float collinearAngle)
+{
+    std::vector<glm::vec3> points;
+    for(const auto& p : polyline)
+    {
+        // only the subtraction of the origin needs the full precision
+        const glm::vec3 point(p - origin);
+        if(points.empty() || point != points.back())
+        {
+            points.push_back(point);
+        }
+    }
+
+    if(points.size() < 3)
+    {
+        return points;
+    }
+
+    std::vector<glm::vec3> kept = {points[0]};
+    for (size_t i = 1; i + 1 < points.size(); i++)
+    {
+        if(turnAngle(points[i] - kept.back(), points[i + 1] - points[i]) > collinearAngle)
+        {
+            kept.push_back(points[i]);
+        }
+    }
+    kept.push_back(points.back());
+
+    return kept;
+}
+
+// replaces the corners of the polyline with the points of their joints
+static std::vector<PathPoint> makeJoints(const std::vector<glm::vec3>& points, float profileRadius, float mergeDistance, const PolylineSweepOptions& sweepOptions)
+{
+    std::vector<PathPoint> path = {{points[0], false}};
+
+    for (size_t i = 1; i + 1 < points.size(); i++)
+    {
+        const glm::vec3 in = points[i] - points[i - 1];
+        const glm::vec3 out = points[i + 1] - points[i];
+        const float inLength = glm::length(in);
+        const float outLength = glm::length(out);
+        const glm::vec3 d0 = in / inLength;
+        const glm::vec3 d1 = out / outLength;
+        const float angle = turnAngle(d0, d1);
+
+        if(angle < 1e-6f)
+        {
+            appendPathPoint(path, points[i], false, mergeDistance);
+            continue;
+        }
+
+        PolylineJoint joint = sweepOptions.joint;
+        if(joint == PolylineJoint::Miter && std::cos(angle * 0.5f) * sweepOptions.miterLimit < 1.f)
+        {
+            joint = PolylineJoint::Bevel;
+        }
+
+        if(joint == PolylineJoint::Miter)
+        {
+            appendPathPoint(path, points[i], true, mergeDistance);
+            continue;
+        }
+
+        // The corner is cut at the points where a circle of the corner radius touches both segments,
+        // moved closer to the corner if the segments are too short; each segment is shared with the corner at its other end.
+        // a polyline doubling back on itself leaves no room for a corner, tan() must not go past the pole
+        const float halfTan = std::tan(std::min(angle, 3.14f) * 0.5f);
+        const float cut = std::min(sweepOptions.cornerRadius * profileRadius * halfTan, std::min(inLength, outLength) * 0.5f);
+        const float radius = cut / halfTan;
+
+        const glm::vec3 axis = turnAxis(d0, d1);
+        const glm::vec3 start = points[i] - d0 * cut;
+        const glm::vec3 end = points[i] + d1 * cut;
+        const glm::vec3 center = start + glm::cross(axis, d0) * radius;
+
+        const bool isRound = joint == PolylineJoint::Round;
+        const size_t steps = isRound ? std::max<size_t>(1, size_t(std::ceil(angle / std::max(sweepOptions.roundStepAngle, 1e-3f)))) : 1;
+
+        appendPathPoint(path, start, !isRound, mergeDistance);
+        for (size_t k = 1; k < steps; k++)
+        {
+            appendPathPoint(path, center + glm::rotate(start - center, angle * float(k) / float(steps), axis), false, mergeDistance);
+        }
+        appendPathPoint(path, end, !isRound, mergeDistance);
+    }
+
+    appendPathPoint(path, points.back(), false, mergeDistance);
+    path.back().crease = false;
+
+    return path;
+}
+
+// Frames carried along the path by the smallest rotation at every point, so that the profile doesn't twist.
+// Rings at the points between two segments lie in the plane halfway between them and are stretched across the bend,
+// so that they fit the tubes of both segments, by no more than `maxStretch`.
+static std::vector<RingFrame> computePathFrames(const std::vector<PathPoint>& path, float maxStretch)
+{
+    std::vector<RingFrame> frames(path.size());
+
+    glm::vec3 direction = glm::normalize(path[1].position - path[0].position);
+    RingFrame frame = computeRingFrame(ExtrusionPointT<float>{path[0].position, direction, 0.f}, glm::vec3(0.f));
+    frames[0] = frame;
+
+    for (size_t i = 1; i + 1 < path.size(); i++)
+    {
+        const glm::vec3 next = glm::normalize(path[i + 1].position - path[i].position);
+        const float angle = turnAngle(direction, next);
+        const glm::vec3 axis = turnAxis(direction, next);
+
+        RingFrame& ring = frames[i];
+        ring.position = path[i].position;
+        ring.right = glm::rotate(frame.right, angle * 0.5f, axis);
+        ring.up = glm::rotate(frame.up, angle * 0.5f, axis);
+
+        if(angle > 0.f)
+        {
+            const glm::vec3 bend = glm::normalize(next - direction);
+            const float stretch = 1.f / std::max(std::cos(angle * 0.5f), 1.f / maxStretch) - 1.f;
+            ring.right += bend * (glm::dot(ring.right, bend) * stretch);
+            ring.up += bend * (glm::dot(ring.up, bend) * stretch);
+        }
+
+        frame.right = glm::rotate(frame.right, angle, axis);
+        frame.up = glm::rotate(frame.up, angle, axis);
+        direction = next;
+    }
+
+    frame.position = path.back().position;
+    frames.back() = frame;
+
+    return frames;
+}
+
+template<typename T>
+CurveMeshData extrudeProfileAlongPolyline(const std::vector<glm::vec2>& profile, const std::vector<glm::vec<3, T>>& polyline, const PolylineSweepOptions& sweepOptions, const ExtrusionOptions& options, const glm::vec<3, T>& origin)
+{
+    CurveMeshData mesh{};
+
+    const std::vector<glm::vec3> points = simplifyPolyline(polyline, origin, sweepOptions.collinearAngle);
+    if(points.size() < 2 || profile.size() < 3)
+    {
+        printf("[ERROR][%s(%d)] Not enough points to construct a mesh\n", __FILE__, __LINE__);
+        return mesh;
+    }
+
+    float profileRadius = 0.f;
+    for(const auto& v : profile)
+    {
+        profileRadius = std::max(profileRadius, glm::length(v));
+    }
+
+    // points are merged relative to the size of the polyline, so that neither big nor small ones lose their detail to float precision
+    glm::vec3 pointsMin = points[0], pointsMax = points[0];
+    for(const auto& p : points)
+    {
+        pointsMin = glm::min(pointsMin, p);
+        pointsMax = glm::max(pointsMax, p);
+    }
+    const float mergeDistance = glm::length(pointsMax - pointsMin) * 1e-6f;
+
+    const std::vector<PathPoint> path = makeJoints(points, profileRadius, mergeDistance, sweepOptions);
+    // the whole polyline can collapse into a single point
+    if(path.size() < 2)
+    {
+        printf("[ERROR][%s(%d)] Not enough points to construct a mesh\n", __FILE__, __LINE__);
+        return mesh;
+    }
+    const std::vector<RingFrame> frames = computePathFrames(path, std::max(sweepOptions.miterLimit, 1.f));
+
+    if(isExtrusionCancelled(options))
+    {
+        return mesh;
+    }
+
+    mesh.ringSize = profile.size() + (options.seamless ? 0 : 1);
+    mesh.segmentIndexCount = profile.size() * 6;
+
+    // every piece between two creases is a tube of its own, sharing its end rings with its neighbours
+    size_t first = 0;
+    for (size_t i = 1; i < frames.size(); i++)
+    {
+        if(!path[i].crease && i + 1 < frames.size())
+        {
+            continue;
+        }
+
+        const size_t firstVertex = mesh.vertices.size();
+        const std::vector<RingFrame> pieceFrames(frames.begin() + first, frames.begin() + i + 1);
+        if(!appendTube(mesh, profile, pieceFrames, options))
+        {
+            return CurveMeshData{};
+        }
+
+        // texture coordinates continue from the previous piece
+        if(!options.seamless)
+        {
+            for (size_t k = firstVertex; k < mesh.uvs.size(); k++)
+            {
+                mesh.uvs[k].y += float(first);
+            }
+        }
+
+        first = i;
+    }
+
+    if(options.startCap)
+    {
+        appendCap(mesh, profile, frames.front(), true, !options.seamless);
+    }
+    if(options.endCap)
+    {
+        appendCap(mesh, profile, frames.back(), false, !options.seamless);
+    }
+
+    if(options.computeSegmentBounds)
+    {
+        computeSegmentBounds(frames, profileRadius, mesh.segmentBounds);
+    }
+
+    return mesh;
+}
+
+
+
+template CurveMeshData extrudeProfileAlongPolyline(const std::vector<glm::vec2>&, const std::vector<glm::vec<3, float>>&, const PolylineSweepOptions&, const ExtrusionOptions&, const glm::vec<3, float>&);
+template CurveMeshData extrudeProfileAlongPolyline(const std::vector<glm::vec2>&, const std::vector<glm::vec<3, double>>&, const PolylineSweepOptions&, const ExtrusionOptions&, const glm::vec<3, double>&);
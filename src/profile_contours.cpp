@@ -0,0 +1,186 @@
+#include "profile_contours.hpp"
+
+#include <algorithm> // std::reverse, std::max, std::any_of
+#include <cstdio>
+
+
+static float signedArea(const std::vector<glm::vec2>& vertices)
+{
+    float area = 0.f;
+    for (size_t i = 0; i < vertices.size(); i++)
+    {
+        const glm::vec2& a = vertices[i];
+        const glm::vec2& b = vertices[(i + 1) % vertices.size()];
+        area += a.x * b.y - a.y * b.x;
+    }
+
+    return area * 0.5f;
+}
+
+// even-odd rule, by counting the edges a ray from the point along +x crosses
+static bool isPointInContour(const glm::vec2& p, const std::vector<glm::vec2>& vertices)
+{
+    bool inside = false;
+    for (size_t i = 0, j = vertices.size() - 1; i < vertices.size(); j = i++)
+    {
+        const glm::vec2& a = vertices[i];
+        const glm::vec2& b = vertices[j];
+        if((a.y > p.y) != (b.y > p.y) && p.x < a.x + (b.x - a.x) * (p.y - a.y) / (b.y - a.y))
+        {
+            inside = !inside;
+        }
+    }
+
+    return inside;
+}
+
+template<typename T>
+MultiContourMeshData extrudeProfileContours(std::vector<ProfileContour> contours, const std::vector<ExtrusionPointT<T>>& extrusionPoints, const ExtrusionOptions& options, const glm::vec<3, T>& origin)
+{
+    MultiContourMeshData result;
+
+    if(extrusionPoints.size() < 2)
+    {
+        printf("[ERROR][%s(%d)] Not enough points to construct a mesh\n", __FILE__, __LINE__);
+        return result;
+    }
+    for (size_t i = 0; i < contours.size(); i++)
+    {
+        if(contours[i].vertices.size() < 3)
+        {
+            printf("[ERROR][%s(%d)] Contour %zu has fewer than 3 vertices\n", __FILE__, __LINE__, i);
+            return result;
+        }
+    }
+
+    // the winding decides which way the faces of a contour point
+    for(auto& contour : contours)
+    {
+        if((signedArea(contour.vertices) < 0.f) != contour.isHole)
+        {
+            std::reverse(contour.vertices.begin(), contour.vertices.end());
+        }
+    }
+
+    std::vector<bool> capped(contours.size(), false);
+    if(options.startCap || options.endCap)
+    {
+        bool skippedCaps = false;
+        for (size_t i = 0; i < contours.size(); i++)
+        {
+            if(contours[i].isHole)
+            {
+                continue;
+            }
+
+            const bool hasHoles = std::any_of(contours.begin(), contours.end(), [&](const ProfileContour& other) {
+                return other.isHole && isPointInContour(other.vertices[0], contours[i].vertices);
+            });
+            capped[i] = !hasHoles;
+            skippedCaps = skippedCaps || hasHoles;
+        }
+
+        if(skippedCaps)
+        {
+            printf("[WARNING][%s(%d)] Caps can't have holes, contours with holes are left open\n", __FILE__, __LINE__);
+        }
+    }
+
+    const std::vector<RingFrame> frames = computeRingFrames(extrusionPoints, origin, options);
+    if(isExtrusionCancelled(options))
+    {
+        return result;
+    }
+
+    // everything is allocated up front, so that the contours are appended without reallocating the mesh
+    const size_t seamSize = options.seamless ? 0 : 1;
+    const size_t capCount = (options.startCap ? 1 : 0) + (options.endCap ? 1 : 0);
+    size_t vertexCount = 0, indexCount = 0;
+    for (size_t i = 0; i < contours.size(); i++)
+    {
+        const size_t size = contours[i].vertices.size();
+        vertexCount += frames.size() * (size + seamSize);
+        indexCount += (frames.size() - 1) * size * 6;
+        if(capped[i])
+        {
+            vertexCount += capCount * size;
+            indexCount += capCount * (size - 2) * 3;
+        }
+    }
+
+    CurveMeshData& mesh = result.mesh;
+    mesh.vertices.reserve(vertexCount);
+    mesh.normals.reserve(vertexCount);
+    mesh.uvs.reserve(options.seamless ? 0 : vertexCount);
+    mesh.indices.reserve(indexCount);
+
+    result.contours.resize(contours.size());
+    for (size_t i = 0; i < contours.size(); i++)
+    {
+        const std::vector<glm::vec2>& vertices = contours[i].vertices;
+
+        ContourRange& range = result.contours[i];
+        range.firstVertex = mesh.vertices.size();
+        range.firstIndex = mesh.indices.size();
+        range.ringSize = vertices.size() + seamSize;
+        range.segmentIndexCount = vertices.size() * 6;
+
+        if(!appendTube(mesh, vertices, frames, options))
+        {
+            return MultiContourMeshData{};
+        }
+
+        if(capped[i] && options.startCap)
+        {
+            appendCap(mesh, vertices, frames.front(), true, !options.seamless);
+        }
+        if(capped[i] && options.endCap)
+        {
+            appendCap(mesh, vertices, frames.back(), false, !options.seamless);
+        }
+
+        range.vertexCount = mesh.vertices.size() - range.firstVertex;
+        range.indexCount = mesh.indices.size() - range.firstIndex;
+    }
+
+    if(options.computeSegmentBounds)
+    {
+        float radius = 0.f;
+        for(const auto& contour : contours)
+        {
+            for(const auto& v : contour.vertices)
+            {
+                radius = std::max(radius, glm::length(v));
+            }
+        }
+
+        computeSegmentBounds(frames, radius, mesh.segmentBounds);
+    }
+
+    return result;
+}
+
+template<typename T>
+MultiContourMeshData extrudeProfileContoursWithCurve(const std::vector<ProfileContour>& contours, const CurveSamplerT<T>& curve, unsigned int segmentCount, const ExtrusionOptions& options, const glm::vec<3, T>& origin)
+{
+    auto samples = curve.sample(segmentCount);
+
+    if(samples.size() < 2)
+    {
+        printf("[ERROR][%s(%d)] Not enough points to plot a curve\n", __FILE__, __LINE__);
+        return MultiContourMeshData{};
+    }
+    if(isExtrusionCancelled(options))
+    {
+        return MultiContourMeshData{};
+    }
+
+    return extrudeProfileContours(contours, computeExtrusionPoints(samples), options, origin);
+}
+
+
+
+template MultiContourMeshData extrudeProfileContours(std::vector<ProfileContour>, const std::vector<ExtrusionPointT<float>>&, const ExtrusionOptions&, const glm::vec<3, float>&);
+template MultiContourMeshData extrudeProfileContours(std::vector<ProfileContour>, const std::vector<ExtrusionPointT<double>>&, const ExtrusionOptions&, const glm::vec<3, double>&);
+template MultiContourMeshData extrudeProfileContoursWithCurve(const std::vector<ProfileContour>&, const CurveSamplerT<float>&, unsigned int, const ExtrusionOptions&, const glm::vec<3, float>&);
+template MultiContourMeshData extrudeProfileContoursWithCurve(const std::vector<ProfileContour>&, const CurveSamplerT<double>&, unsigned int, const ExtrusionOptions&, const glm::vec<3, double>&);
@@ -0,0 +1,141 @@
+#include "profile_triangulation.hpp"
+
+#include <cstdio>
+#include <algorithm> // std::reverse
+#include <numeric> // std::iota
+
+
+struct CachedTriangulation
+{
+    std::vector<glm::vec2> profile;
+    std::vector<unsigned int> indices;
+};
+
+// the same few profiles tend to be extruded over and over again
+static const size_t TRIANGULATION_CACHE_SIZE = 8;
+static thread_local std::vector<CachedTriangulation> triangulationCache;
+static thread_local size_t triangulationCacheNext = 0;
+
+
+static float cross2(glm::vec2 a, glm::vec2 b)
+{
+    return a.x * b.y - a.y * b.x;
+}
+
+static float signedArea(const std::vector<glm::vec2>& profile)
+{
+    float area = 0.f;
+    for (size_t i = 0; i < profile.size(); i++)
+    {
+        area += cross2(profile[i], profile[(i + 1) % profile.size()]);
+    }
+
+    return area * 0.5f;
+}
+
+static bool isPointInTriangle(glm::vec2 p, glm::vec2 a, glm::vec2 b, glm::vec2 c)
+{
+    // points on the edges count as inside, so that no ear can touch another vertex
+    return cross2(b - a, p - a) >= 0.f
+        && cross2(c - b, p - b) >= 0.f
+        && cross2(a - c, p - c) >= 0.f;
+}
+
+static std::vector<unsigned int> clipEars(const std::vector<glm::vec2>& profile)
+{
+    std::vector<unsigned int> indices;
+    indices.reserve((profile.size() - 2) * 3);
+
+    // vertices of the polygon that's left to triangulate, always kept in counter-clockwise order
+    std::vector<unsigned int> polygon(profile.size());
+    std::iota(polygon.begin(), polygon.end(), 0);
+    if(signedArea(profile) < 0.f)
+    {
+        std::reverse(polygon.begin(), polygon.end());
+    }
+
+    size_t i = 0;
+    size_t attemptsSinceLastEar = 0;
+    while(polygon.size() > 3)
+    {
+        const size_t n = polygon.size();
+        const unsigned int prev = polygon[(i + n - 1) % n];
+        const unsigned int curr = polygon[i % n];
+        const unsigned int next = polygon[(i + 1) % n];
+
+        const glm::vec2 a = profile[prev];
+        const glm::vec2 b = profile[curr];
+        const glm::vec2 c = profile[next];
+
+        bool isEar = cross2(b - a, c - b) > 0.f;
+        for (size_t k = 0; isEar && k < n; k++)
+        {
+            const unsigned int other = polygon[k];
+            if(other != prev && other != curr && other != next)
+            {
+                isEar = !isPointInTriangle(profile[other], a, b, c);
+            }
+        }
+
+        // a full lap without an ear means the profile is degenerate or self-intersecting,
+        // clip whatever is at hand so that the cap at least doesn't have holes
+        if(isEar || attemptsSinceLastEar > n)
+        {
+            if(!isEar)
+            {
+                printf("[WARNING][%s(%d)] Profile is not a simple polygon, cap may be incorrect\n", __FILE__, __LINE__);
+            }
+
+            indices.push_back(prev);
+            indices.push_back(curr);
+            indices.push_back(next);
+
+            polygon.erase(polygon.begin() + i % n);
+            attemptsSinceLastEar = 0;
+        }
+        else
+        {
+            i++;
+            attemptsSinceLastEar++;
+        }
+
+        i %= polygon.size();
+    }
+
+    indices.push_back(polygon[0]);
+    indices.push_back(polygon[1]);
+    indices.push_back(polygon[2]);
+
+    return indices;
+}
+
+
+std::vector<unsigned int> triangulateProfile(const std::vector<glm::vec2>& profile)
+{
+    if(profile.size() < 3)
+    {
+        return {};
+    }
+
+    for(const auto& cached : triangulationCache)
+    {
+        if(cached.profile == profile)
+        {
+            return cached.indices;
+        }
+    }
+
+    std::vector<unsigned int> indices = clipEars(profile);
+
+    if(triangulationCache.size() < TRIANGULATION_CACHE_SIZE)
+    {
+        triangulationCache.push_back({profile, indices});
+    }
+    else
+    {
+        triangulationCache[triangulationCacheNext] = {profile, indices};
+        triangulationCacheNext = (triangulationCacheNext + 1) % TRIANGULATION_CACHE_SIZE;
+    }
+
+    return indices;
+}
@@ -0,0 +1,114 @@
+#include "ring_transform.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define RING_TRANSFORM_HAS_AVX2
+#include <immintrin.h>
+#endif
+
+
+ProfileSoA makeProfileSoA(const std::vector<glm::vec2>& profile)
+{
+    ProfileSoA soa;
+    soa.x.reserve(profile.size());
+    soa.y.reserve(profile.size());
+
+    for(const auto& v : profile)
+    {
+        soa.x.push_back(v.x);
+        soa.y.push_back(v.y);
+    }
+
+    return soa;
+}
+
+
+
+static void transformProfileRingScalar(const float *x, const float *y, size_t count, const RingFrame& frame, glm::vec3 *out)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        out[i] = frame.position + frame.right * x[i] + frame.up * y[i];
+    }
+}
+
+#ifdef RING_TRANSFORM_HAS_AVX2
+
+__attribute__((target("avx2,fma")))
+static void transformProfileRingAVX2(const float *x, const float *y, size_t count, const RingFrame& frame, glm::vec3 *out)
+{
+    const __m256 px = _mm256_set1_ps(frame.position.x);
+    const __m256 py = _mm256_set1_ps(frame.position.y);
+    const __m256 pz = _mm256_set1_ps(frame.position.z);
+    const __m256 rx = _mm256_set1_ps(frame.right.x);
+    const __m256 ry = _mm256_set1_ps(frame.right.y);
+    const __m256 rz = _mm256_set1_ps(frame.right.z);
+    const __m256 ux = _mm256_set1_ps(frame.up.x);
+    const __m256 uy = _mm256_set1_ps(frame.up.y);
+    const __m256 uz = _mm256_set1_ps(frame.up.z);
+
+    alignas(32) float ox[8], oy[8], oz[8];
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 vx = _mm256_loadu_ps(x + i);
+        __m256 vy = _mm256_loadu_ps(y + i);
+
+        _mm256_store_ps(ox, _mm256_fmadd_ps(vx, rx, _mm256_fmadd_ps(vy, ux, px)));
+        _mm256_store_ps(oy, _mm256_fmadd_ps(vx, ry, _mm256_fmadd_ps(vy, uy, py)));
+        _mm256_store_ps(oz, _mm256_fmadd_ps(vx, rz, _mm256_fmadd_ps(vy, uz, pz)));
+
+        // interleave back into vec3s
+        for (size_t k = 0; k < 8; k++)
+        {
+            out[i + k] = glm::vec3(ox[k], oy[k], oz[k]);
+        }
+    }
+
+    transformProfileRingScalar(x + i, y + i, count - i, frame, out + i);
+}
+
+#endif // RING_TRANSFORM_HAS_AVX2
+
+
+
+typedef void (*RingTransformKernel)(const float *, const float *, size_t, const RingFrame&, glm::vec3 *);
+
+struct RingTransformDispatch
+{
+    RingTransformKernel kernel;
+    const char *name;
+};
+
+static RingTransformDispatch selectRingTransformKernel()
+{
+#ifdef RING_TRANSFORM_HAS_AVX2
+    if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+    {
+        return {transformProfileRingAVX2, "avx2"};
+    }
+#endif
+    return {transformProfileRingScalar, "scalar"};
+}
+
+static const RingTransformDispatch& ringTransformDispatch()
+{
+    static const RingTransformDispatch dispatch = selectRingTransformKernel();
+    return dispatch;
+}
+
+
+void transformProfileRing(const float *x, const float *y, size_t count, const RingFrame& frame, glm::vec3 *out)
+{
+    ringTransformDispatch().kernel(x, y, count, frame, out);
+}
+
+void transformProfileRing(const ProfileSoA& profile, const RingFrame& frame, glm::vec3 *out)
+{
+    ringTransformDispatch().kernel(profile.x.data(), profile.y.data(), profile.x.size(), frame, out);
+}
+
+const char *ringTransformKernelName()
+{
+    return ringTransformDispatch().name;
+}
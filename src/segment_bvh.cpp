@@ -0,0 +1,441 @@
+#include "segment_bvh.hpp"
+
+#include "parallel_for.hpp"
+
+#include <algorithm> // std::sort
+#include <cmath> // std::abs, std::isinf
+#include <cstdint>
+#include <future>
+
+
+const unsigned int BVH_MAX_LEAF_SIZE = 4;
+// subtrees bigger than this are built on separate threads, up to a certain depth
+const unsigned int BVH_PARALLEL_MIN_SIZE = 16384;
+const unsigned int BVH_PARALLEL_MAX_DEPTH = 3;
+const unsigned int BVH_MAX_DEPTH = 64;
+
+
+// spreads the lower 10 bits of the value so that there are two zero bits between each of them
+static uint32_t expandBits(uint32_t v)
+{
+    v = (v * 0x00010001u) & 0xFF0000FFu;
+    v = (v * 0x00000101u) & 0x0F00F00Fu;
+    v = (v * 0x00000011u) & 0xC30C30C3u;
+    v = (v * 0x00000005u) & 0x49249249u;
+    return v;
+}
+
+// 30-bit Morton code of a point given in range [0, 1]
+static uint32_t mortonCode(glm::vec3 p)
+{
+    p = glm::clamp(p * 1024.f, 0.f, 1023.f);
+    return expandBits((uint32_t)p.x) * 4 + expandBits((uint32_t)p.y) * 2 + expandBits((uint32_t)p.z);
+}
+
+
+struct BvhBuilder
+{
+    const std::vector<BoundingBox>& bounds;
+    // Morton code in the upper and segment index in the lower half, sorted
+    const std::vector<uint64_t>& keys;
+
+    // index of the last element that belongs to the first half of the range,
+    // which is where the highest bit that differs between the first and the last code changes
+    size_t findSplit(size_t first, size_t last) const
+    {
+        const uint32_t firstCode = keys[first] >> 32;
+        const uint32_t lastCode = keys[last] >> 32;
+
+        if(firstCode == lastCode)
+        {
+            return (first + last) / 2;
+        }
+
+        uint32_t highestBit = firstCode ^ lastCode;
+        while(highestBit & (highestBit - 1))
+        {
+            highestBit &= highestBit - 1;
+        }
+
+        // binary search for the last code that still has the bit unset
+        size_t lo = first, hi = last;
+        while(lo + 1 < hi)
+        {
+            size_t mid = (lo + hi) / 2;
+            if((keys[mid] >> 32) & highestBit)
+            {
+                hi = mid;
+            }
+            else
+            {
+                lo = mid;
+            }
+        }
+
+        return lo;
+    }
+
+    // builds a subtree for the range [first, last] and appends it to `nodes`
+    void build(std::vector<BvhNode>& nodes, size_t first, size_t last, unsigned int depth) const
+    {
+        const size_t nodeIndex = nodes.size();
+        nodes.push_back(BvhNode{});
+
+        if(last - first + 1 <= BVH_MAX_LEAF_SIZE || depth >= BVH_MAX_DEPTH)
+        {
+            BoundingBox box;
+            for (size_t i = first; i <= last; i++)
+            {
+                expandBoundingBox(box, bounds[(uint32_t)keys[i]]);
+            }
+
+            nodes[nodeIndex] = {box, (unsigned int)first, (unsigned int)(last - first + 1)};
+            return;
+        }
+
+        const size_t split = findSplit(first, last);
+
+        size_t rightIndex;
+        if(depth < BVH_PARALLEL_MAX_DEPTH && last - first + 1 >= BVH_PARALLEL_MIN_SIZE)
+        {
+            // the right subtree goes to another thread and is moved after the left one afterwards
+            auto rightFuture = std::async(std::launch::async, [this, split, last, depth]() {
+                std::vector<BvhNode> rightNodes;
+                build(rightNodes, split + 1, last, depth + 1);
+                return rightNodes;
+            });
+
+            build(nodes, first, split, depth + 1);
+
+            std::vector<BvhNode> rightNodes = rightFuture.get();
+            rightIndex = nodes.size();
+            for(auto& node : rightNodes)
+            {
+                if(node.segmentCount == 0)
+                {
+                    node.offset += rightIndex;
+                }
+                nodes.push_back(node);
+            }
+        }
+        else
+        {
+            build(nodes, first, split, depth + 1);
+            rightIndex = nodes.size();
+            build(nodes, split + 1, last, depth + 1);
+        }
+
+        BoundingBox box = nodes[nodeIndex + 1].bounds;
+        expandBoundingBox(box, nodes[rightIndex].bounds);
+        nodes[nodeIndex] = {box, (unsigned int)rightIndex, 0};
+    }
+};
+
+SegmentBvh buildSegmentBvh(const std::vector<BoundingBox>& bounds)
+{
+    SegmentBvh bvh;
+
+    if(bounds.empty())
+    {
+        return bvh;
+    }
+
+    BoundingBox centroidBounds;
+    for(const auto& box : bounds)
+    {
+        expandBoundingBox(centroidBounds, boundingBoxCenter(box));
+    }
+    const glm::vec3 extent = glm::max(centroidBounds.max - centroidBounds.min, glm::vec3(1e-6f));
+
+    std::vector<uint64_t> keys(bounds.size());
+    parallelFor(bounds.size(), 16384, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+        {
+            glm::vec3 normalized = (boundingBoxCenter(bounds[i]) - centroidBounds.min) / extent;
+            keys[i] = ((uint64_t)mortonCode(normalized) << 32) | (uint64_t)i;
+        }
+    });
+    std::sort(keys.begin(), keys.end());
+
+    bvh.segments.resize(keys.size());
+    for (size_t i = 0; i < keys.size(); i++)
+    {
+        bvh.segments[i] = (uint32_t)keys[i];
+    }
+
+    // a binary tree with leaves of at most a few elements has less than this many nodes
+    bvh.nodes.reserve(2 * bounds.size());
+    BvhBuilder{bounds, keys}.build(bvh.nodes, 0, keys.size() - 1, 0);
+
+    return bvh;
+}
+
+
+
+// distance along the ray at which it enters the box or a negative value if it misses it
+static float intersectRayBox(const BoundingBox& box, glm::vec3 origin, glm::vec3 inverseDirection, float maxDistance)
+{
+    float enter = 0.f;
+    float exit = maxDistance;
+    for (int axis = 0; axis < 3; axis++)
+    {
+        // a ray parallel to the slab is either always within it or never, 0 * inf on its planes would be NaN
+        if(std::isinf(inverseDirection[axis]))
+        {
+            if(origin[axis] < box.min[axis] || origin[axis] > box.max[axis])
+            {
+                return -1.f;
+            }
+            continue;
+        }
+
+        const float t0 = (box.min[axis] - origin[axis]) * inverseDirection[axis];
+        const float t1 = (box.max[axis] - origin[axis]) * inverseDirection[axis];
+        enter = std::max(enter, std::min(t0, t1));
+        exit = std::min(exit, std::max(t0, t1));
+    }
+
+    return enter <= exit ? enter : -1.f;
+}
+
+// traverses nodes hit by the ray, closer child first; `visitLeaf` returns the new maximum distance
+template<typename VisitLeaf>
+static void traverseRay(const SegmentBvh& bvh, glm::vec3 origin, glm::vec3 direction, float maxDistance, const VisitLeaf& visitLeaf)
+{
+    if(bvh.nodes.empty())
+    {
+        return;
+    }
+
+    const glm::vec3 inverseDirection = 1.f / direction;
+
+    unsigned int stack[BVH_MAX_DEPTH + 1];
+    size_t stackSize = 0;
+    stack[stackSize++] = 0;
+
+    while(stackSize > 0)
+    {
+        const BvhNode& node = bvh.nodes[stack[--stackSize]];
+
+        if(intersectRayBox(node.bounds, origin, inverseDirection, maxDistance) < 0.f)
+        {
+            continue;
+        }
+
+        if(node.segmentCount > 0)
+        {
+            maxDistance = visitLeaf(node, maxDistance);
+            continue;
+        }
+
+        const unsigned int left = (unsigned int)(&node - bvh.nodes.data()) + 1;
+        const unsigned int right = node.offset;
+
+        float tLeft = intersectRayBox(bvh.nodes[left].bounds, origin, inverseDirection, maxDistance);
+        float tRight = intersectRayBox(bvh.nodes[right].bounds, origin, inverseDirection, maxDistance);
+
+        // push the further one first, so that the closer one is visited next
+        if(tLeft >= 0.f && tRight >= 0.f)
+        {
+            stack[stackSize++] = tLeft < tRight ? right : left;
+            stack[stackSize++] = tLeft < tRight ? left : right;
+        }
+        else if(tLeft >= 0.f)
+        {
+            stack[stackSize++] = left;
+        }
+        else if(tRight >= 0.f)
+        {
+            stack[stackSize++] = right;
+        }
+    }
+}
+
+void raycastSegmentBvh(const SegmentBvh& bvh, glm::vec3 origin, glm::vec3 direction, float maxDistance, std::vector<unsigned int>& segments)
+{
+    traverseRay(bvh, origin, direction, maxDistance, [&](const BvhNode& leaf, float maxDistance) {
+        segments.insert(segments.end(), bvh.segments.begin() + leaf.offset, bvh.segments.begin() + leaf.offset + leaf.segmentCount);
+        return maxDistance;
+    });
+}
+
+
+
+void extractFrustumPlanes(const glm::mat4& viewProjection, glm::vec4 planes[6])
+{
+    auto row = [&](int i) {
+        return glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+    };
+
+    planes[0] = row(3) + row(0); // left
+    planes[1] = row(3) - row(0); // right
+    planes[2] = row(3) + row(1); // bottom
+    planes[3] = row(3) - row(1); // top
+    planes[4] = row(3) + row(2); // near
+    planes[5] = row(3) - row(2); // far
+
+    for (int i = 0; i < 6; i++)
+    {
+        planes[i] /= glm::length(glm::vec3(planes[i]));
+    }
+}
+
+enum class FrustumTest
+{
+    Outside,
+    Intersecting,
+    Inside
+};
+
+static FrustumTest testFrustumBox(const glm::vec4 planes[6], const BoundingBox& box)
+{
+    FrustumTest result = FrustumTest::Inside;
+
+    for (int i = 0; i < 6; i++)
+    {
+        const glm::vec3 normal(planes[i]);
+
+        // corners of the box furthest along and against the plane's normal
+        glm::vec3 furthest(normal.x >= 0.f ? box.max.x : box.min.x, normal.y >= 0.f ? box.max.y : box.min.y, normal.z >= 0.f ? box.max.z : box.min.z);
+        glm::vec3 nearest(normal.x >= 0.f ? box.min.x : box.max.x, normal.y >= 0.f ? box.min.y : box.max.y, normal.z >= 0.f ? box.min.z : box.max.z);
+
+        if(glm::dot(normal, furthest) + planes[i].w < 0.f)
+        {
+            return FrustumTest::Outside;
+        }
+        if(glm::dot(normal, nearest) + planes[i].w < 0.f)
+        {
+            result = FrustumTest::Intersecting;
+        }
+    }
+
+    return result;
+}
+
+void cullSegmentBvh(const SegmentBvh& bvh, const glm::vec4 planes[6], std::vector<unsigned int>& segments)
+{
+    if(bvh.nodes.empty())
+    {
+        return;
+    }
+
+    unsigned int stack[BVH_MAX_DEPTH + 1];
+    size_t stackSize = 0;
+    stack[stackSize++] = 0;
+
+    while(stackSize > 0)
+    {
+        const unsigned int nodeIndex = stack[--stackSize];
+        const BvhNode& node = bvh.nodes[nodeIndex];
+
+        FrustumTest test = testFrustumBox(planes, node.bounds);
+        if(test == FrustumTest::Outside)
+        {
+            continue;
+        }
+
+        if(node.segmentCount > 0)
+        {
+            segments.insert(segments.end(), bvh.segments.begin() + node.offset, bvh.segments.begin() + node.offset + node.segmentCount);
+        }
+        else if(test == FrustumTest::Inside)
+        {
+            // the whole subtree is visible, so just collect all leaves without any further tests;
+            // subtree's nodes take up a contiguous range, which ends where the next sibling of any ancestor begins
+            size_t end = stackSize > 0 ? stack[stackSize - 1] : bvh.nodes.size();
+            for (size_t i = nodeIndex + 1; i < end && i < bvh.nodes.size(); i++)
+            {
+                const BvhNode& child = bvh.nodes[i];
+                if(child.segmentCount > 0)
+                {
+                    segments.insert(segments.end(), bvh.segments.begin() + child.offset, bvh.segments.begin() + child.offset + child.segmentCount);
+                }
+            }
+        }
+        else
+        {
+            stack[stackSize++] = node.offset;
+            stack[stackSize++] = nodeIndex + 1;
+        }
+    }
+}
+
+
+
+// Möller-Trumbore, returns distance along the ray or a negative value if the triangle is missed
+static float intersectRayTriangle(glm::vec3 origin, glm::vec3 direction, glm::vec3 a, glm::vec3 b, glm::vec3 c)
+{
+    const glm::vec3 edge1 = b - a;
+    const glm::vec3 edge2 = c - a;
+    const glm::vec3 p = glm::cross(direction, edge2);
+    const float det = glm::dot(edge1, p);
+
+    if(std::abs(det) < 1e-12f)
+    {
+        return -1.f;
+    }
+
+    const float invDet = 1.f / det;
+    const glm::vec3 s = origin - a;
+    const float u = glm::dot(s, p) * invDet;
+    if(u < 0.f || u > 1.f)
+    {
+        return -1.f;
+    }
+
+    const glm::vec3 q = glm::cross(s, edge1);
+    const float v = glm::dot(direction, q) * invDet;
+    if(v < 0.f || u + v > 1.f)
+    {
+        return -1.f;
+    }
+
+    return glm::dot(edge2, q) * invDet;
+}
+
+bool pickCurveMesh(const CurveMeshData& mesh, const SegmentBvh& bvh, glm::vec3 origin, glm::vec3 direction, CurveMeshHit& hit)
+{
+    if(mesh.segmentIndexCount == 0 || mesh.segmentBounds.empty())
+    {
+        return false;
+    }
+
+    const size_t segmentIndexCount = mesh.segmentIndexCount;
+    const size_t tubeIndexCount = mesh.segmentBounds.size() * segmentIndexCount;
+    const size_t lastSegment = mesh.segmentBounds.size() - 1;
+
+    bool found = false;
+
+    auto testTriangles = [&](unsigned int segment, size_t firstIndex, size_t lastIndex, float& maxDistance) {
+        for (size_t k = firstIndex; k < lastIndex; k += 3)
+        {
+            float t = intersectRayTriangle(origin, direction,
+                mesh.vertices[mesh.indices[k]], mesh.vertices[mesh.indices[k + 1]], mesh.vertices[mesh.indices[k + 2]]);
+
+            if(t >= 0.f && t < maxDistance)
+            {
+                maxDistance = t;
+                hit = {segment, (unsigned int)(k / 3), t, origin + direction * t};
+                found = true;
+            }
+        }
+    };
+
+    traverseRay(bvh, origin, direction, std::numeric_limits<float>::max(), [&](const BvhNode& leaf, float maxDistance) {
+        for (unsigned int i = leaf.offset; i < leaf.offset + leaf.segmentCount; i++)
+        {
+            const unsigned int segment = bvh.segments[i];
+            testTriangles(segment, segment * segmentIndexCount, (segment + 1) * segmentIndexCount, maxDistance);
+
+            // caps are stored after the tube and lie within the bounds of the first and last segment
+            if(segment == 0 || segment == lastSegment)
+            {
+                testTriangles(segment, tubeIndexCount, mesh.indices.size(), maxDistance);
+            }
+        }
+
+        return maxDistance;
+    });
+
+    return found;
+}
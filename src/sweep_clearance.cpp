@@ -0,0 +1,451 @@
+#include "sweep_clearance.hpp"
+
+#include "bounding_box.hpp"
+#include "parallel_for.hpp"
+
+#include <glm/gtc/constants.hpp>
+
+#include <algorithm> // std::sort, std::unique, std::nth_element, std::max, std::min
+#include <cmath>
+#include <cstdio>
+#include <mutex>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+
+const size_t MIN_BOXES_PER_THREAD = 4096;
+const size_t MIN_SWEEPS_PER_THREAD = 256;
+
+
+// closest points of two segments, from Ericson's Real-Time Collision Detection
+static float segmentDistanceSquared(const glm::vec3& p1, const glm::vec3& q1, const glm::vec3& p2, const glm::vec3& q2)
+{
+    const float EPSILON = 1e-12f;
+
+    const glm::vec3 d1 = q1 - p1;
+    const glm::vec3 d2 = q2 - p2;
+    const glm::vec3 r = p1 - p2;
+    const float a = glm::dot(d1, d1);
+    const float e = glm::dot(d2, d2);
+    const float f = glm::dot(d2, r);
+
+    float s, t;
+    if(a <= EPSILON && e <= EPSILON)
+    {
+        return glm::dot(r, r);
+    }
+    if(a <= EPSILON)
+    {
+        s = 0.f;
+        t = glm::clamp(f / e, 0.f, 1.f);
+    }
+    else
+    {
+        const float c = glm::dot(d1, r);
+        if(e <= EPSILON)
+        {
+            t = 0.f;
+            s = glm::clamp(-c / a, 0.f, 1.f);
+        }
+        else
+        {
+            const float b = glm::dot(d1, d2);
+            const float denom = a * e - b * b;
+
+            // parallel segments have no single closest pair, any s works
+            s = denom > 0.f ? glm::clamp((b * f - c * e) / denom, 0.f, 1.f) : 0.f;
+            t = (b * s + f) / e;
+
+            if(t < 0.f)
+            {
+                t = 0.f;
+                s = glm::clamp(-c / a, 0.f, 1.f);
+            }
+            else if(t > 1.f)
+            {
+                t = 1.f;
+                s = glm::clamp((b - c) / a, 0.f, 1.f);
+            }
+        }
+    }
+
+    const glm::vec3 closest = r + d1 * s - d2 * t;
+    return glm::dot(closest, closest);
+}
+
+float capsuleDistance(const Capsule& c0, const Capsule& c1)
+{
+    return std::sqrt(segmentDistanceSquared(c0.a, c0.b, c1.a, c1.b)) - c0.radius - c1.radius;
+}
+
+template<typename T>
+std::vector<Capsule> makeSweepCapsules(const std::vector<glm::vec2>& profile, const std::vector<ExtrusionPointT<T>>& extrusionPoints, const glm::vec<3, T>& origin)
+{
+    std::vector<Capsule> capsules;
+
+    if(extrusionPoints.size() < 2)
+    {
+        printf("[ERROR][%s(%d)] Not enough points to make a sweep\n", __FILE__, __LINE__);
+        return capsules;
+    }
+
+    float profileRadius = 0.f;
+    for(const auto& vertex : profile)
+    {
+        profileRadius = std::max(profileRadius, glm::length(vertex));
+    }
+
+    capsules.resize(extrusionPoints.size() - 1);
+    for (size_t i = 0; i < capsules.size(); i++)
+    {
+        const ExtrusionPointT<T>& ep0 = extrusionPoints[i];
+        const ExtrusionPointT<T>& ep1 = extrusionPoints[i + 1];
+
+        capsules[i].a = glm::vec3(ep0.position - origin);
+        capsules[i].b = glm::vec3(ep1.position - origin);
+        capsules[i].radius = profileRadius * std::max(std::abs(ep0.scale), std::abs(ep1.scale));
+    }
+
+    return capsules;
+}
+
+
+
+// ============= CHECK ============= //
+
+static const unsigned int NO_BUCKET = ~0u;
+
+static glm::ivec3 cellOf(const glm::vec3& point, float cellSize)
+{
+    return glm::ivec3(glm::floor(point / cellSize));
+}
+
+// half of the physical memory, or 2 GB where the platform doesn't tell
+static size_t defaultMemoryLimit()
+{
+#if defined(__unix__) || defined(__APPLE__)
+    const long pages = sysconf(_SC_PHYS_PAGES);
+    const long pageSize = sysconf(_SC_PAGE_SIZE);
+    if(pages > 0 && pageSize > 0)
+    {
+        return size_t(pages) / 2 * size_t(pageSize);
+    }
+#endif
+    return size_t(1) << 31;
+}
+
+static unsigned int cellBucket(const glm::ivec3& cell, unsigned int bucketMask)
+{
+    return ((unsigned int)cell.x * 73856093u ^ (unsigned int)cell.y * 19349663u ^ (unsigned int)cell.z * 83492791u) & bucketMask;
+}
+
+ClearanceReport checkSweepClearance(const std::vector<std::vector<Capsule>>& sweeps, const ClearanceOptions& options)
+{
+    ClearanceReport report;
+
+    const float clearance = std::max(options.clearance, 0.f);
+
+    // capsules of all sweeps are numbered one after another
+    std::vector<size_t> firstCapsule(sweeps.size() + 1, 0);
+    for (size_t s = 0; s < sweeps.size(); s++)
+    {
+        firstCapsule[s + 1] = firstCapsule[s] + sweeps[s].size();
+    }
+
+    const size_t capsuleCount = firstCapsule.back();
+    if(capsuleCount >= UINT32_MAX)
+    {
+        printf("[ERROR][%s(%d)] Too many segments to check at once\n", __FILE__, __LINE__);
+        report.complete = false;
+        return report;
+    }
+
+    std::vector<unsigned int> capsuleSweep(capsuleCount);
+    // distance along the sweep to the start of the capsule
+    std::vector<float> arcStart(capsuleCount);
+    std::vector<BoundingBox> boxes(capsuleCount);
+
+    std::mutex reportMutex;
+
+    parallelFor(sweeps.size(), MIN_SWEEPS_PER_THREAD, [&](size_t begin, size_t end) {
+        std::vector<TightBend> tightBends;
+
+        for (size_t s = begin; s < end; s++)
+        {
+            const std::vector<Capsule>& capsules = sweeps[s];
+
+            float arc = 0.f;
+            for (size_t k = 0; k < capsules.size(); k++)
+            {
+                const Capsule& c = capsules[k];
+                const size_t g = firstCapsule[s] + k;
+
+                // boxes are grown by half of the clearance on each side, so capsules that are too close have overlapping boxes
+                const glm::vec3 margin(c.radius + clearance * 0.5f);
+                boxes[g].min = glm::min(c.a, c.b) - margin;
+                boxes[g].max = glm::max(c.a, c.b) + margin;
+                capsuleSweep[g] = s;
+                arcStart[g] = arc;
+                arc += glm::length(c.b - c.a);
+
+                // radius of the circle through the previous, this and the next ring center
+                if(options.checkSelf && k > 0)
+                {
+                    const glm::vec3 p0 = capsules[k - 1].a;
+                    const glm::vec3 p1 = c.a;
+                    const glm::vec3 p2 = c.b;
+                    const float doubleArea = glm::length(glm::cross(p1 - p0, p2 - p0));
+                    const float profileRadius = std::min(capsules[k - 1].radius, c.radius);
+
+                    if(doubleArea > 0.f)
+                    {
+                        const float bendRadius = glm::length(p1 - p0) * glm::length(p2 - p1) * glm::length(p2 - p0) / (2.f * doubleArea);
+                        if(bendRadius < profileRadius)
+                        {
+                            tightBends.push_back({(unsigned int)s, (unsigned int)k, bendRadius, profileRadius});
+                        }
+                    }
+                }
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(reportMutex);
+        report.tightBends.insert(report.tightBends.end(), tightBends.begin(), tightBends.end());
+    });
+
+    auto capsuleAt = [&](size_t g) -> const Capsule& {
+        const unsigned int s = capsuleSweep[g];
+        return sweeps[s][g - firstCapsule[s]];
+    };
+
+    // ============= BROAD PHASE ============= //
+    // Capsules are split into pieces no longer than a cell, and the boxes of the pieces go into the buckets of a hash table
+    // of grid cells, one entry for every cell they overlap. A long diagonal capsule then costs entries in proportion to its length,
+    // not to the volume of its box. Cells are twice as big as the median capsule box, so that a few long or fat capsules
+    // don't make them coarse for all the others, and most pieces land in a few cells.
+    std::vector<float> extents(capsuleCount);
+    for (size_t g = 0; g < capsuleCount; g++)
+    {
+        const glm::vec3 extent = boxes[g].max - boxes[g].min;
+        extents[g] = std::max(extent.x, std::max(extent.y, extent.z));
+    }
+    float cellSize = 1.f;
+    if(capsuleCount > 0)
+    {
+        std::nth_element(extents.begin(), extents.begin() + capsuleCount / 2, extents.end());
+        const float medianExtent = extents[capsuleCount / 2];
+        const float maxExtent = *std::max_element(extents.begin(), extents.end());
+        cellSize = medianExtent > 0.f ? 2.f * medianExtent : (maxExtent > 0.f ? 2.f * maxExtent : 1.f);
+    }
+    std::vector<float>().swap(extents);
+
+    // pieces of every capsule, counted in double so that absurdly long capsules can't overflow the count
+    std::vector<size_t> firstPiece(capsuleCount + 1, 0);
+    for (size_t g = 0; g < capsuleCount; g++)
+    {
+        const Capsule& c = capsuleAt(g);
+        const double pieceCount = std::max(std::ceil(double(glm::length(c.b - c.a)) / double(cellSize)), 1.0);
+        if(!(pieceCount < double(UINT32_MAX)))
+        {
+            printf("[ERROR][%s(%d)] Segments are too long for the grid\n", __FILE__, __LINE__);
+            report.complete = false;
+            return report;
+        }
+        firstPiece[g + 1] = firstPiece[g] + size_t(pieceCount);
+    }
+    const size_t pieceCount = firstPiece.back();
+
+    std::vector<unsigned int> pieceCapsule(pieceCount);
+    std::vector<BoundingBox> pieceBoxes(pieceCount);
+    parallelFor(capsuleCount, MIN_BOXES_PER_THREAD, [&](size_t begin, size_t end) {
+        for (size_t g = begin; g < end; g++)
+        {
+            const Capsule& c = capsuleAt(g);
+            const glm::vec3 margin(c.radius + clearance * 0.5f);
+            const size_t count = firstPiece[g + 1] - firstPiece[g];
+            for (size_t k = 0; k < count; k++)
+            {
+                const glm::vec3 a = c.a + (c.b - c.a) * (float(k) / float(count));
+                const glm::vec3 b = k + 1 < count ? c.a + (c.b - c.a) * (float(k + 1) / float(count)) : c.b;
+                pieceCapsule[firstPiece[g] + k] = g;
+                pieceBoxes[firstPiece[g] + k].min = glm::min(a, b) - margin;
+                pieceBoxes[firstPiece[g] + k].max = glm::max(a, b) + margin;
+            }
+        }
+    });
+
+    // every piece has a slot for each cell it overlaps, slots of cells that share a bucket with an earlier one stay empty
+    std::vector<size_t> firstEntry(pieceCount + 1, 0);
+    for (size_t p = 0; p < pieceCount; p++)
+    {
+        const glm::vec3 cellCount = glm::floor(pieceBoxes[p].max / cellSize) - glm::floor(pieceBoxes[p].min / cellSize) + 1.f;
+        const double entryCount = double(cellCount.x) * double(cellCount.y) * double(cellCount.z);
+        if(!(entryCount < double(UINT32_MAX)))
+        {
+            printf("[ERROR][%s(%d)] Segments are too big for the grid\n", __FILE__, __LINE__);
+            report.complete = false;
+            return report;
+        }
+        firstEntry[p + 1] = firstEntry[p] + size_t(entryCount);
+    }
+
+    // Every entry takes a slot, a place in the sorted entries and, through the buckets, about one more counter;
+    // the check gives up rather than run out of memory.
+    const size_t entryCount = firstEntry.back();
+    const size_t memoryLimit = options.memoryLimit > 0 ? options.memoryLimit : defaultMemoryLimit();
+    if(entryCount >= UINT32_MAX || pieceCount >= UINT32_MAX || entryCount > memoryLimit / (3 * sizeof(unsigned int)))
+    {
+        printf("[ERROR][%s(%d)] Segments are too big for the grid, %zu cells would take more than %zu bytes\n", __FILE__, __LINE__, entryCount, memoryLimit);
+        report.complete = false;
+        return report;
+    }
+
+    unsigned int bucketCount = 1;
+    while(bucketCount < entryCount && bucketCount < (1u << 31))
+    {
+        bucketCount <<= 1;
+    }
+    const unsigned int bucketMask = bucketCount - 1;
+
+    std::vector<unsigned int> entryBucket(entryCount);
+    parallelFor(pieceCount, MIN_BOXES_PER_THREAD, [&](size_t begin, size_t end) {
+        for (size_t p = begin; p < end; p++)
+        {
+            const glm::ivec3 minCell = cellOf(pieceBoxes[p].min, cellSize);
+            const glm::ivec3 maxCell = cellOf(pieceBoxes[p].max, cellSize);
+
+            unsigned int *buckets = &entryBucket[firstEntry[p]];
+            const size_t slotCount = firstEntry[p + 1] - firstEntry[p];
+            size_t count = 0;
+            for (int z = minCell.z; z <= maxCell.z; z++)
+            {
+                for (int y = minCell.y; y <= maxCell.y; y++)
+                {
+                    for (int x = minCell.x; x <= maxCell.x; x++)
+                    {
+                        buckets[count++] = cellBucket(glm::ivec3(x, y, z), bucketMask);
+                    }
+                }
+            }
+
+            std::sort(buckets, buckets + slotCount);
+            count = std::unique(buckets, buckets + slotCount) - buckets;
+            std::fill(buckets + count, buckets + slotCount, NO_BUCKET);
+        }
+    });
+
+    // counting sort of the pieces by bucket
+    std::vector<unsigned int> bucketStart(size_t(bucketCount) + 1, 0);
+    for(unsigned int bucket : entryBucket)
+    {
+        if(bucket != NO_BUCKET)
+        {
+            bucketStart[bucket + 1]++;
+        }
+    }
+    for (size_t b = 0; b < bucketCount; b++)
+    {
+        bucketStart[b + 1] += bucketStart[b];
+    }
+
+    std::vector<unsigned int> bucketPieces(bucketStart.back());
+    {
+        std::vector<unsigned int> cursor(bucketStart.begin(), bucketStart.end() - 1);
+        for (size_t p = 0; p < pieceCount; p++)
+        {
+            for (size_t e = firstEntry[p]; e < firstEntry[p + 1] && entryBucket[e] != NO_BUCKET; e++)
+            {
+                bucketPieces[cursor[entryBucket[e]]++] = p;
+            }
+        }
+    }
+
+    // the slots aren't needed anymore and can take a lot of memory
+    std::vector<unsigned int>().swap(entryBucket);
+
+    // ============= NARROW PHASE ============= //
+    parallelFor(bucketCount, MIN_BOXES_PER_THREAD, [&](size_t begin, size_t end) {
+        std::vector<ClearanceViolation> violations;
+
+        for (size_t b = begin; b < end; b++)
+        {
+            for (size_t i = bucketStart[b]; i < bucketStart[b + 1]; i++)
+            {
+                for (size_t j = i + 1; j < bucketStart[b + 1]; j++)
+                {
+                    const unsigned int p0 = bucketPieces[i];
+                    const unsigned int p1 = bucketPieces[j];
+                    const BoundingBox& box0 = pieceBoxes[p0];
+                    const BoundingBox& box1 = pieceBoxes[p1];
+                    const unsigned int g0 = std::min(pieceCapsule[p0], pieceCapsule[p1]);
+                    const unsigned int g1 = std::max(pieceCapsule[p0], pieceCapsule[p1]);
+
+                    if(g0 == g1 || !boundingBoxesOverlap(box0, box1))
+                    {
+                        continue;
+                    }
+
+                    // Boxes that overlap share many cells, the pair is only tested in the bucket of the cell their overlap starts in.
+                    // That cell is in both boxes, so both are in its bucket.
+                    if(cellBucket(cellOf(glm::max(box0.min, box1.min), cellSize), bucketMask) != b)
+                    {
+                        continue;
+                    }
+
+                    const unsigned int s0 = capsuleSweep[g0];
+                    const unsigned int s1 = capsuleSweep[g1];
+                    const Capsule& c0 = capsuleAt(g0);
+                    const Capsule& c1 = capsuleAt(g1);
+
+                    if(s0 == s1)
+                    {
+                        if(!options.checkSelf)
+                        {
+                            continue;
+                        }
+
+                        // On a bend with a radius of at least the profile's, surfaces of segments this far apart along the sweep
+                        // can't come closer than the clearance, while nearer ones touch.
+                        const float gap = arcStart[g1] - arcStart[g0 + 1];
+                        if(gap < glm::pi<float>() * (std::max(c0.radius, c1.radius) + clearance * 0.5f))
+                        {
+                            continue;
+                        }
+                    }
+
+                    const float distance = capsuleDistance(c0, c1);
+                    if(distance < clearance)
+                    {
+                        violations.push_back({s0, (unsigned int)(g0 - firstCapsule[s0]), s1, (unsigned int)(g1 - firstCapsule[s1]), distance});
+                    }
+                }
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(reportMutex);
+        report.violations.insert(report.violations.end(), violations.begin(), violations.end());
+    });
+
+    // threads finish in any order, and long capsules are found once for every pair of their pieces that come close
+    std::sort(report.violations.begin(), report.violations.end(), [](const ClearanceViolation& v0, const ClearanceViolation& v1) {
+        if(v0.sweepA != v1.sweepA) return v0.sweepA < v1.sweepA;
+        if(v0.segmentA != v1.segmentA) return v0.segmentA < v1.segmentA;
+        if(v0.sweepB != v1.sweepB) return v0.sweepB < v1.sweepB;
+        return v0.segmentB < v1.segmentB;
+    });
+    report.violations.erase(std::unique(report.violations.begin(), report.violations.end(), [](const ClearanceViolation& v0, const ClearanceViolation& v1) {
+        return v0.sweepA == v1.sweepA && v0.segmentA == v1.segmentA && v0.sweepB == v1.sweepB && v0.segmentB == v1.segmentB;
+    }), report.violations.end());
+    std::sort(report.tightBends.begin(), report.tightBends.end(), [](const TightBend& b0, const TightBend& b1) {
+        return b0.sweep != b1.sweep ? b0.sweep < b1.sweep : b0.point < b1.point;
+    });
+
+    return report;
+}
+
+
+
+template std::vector<Capsule> makeSweepCapsules(const std::vector<glm::vec2>&, const std::vector<ExtrusionPointT<float>>&, const glm::vec<3, float>&);
+template std::vector<Capsule> makeSweepCapsules(const std::vector<glm::vec2>&, const std::vector<ExtrusionPointT<double>>&, const glm::vec<3, double>&);
@@ -0,0 +1,577 @@
+#include "sweep_sdf.hpp"
+
+#include "parallel_for.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SWEEP_SDF_HAS_AVX2
+#include <immintrin.h>
+#endif
+
+#include <algorithm> // std::sort, std::lower_bound, std::min, std::max
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <utility>
+
+
+const size_t MIN_BLOCKS_PER_THREAD = 8;
+
+
+// Profile polygon prepared for distance queries, edge `i` goes from vertex `i` back to the previous vertex.
+// Kept as separate arrays, like ProfileSoA, so that the edges can be broadcast one by one to wide registers.
+struct SdfProfile
+{
+    std::vector<float> ax, ay;
+    std::vector<float> ex, ey;
+    // y of the vertex the edge ends at
+    std::vector<float> by;
+    std::vector<float> invLengthSquared;
+};
+
+// a segment between two rings, with the frame interpolated as `right + rightDelta * t`, like the mesh surface is
+struct SdfSegment
+{
+    glm::vec3 start;
+    glm::vec3 axis;
+    float invAxisLengthSquared;
+    glm::vec3 end;
+    glm::vec3 right, rightDelta;
+    glm::vec3 up, upDelta;
+    // normals of the ring planes at both ends, pointing along the sweep
+    glm::vec3 startNormal, endNormal;
+    // 0 where the end is the capped end of the sweep, -FLT_MAX where it joins the next segment
+    float startCapBias, endCapBias;
+    unsigned int sweep;
+};
+
+static SdfProfile makeSdfProfile(const std::vector<glm::vec2>& profile)
+{
+    SdfProfile soa;
+    for (size_t i = 0; i < profile.size(); i++)
+    {
+        const glm::vec2& a = profile[i];
+        const glm::vec2& b = profile[(i + profile.size() - 1) % profile.size()];
+        const glm::vec2 e = b - a;
+        const float lengthSquared = glm::dot(e, e);
+
+        soa.ax.push_back(a.x);
+        soa.ay.push_back(a.y);
+        soa.ex.push_back(e.x);
+        soa.ey.push_back(e.y);
+        soa.by.push_back(b.y);
+        soa.invLengthSquared.push_back(lengthSquared > 0.f ? 1.f / lengthSquared : 0.f);
+    }
+    return soa;
+}
+
+template<typename T>
+SweepSdfSource makeSweepSdfSource(const std::vector<glm::vec2>& profile, const std::vector<ExtrusionPointT<T>>& extrusionPoints, const glm::vec<3, T>& origin)
+{
+    SweepSdfSource source;
+    source.profile = profile;
+    source.frames.resize(extrusionPoints.size());
+    for (size_t i = 0; i < extrusionPoints.size(); i++)
+    {
+        source.frames[i] = computeRingFrame(extrusionPoints[i], origin);
+    }
+    return source;
+}
+
+
+
+// ============= KERNELS ============= //
+// Both measure the signed distance of `count` points to one segment, negative inside it, and keep the smaller of it and `distances`.
+// The minimum over all segments is the distance to the surface of their union, wherever the segments overlap.
+// The surface of a segment is the tube between its two rings, plus the flat caps at the ends of the sweep;
+// where the segment joins its neighbour the ring planes only bound the volume, so they don't show up as surfaces inside the sweep.
+
+static void bakeSegmentScalar(const SdfSegment& s, const SdfProfile& profile, const float *px, const float *py, const float *pz, size_t count, float *distances)
+{
+    for (size_t v = 0; v < count; v++)
+    {
+        const glm::vec3 p(px[v], py[v], pz[v]);
+        const glm::vec3 w = p - s.start;
+
+        // profile plane through the closest point of the axis
+        const float t = glm::clamp(glm::dot(w, s.axis) * s.invAxisLengthSquared, 0.f, 1.f);
+        const glm::vec3 q = w - s.axis * t;
+        const glm::vec3 right = s.right + s.rightDelta * t;
+        const glm::vec3 up = s.up + s.upDelta * t;
+        const float rightSquared = glm::dot(right, right);
+        const float x = glm::dot(q, right) / rightSquared;
+        const float y = glm::dot(q, up) / glm::dot(up, up);
+
+        // distance to the polygon, negative inside, counted with crossings of a ray along +x
+        float distanceSquared = std::numeric_limits<float>::max();
+        bool inside = false;
+        for (size_t e = 0; e < profile.ax.size(); e++)
+        {
+            const float wx = x - profile.ax[e];
+            const float wy = y - profile.ay[e];
+            const float h = glm::clamp((wx * profile.ex[e] + wy * profile.ey[e]) * profile.invLengthSquared[e], 0.f, 1.f);
+            const float dx = wx - profile.ex[e] * h;
+            const float dy = wy - profile.ey[e] * h;
+            distanceSquared = std::min(distanceSquared, dx * dx + dy * dy);
+
+            const bool c1 = y >= profile.ay[e];
+            const bool c2 = y < profile.by[e];
+            const bool c3 = profile.ex[e] * wy > profile.ey[e] * wx;
+            if(c1 == c2 && c2 == c3)
+            {
+                inside = !inside;
+            }
+        }
+        const float profileDistance = (inside ? -std::sqrt(distanceSquared) : std::sqrt(distanceSquared)) * std::sqrt(rightSquared);
+
+        // how far the point is past the ring planes
+        const float startPlane = -glm::dot(w, s.startNormal);
+        const float endPlane = glm::dot(p - s.end, s.endNormal);
+        const float planeDistance = std::max(startPlane, endPlane);
+        const float capPlane = std::max(startPlane + s.startCapBias, endPlane + s.endCapBias);
+
+        const float tubeDistance = planeDistance > 0.f ? std::sqrt(profileDistance * profileDistance + planeDistance * planeDistance) : std::abs(profileDistance);
+        const float capDistance = profileDistance <= 0.f ? std::abs(capPlane) : std::numeric_limits<float>::max();
+
+        const float distance = std::min(tubeDistance, capDistance);
+        distances[v] = std::min(distances[v], profileDistance < 0.f && planeDistance <= 0.f ? -distance : distance);
+    }
+}
+
+#ifdef SWEEP_SDF_HAS_AVX2
+
+__attribute__((target("avx2,fma")))
+static void bakeSegmentAVX2(const SdfSegment& s, const SdfProfile& profile, const float *px, const float *py, const float *pz, size_t count, float *distances)
+{
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.f);
+    const __m256 signBit = _mm256_set1_ps(-0.f);
+    const __m256 maxFloat = _mm256_set1_ps(std::numeric_limits<float>::max());
+
+    const __m256 sx = _mm256_set1_ps(s.start.x), sy = _mm256_set1_ps(s.start.y), sz = _mm256_set1_ps(s.start.z);
+    const __m256 ax = _mm256_set1_ps(s.axis.x), ay = _mm256_set1_ps(s.axis.y), az = _mm256_set1_ps(s.axis.z);
+    const __m256 invAxis = _mm256_set1_ps(s.invAxisLengthSquared);
+    const __m256 ex = _mm256_set1_ps(s.end.x), ey = _mm256_set1_ps(s.end.y), ez = _mm256_set1_ps(s.end.z);
+    const __m256 rx = _mm256_set1_ps(s.right.x), ry = _mm256_set1_ps(s.right.y), rz = _mm256_set1_ps(s.right.z);
+    const __m256 rdx = _mm256_set1_ps(s.rightDelta.x), rdy = _mm256_set1_ps(s.rightDelta.y), rdz = _mm256_set1_ps(s.rightDelta.z);
+    const __m256 ux = _mm256_set1_ps(s.up.x), uy = _mm256_set1_ps(s.up.y), uz = _mm256_set1_ps(s.up.z);
+    const __m256 udx = _mm256_set1_ps(s.upDelta.x), udy = _mm256_set1_ps(s.upDelta.y), udz = _mm256_set1_ps(s.upDelta.z);
+    const __m256 n0x = _mm256_set1_ps(s.startNormal.x), n0y = _mm256_set1_ps(s.startNormal.y), n0z = _mm256_set1_ps(s.startNormal.z);
+    const __m256 n1x = _mm256_set1_ps(s.endNormal.x), n1y = _mm256_set1_ps(s.endNormal.y), n1z = _mm256_set1_ps(s.endNormal.z);
+    const __m256 startCapBias = _mm256_set1_ps(s.startCapBias);
+    const __m256 endCapBias = _mm256_set1_ps(s.endCapBias);
+
+    size_t v = 0;
+    for (; v + 8 <= count; v += 8)
+    {
+        const __m256 pxv = _mm256_loadu_ps(px + v);
+        const __m256 pyv = _mm256_loadu_ps(py + v);
+        const __m256 pzv = _mm256_loadu_ps(pz + v);
+
+        const __m256 wx = _mm256_sub_ps(pxv, sx);
+        const __m256 wy = _mm256_sub_ps(pyv, sy);
+        const __m256 wz = _mm256_sub_ps(pzv, sz);
+
+        __m256 t = _mm256_mul_ps(_mm256_fmadd_ps(wx, ax, _mm256_fmadd_ps(wy, ay, _mm256_mul_ps(wz, az))), invAxis);
+        t = _mm256_min_ps(_mm256_max_ps(t, zero), one);
+
+        const __m256 qx = _mm256_fnmadd_ps(ax, t, wx);
+        const __m256 qy = _mm256_fnmadd_ps(ay, t, wy);
+        const __m256 qz = _mm256_fnmadd_ps(az, t, wz);
+        const __m256 Rx = _mm256_fmadd_ps(rdx, t, rx);
+        const __m256 Ry = _mm256_fmadd_ps(rdy, t, ry);
+        const __m256 Rz = _mm256_fmadd_ps(rdz, t, rz);
+        const __m256 Ux = _mm256_fmadd_ps(udx, t, ux);
+        const __m256 Uy = _mm256_fmadd_ps(udy, t, uy);
+        const __m256 Uz = _mm256_fmadd_ps(udz, t, uz);
+
+        const __m256 rightSquared = _mm256_fmadd_ps(Rx, Rx, _mm256_fmadd_ps(Ry, Ry, _mm256_mul_ps(Rz, Rz)));
+        const __m256 upSquared = _mm256_fmadd_ps(Ux, Ux, _mm256_fmadd_ps(Uy, Uy, _mm256_mul_ps(Uz, Uz)));
+        const __m256 x = _mm256_div_ps(_mm256_fmadd_ps(qx, Rx, _mm256_fmadd_ps(qy, Ry, _mm256_mul_ps(qz, Rz))), rightSquared);
+        const __m256 y = _mm256_div_ps(_mm256_fmadd_ps(qx, Ux, _mm256_fmadd_ps(qy, Uy, _mm256_mul_ps(qz, Uz))), upSquared);
+
+        __m256 distanceSquared = maxFloat;
+        __m256 sign = zero;
+        for (size_t e = 0; e < profile.ax.size(); e++)
+        {
+            const __m256 pax = _mm256_set1_ps(profile.ax[e]);
+            const __m256 pay = _mm256_set1_ps(profile.ay[e]);
+            const __m256 pex = _mm256_set1_ps(profile.ex[e]);
+            const __m256 pey = _mm256_set1_ps(profile.ey[e]);
+
+            const __m256 ewx = _mm256_sub_ps(x, pax);
+            const __m256 ewy = _mm256_sub_ps(y, pay);
+            __m256 h = _mm256_mul_ps(_mm256_fmadd_ps(ewx, pex, _mm256_mul_ps(ewy, pey)), _mm256_set1_ps(profile.invLengthSquared[e]));
+            h = _mm256_min_ps(_mm256_max_ps(h, zero), one);
+            const __m256 dx = _mm256_fnmadd_ps(pex, h, ewx);
+            const __m256 dy = _mm256_fnmadd_ps(pey, h, ewy);
+            distanceSquared = _mm256_min_ps(distanceSquared, _mm256_fmadd_ps(dx, dx, _mm256_mul_ps(dy, dy)));
+
+            // the sign flips where all three conditions agree
+            const __m256 c1 = _mm256_cmp_ps(y, pay, _CMP_GE_OQ);
+            const __m256 c2 = _mm256_cmp_ps(y, _mm256_set1_ps(profile.by[e]), _CMP_LT_OQ);
+            const __m256 c3 = _mm256_cmp_ps(_mm256_mul_ps(pex, ewy), _mm256_mul_ps(pey, ewx), _CMP_GT_OQ);
+            const __m256 disagree = _mm256_or_ps(_mm256_xor_ps(c1, c2), _mm256_xor_ps(c2, c3));
+            sign = _mm256_xor_ps(sign, _mm256_andnot_ps(disagree, signBit));
+        }
+        const __m256 profileDistance = _mm256_mul_ps(_mm256_xor_ps(_mm256_sqrt_ps(distanceSquared), sign), _mm256_sqrt_ps(rightSquared));
+
+        const __m256 startPlane = _mm256_fnmadd_ps(wx, n0x, _mm256_fnmadd_ps(wy, n0y, _mm256_mul_ps(_mm256_sub_ps(zero, wz), n0z)));
+        const __m256 endPlane = _mm256_fmadd_ps(_mm256_sub_ps(pxv, ex), n1x, _mm256_fmadd_ps(_mm256_sub_ps(pyv, ey), n1y, _mm256_mul_ps(_mm256_sub_ps(pzv, ez), n1z)));
+        const __m256 planeDistance = _mm256_max_ps(startPlane, endPlane);
+        const __m256 capPlane = _mm256_max_ps(_mm256_add_ps(startPlane, startCapBias), _mm256_add_ps(endPlane, endCapBias));
+
+        const __m256 absProfileDistance = _mm256_andnot_ps(signBit, profileDistance);
+        const __m256 pastPlanes = _mm256_cmp_ps(planeDistance, zero, _CMP_GT_OQ);
+        const __m256 slanted = _mm256_sqrt_ps(_mm256_fmadd_ps(profileDistance, profileDistance, _mm256_mul_ps(planeDistance, planeDistance)));
+        const __m256 tubeDistance = _mm256_blendv_ps(absProfileDistance, slanted, pastPlanes);
+
+        const __m256 insideProfile = _mm256_cmp_ps(profileDistance, zero, _CMP_LE_OQ);
+        const __m256 capDistance = _mm256_blendv_ps(maxFloat, _mm256_andnot_ps(signBit, capPlane), insideProfile);
+
+        const __m256 inside = _mm256_andnot_ps(pastPlanes, _mm256_cmp_ps(profileDistance, zero, _CMP_LT_OQ));
+        const __m256 distance = _mm256_xor_ps(_mm256_min_ps(tubeDistance, capDistance), _mm256_and_ps(inside, signBit));
+        _mm256_storeu_ps(distances + v, _mm256_min_ps(_mm256_loadu_ps(distances + v), distance));
+    }
+
+    bakeSegmentScalar(s, profile, px + v, py + v, pz + v, count - v, distances + v);
+}
+
+#endif // SWEEP_SDF_HAS_AVX2
+
+typedef void (*SdfSegmentKernel)(const SdfSegment&, const SdfProfile&, const float *, const float *, const float *, size_t, float *);
+
+static SdfSegmentKernel selectSdfSegmentKernel()
+{
+#ifdef SWEEP_SDF_HAS_AVX2
+    if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+    {
+        return bakeSegmentAVX2;
+    }
+#endif
+    return bakeSegmentScalar;
+}
+
+
+
+// ============= GRID ============= //
+
+// block coordinates take 21 bits of a key each, so they must be within [-BLOCK_KEY_BIAS, BLOCK_KEY_BIAS)
+static const int BLOCK_KEY_BIAS = 1 << 20;
+
+// keys sort blocks by x, then y, then z
+static uint64_t blockKey(const glm::ivec3& block)
+{
+    return (uint64_t(block.x + BLOCK_KEY_BIAS) << 42) | (uint64_t(block.y + BLOCK_KEY_BIAS) << 21) | uint64_t(block.z + BLOCK_KEY_BIAS);
+}
+
+static glm::ivec3 blockFromKey(uint64_t key)
+{
+    const uint64_t mask = (uint64_t(1) << 21) - 1;
+    return glm::ivec3(int((key >> 42) & mask) - BLOCK_KEY_BIAS, int((key >> 21) & mask) - BLOCK_KEY_BIAS, int(key & mask) - BLOCK_KEY_BIAS);
+}
+
+static bool isBlockInKeyRange(const glm::ivec3& block)
+{
+    return glm::all(glm::greaterThanEqual(block, glm::ivec3(-BLOCK_KEY_BIAS))) && glm::all(glm::lessThan(block, glm::ivec3(BLOCK_KEY_BIAS)));
+}
+
+static int floorDiv(int value, int divisor)
+{
+    return value >= 0 ? value / divisor : -((-value + divisor - 1) / divisor);
+}
+
+// Lower bound of the distance between the segment from `a` to `b` and the box from `lo` to `hi`.
+// The distance to a box only falls and then rises along a segment, so its minimum is narrowed down with a ternary search;
+// what the search leaves open is subtracted, so that the bound never exceeds the true distance.
+static float segmentBoxDistance(const glm::vec3& a, const glm::vec3& b, const glm::vec3& lo, const glm::vec3& hi)
+{
+    const auto boxDistance = [&](float t) {
+        const glm::vec3 p = a + (b - a) * t;
+        return glm::length(p - glm::clamp(p, lo, hi));
+    };
+
+    float t0 = 0.f, t1 = 1.f;
+    for (int i = 0; i < 16; i++)
+    {
+        const float m0 = t0 + (t1 - t0) / 3.f;
+        const float m1 = t1 - (t1 - t0) / 3.f;
+        if(boxDistance(m0) < boxDistance(m1))
+        {
+            t1 = m1;
+        }
+        else
+        {
+            t0 = m0;
+        }
+    }
+
+    return boxDistance((t0 + t1) * 0.5f) - glm::length(b - a) * (t1 - t0);
+}
+
+SparseSdfGrid bakeSweepSdf(const std::vector<SweepSdfSource>& sweeps, const SdfBakeOptions& options)
+{
+    SparseSdfGrid grid;
+    grid.voxelSize = options.voxelSize;
+    grid.bandWidth = options.bandWidth;
+
+    if(!(options.voxelSize > 0.f) || !(options.bandWidth > 0.f))
+    {
+        printf("[ERROR][%s(%d)] Voxel size and band width must be positive\n", __FILE__, __LINE__);
+        return grid;
+    }
+
+    std::vector<SdfProfile> profiles(sweeps.size());
+    std::vector<SdfSegment> segments;
+    std::vector<float> segmentRadius;
+
+    for (size_t i = 0; i < sweeps.size(); i++)
+    {
+        const SweepSdfSource& sweep = sweeps[i];
+        if(sweep.profile.size() < 3 || sweep.frames.size() < 2)
+        {
+            printf("[ERROR][%s(%d)] Sweep %zu has too few profile vertices or rings, skipping it\n", __FILE__, __LINE__, i);
+            continue;
+        }
+
+        profiles[i] = makeSdfProfile(sweep.profile);
+
+        float profileRadius = 0.f;
+        for(const auto& vertex : sweep.profile)
+        {
+            profileRadius = std::max(profileRadius, glm::length(vertex));
+        }
+
+        // every block the sweep reaches needs a key
+        glm::vec3 sweepMin(std::numeric_limits<float>::max()), sweepMax(-std::numeric_limits<float>::max());
+        for(const auto& frame : sweep.frames)
+        {
+            const float reach = profileRadius * std::max(glm::length(frame.right), glm::length(frame.up)) + options.bandWidth;
+            sweepMin = glm::min(sweepMin, frame.position - reach);
+            sweepMax = glm::max(sweepMax, frame.position + reach);
+        }
+        const glm::vec3 firstBlock = sweepMin / (options.voxelSize * SDF_BLOCK_SIZE);
+        const glm::vec3 lastBlock = sweepMax / (options.voxelSize * SDF_BLOCK_SIZE);
+        if(!glm::all(glm::greaterThanEqual(firstBlock, glm::vec3(-BLOCK_KEY_BIAS))) || !glm::all(glm::lessThan(lastBlock, glm::vec3(BLOCK_KEY_BIAS))))
+        {
+            printf("[ERROR][%s(%d)] Sweep %zu reaches more than %d blocks away from the origin, skipping it\n", __FILE__, __LINE__, i, BLOCK_KEY_BIAS);
+            continue;
+        }
+
+        for (size_t k = 0; k + 1 < sweep.frames.size(); k++)
+        {
+            const RingFrame& f0 = sweep.frames[k];
+            const RingFrame& f1 = sweep.frames[k + 1];
+
+            SdfSegment s;
+            s.start = f0.position;
+            s.end = f1.position;
+            s.axis = f1.position - f0.position;
+            s.invAxisLengthSquared = glm::dot(s.axis, s.axis) > 0.f ? 1.f / glm::dot(s.axis, s.axis) : 0.f;
+            s.right = f0.right;
+            s.rightDelta = f1.right - f0.right;
+            s.up = f0.up;
+            s.upDelta = f1.up - f0.up;
+            s.startNormal = glm::normalize(glm::cross(f0.right, f0.up));
+            s.endNormal = glm::normalize(glm::cross(f1.right, f1.up));
+            s.startCapBias = k == 0 ? 0.f : -std::numeric_limits<float>::max();
+            s.endCapBias = k + 2 == sweep.frames.size() ? 0.f : -std::numeric_limits<float>::max();
+            s.sweep = i;
+
+            segments.push_back(s);
+            segmentRadius.push_back(profileRadius * std::max(std::max(glm::length(f0.right), glm::length(f0.up)), std::max(glm::length(f1.right), glm::length(f1.up))));
+        }
+    }
+
+    if(segments.size() >= UINT32_MAX)
+    {
+        printf("[ERROR][%s(%d)] Too many segments to bake at once\n", __FILE__, __LINE__);
+        return grid;
+    }
+
+    // ============= BLOCKS ============= //
+    // Every segment is listed in the blocks that come within the band of its surface.
+    // The surface lies within the segment's radius of its axis, so blocks of its bounds further from the axis are left out,
+    // which keeps diagonal segments from being baked into all the empty blocks around them.
+    const float blockSize = options.voxelSize * SDF_BLOCK_SIZE;
+    // voxels of a block sit at its corner and the 7 after it
+    const glm::vec3 blockExtent(options.voxelSize * (SDF_BLOCK_SIZE - 1));
+    std::vector<std::pair<uint64_t, unsigned int>> blockSegments;
+    for (size_t k = 0; k < segments.size(); k++)
+    {
+        const float reach = segmentRadius[k] + options.bandWidth;
+        const glm::ivec3 first(glm::floor((glm::min(segments[k].start, segments[k].end) - reach) / blockSize));
+        const glm::ivec3 last(glm::floor((glm::max(segments[k].start, segments[k].end) + reach) / blockSize));
+
+        for (int x = first.x; x <= last.x; x++)
+        {
+            for (int y = first.y; y <= last.y; y++)
+            {
+                for (int z = first.z; z <= last.z; z++)
+                {
+                    const glm::vec3 lo = glm::vec3(x, y, z) * blockSize;
+                    if(segmentBoxDistance(segments[k].start, segments[k].end, lo, lo + blockExtent) <= reach)
+                    {
+                        blockSegments.push_back({blockKey(glm::ivec3(x, y, z)), (unsigned int)k});
+                    }
+                }
+            }
+        }
+    }
+    std::sort(blockSegments.begin(), blockSegments.end());
+
+    std::vector<size_t> blockFirstSegment;
+    for (size_t i = 0; i < blockSegments.size(); i++)
+    {
+        if(i == 0 || blockSegments[i].first != blockSegments[i - 1].first)
+        {
+            blockFirstSegment.push_back(i);
+            grid.blocks.push_back(blockFromKey(blockSegments[i].first));
+        }
+    }
+    blockFirstSegment.push_back(blockSegments.size());
+
+    // ============= BAKING ============= //
+    const SdfSegmentKernel kernel = selectSdfSegmentKernel();
+
+    grid.distances.resize(grid.blocks.size() * SDF_BLOCK_VOXELS);
+    parallelFor(grid.blocks.size(), MIN_BLOCKS_PER_THREAD, [&](size_t begin, size_t end) {
+        alignas(32) float px[SDF_BLOCK_VOXELS], py[SDF_BLOCK_VOXELS], pz[SDF_BLOCK_VOXELS];
+
+        for (size_t b = begin; b < end; b++)
+        {
+            const glm::ivec3 firstVoxel = grid.blocks[b] * SDF_BLOCK_SIZE;
+            for (int z = 0, v = 0; z < SDF_BLOCK_SIZE; z++)
+            {
+                for (int y = 0; y < SDF_BLOCK_SIZE; y++)
+                {
+                    for (int x = 0; x < SDF_BLOCK_SIZE; x++, v++)
+                    {
+                        px[v] = float(firstVoxel.x + x) * options.voxelSize;
+                        py[v] = float(firstVoxel.y + y) * options.voxelSize;
+                        pz[v] = float(firstVoxel.z + z) * options.voxelSize;
+                    }
+                }
+            }
+
+            float *distances = &grid.distances[b * SDF_BLOCK_VOXELS];
+            std::fill(distances, distances + SDF_BLOCK_VOXELS, options.bandWidth);
+
+            for (size_t i = blockFirstSegment[b]; i < blockFirstSegment[b + 1]; i++)
+            {
+                const SdfSegment& segment = segments[blockSegments[i].second];
+                kernel(segment, profiles[segment.sweep], px, py, pz, SDF_BLOCK_VOXELS, distances);
+            }
+
+            for (int v = 0; v < SDF_BLOCK_VOXELS; v++)
+            {
+                distances[v] = std::max(distances[v], -options.bandWidth);
+            }
+        }
+    });
+
+    // blocks the surfaces didn't come close enough to are dropped
+    size_t kept = 0;
+    for (size_t b = 0; b < grid.blocks.size(); b++)
+    {
+        const float *distances = &grid.distances[b * SDF_BLOCK_VOXELS];
+        if(std::any_of(distances, distances + SDF_BLOCK_VOXELS, [&](float d) { return d < options.bandWidth; }))
+        {
+            if(kept != b)
+            {
+                grid.blocks[kept] = grid.blocks[b];
+                std::copy(distances, distances + SDF_BLOCK_VOXELS, &grid.distances[kept * SDF_BLOCK_VOXELS]);
+            }
+            kept++;
+        }
+    }
+    grid.blocks.resize(kept);
+    grid.distances.resize(kept * SDF_BLOCK_VOXELS);
+
+    return grid;
+}
+
+static float voxelDistance(const SparseSdfGrid& grid, const glm::ivec3& voxel)
+{
+    const glm::ivec3 block(floorDiv(voxel.x, SDF_BLOCK_SIZE), floorDiv(voxel.y, SDF_BLOCK_SIZE), floorDiv(voxel.z, SDF_BLOCK_SIZE));
+    if(!isBlockInKeyRange(block))
+    {
+        return grid.bandWidth;
+    }
+    const uint64_t key = blockKey(block);
+
+    auto it = std::lower_bound(grid.blocks.begin(), grid.blocks.end(), key, [](const glm::ivec3& b, uint64_t k) {
+        return blockKey(b) < k;
+    });
+    if(it == grid.blocks.end() || *it != block)
+    {
+        return grid.bandWidth;
+    }
+
+    const glm::ivec3 local = voxel - block * SDF_BLOCK_SIZE;
+    return grid.distances[size_t(it - grid.blocks.begin()) * SDF_BLOCK_VOXELS + (local.z * SDF_BLOCK_SIZE + local.y) * SDF_BLOCK_SIZE + local.x];
+}
+
+float sampleSparseSdf(const SparseSdfGrid& grid, const glm::vec3& position)
+{
+    if(!(grid.voxelSize > 0.f))
+    {
+        return grid.bandWidth;
+    }
+
+    // beyond the blocks a grid can hold, also keeps the voxel coordinates from overflowing
+    const glm::vec3 g = position / grid.voxelSize;
+    if(!glm::all(glm::lessThan(glm::abs(g), glm::vec3(float(BLOCK_KEY_BIAS) * SDF_BLOCK_SIZE))))
+    {
+        return grid.bandWidth;
+    }
+    const glm::vec3 base = glm::floor(g);
+    const glm::vec3 f = g - base;
+    const glm::ivec3 v(base);
+
+    float corners[8];
+    for (int i = 0; i < 8; i++)
+    {
+        corners[i] = voxelDistance(grid, v + glm::ivec3(i & 1, (i >> 1) & 1, (i >> 2) & 1));
+    }
+
+    const float x00 = corners[0] + (corners[1] - corners[0]) * f.x;
+    const float x10 = corners[2] + (corners[3] - corners[2]) * f.x;
+    const float x01 = corners[4] + (corners[5] - corners[4]) * f.x;
+    const float x11 = corners[6] + (corners[7] - corners[6]) * f.x;
+    const float y0 = x00 + (x10 - x00) * f.y;
+    const float y1 = x01 + (x11 - x01) * f.y;
+    return y0 + (y1 - y0) * f.z;
+}
+
+bool exportSparseSdf(const SparseSdfGrid& grid, const char *path)
+{
+    FILE *file = fopen(path, "wb");
+    if(!file)
+    {
+        return false;
+    }
+
+    const uint32_t header[4] = {0x46445353u /* "SSDF" */, 1, SDF_BLOCK_SIZE, (uint32_t)grid.blocks.size()};
+    const float sizes[2] = {grid.voxelSize, grid.bandWidth};
+
+    std::vector<int32_t> coordinates;
+    coordinates.reserve(grid.blocks.size() * 3);
+    for(const auto& block : grid.blocks)
+    {
+        coordinates.push_back(block.x);
+        coordinates.push_back(block.y);
+        coordinates.push_back(block.z);
+    }
+
+    bool ok = fwrite(header, sizeof(header), 1, file) == 1 && fwrite(sizes, sizeof(sizes), 1, file) == 1;
+    ok = ok && (coordinates.empty() || fwrite(coordinates.data(), sizeof(int32_t), coordinates.size(), file) == coordinates.size());
+    ok = ok && (grid.distances.empty() || fwrite(grid.distances.data(), sizeof(float), grid.distances.size(), file) == grid.distances.size());
+
+    return fclose(file) == 0 && ok;
+}
+
+
+
+template SweepSdfSource makeSweepSdfSource(const std::vector<glm::vec2>&, const std::vector<ExtrusionPointT<float>>&, const glm::vec<3, float>&);
+template SweepSdfSource makeSweepSdfSource(const std::vector<glm::vec2>&, const std::vector<ExtrusionPointT<double>>&, const glm::vec<3, double>&);
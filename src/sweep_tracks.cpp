@@ -0,0 +1,67 @@
+#include "sweep_tracks.hpp"
+
+#include <algorithm> // std::fill
+#include <cmath> // std::ceil
+
+
+// index of the first sample at or after the given time
+static size_t firstSampleAt(float time, float step, size_t count)
+{
+    if(time <= 0.f)
+    {
+        return 0;
+    }
+
+    size_t index = (size_t)std::ceil(time / step);
+    return index < count ? index : count;
+}
+
+void evaluateTrack(const KeyframeTrack& track, float defaultValue, size_t count, float *out)
+{
+    if(count == 0)
+    {
+        return;
+    }
+
+    if(track.empty())
+    {
+        std::fill(out, out + count, defaultValue);
+        return;
+    }
+
+    if(count == 1)
+    {
+        out[0] = track.front().value;
+        return;
+    }
+
+    const float step = 1.f / float(count - 1);
+
+    // hold the first value until the first key
+    size_t sample = firstSampleAt(track.front().time, step, count);
+    std::fill(out, out + sample, track.front().value);
+
+    for (size_t k = 0; k + 1 < track.size(); k++)
+    {
+        const TrackKey& from = track[k];
+        const TrackKey& to = track[k + 1];
+
+        size_t end = firstSampleAt(to.time, step, count);
+        if(end <= sample)
+        {
+            continue;
+        }
+
+        const float duration = to.time - from.time;
+        const float slope = duration > 0.f ? (to.value - from.value) / duration : 0.f;
+
+        for (size_t i = sample; i < end; i++)
+        {
+            out[i] = from.value + (float(i) * step - from.time) * slope;
+        }
+        sample = end;
+    }
+
+    // and the last one after the last key
+    std::fill(out + sample, out + count, track.back().value);
+}
@@ -0,0 +1,123 @@
+// AsyncExtruder: submitting never blocks the caller, superseded jobs resolve empty and job exceptions reach the future.
+
+#include "async_extruder.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
+
+
+static int failures = 0;
+
+#define CHECK(condition) \
+    if(!(condition)) \
+    { \
+        printf("[FAILED][%s(%d)] %s\n", __FILE__, __LINE__, #condition); \
+        failures++; \
+    }
+
+// blocks jobs until opened from the test
+class Gate
+{
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_changed;
+    bool m_isOpen = false;
+    bool m_isReached = false;
+
+public:
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_isReached = true;
+        m_changed.notify_all();
+        m_changed.wait(lock, [this]() { return m_isOpen; });
+    }
+
+    void waitUntilReached()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_changed.wait(lock, [this]() { return m_isReached; });
+    }
+
+    void open()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_isOpen = true;
+        m_changed.notify_all();
+    }
+};
+
+static CurveMeshData singleVertexMesh()
+{
+    CurveMeshData mesh;
+    mesh.vertices.push_back(glm::vec3(0.f));
+    return mesh;
+}
+
+int main()
+{
+    using namespace std::chrono_literals;
+
+    // a single worker, so that a blocked job holds up everything queued after it
+    AsyncExtruder extruder(1);
+
+    Gate gate;
+    std::future<CurveMeshData> blocked = extruder.submit(1, [&](const std::atomic<bool> *) {
+        gate.wait();
+        return singleVertexMesh();
+    });
+    gate.waitUntilReached();
+
+    // ============= SUBMIT DOESN'T WAIT ============= //
+    bool queuedJobRan = false;
+    const auto start = std::chrono::steady_clock::now();
+    std::future<CurveMeshData> queued = extruder.submit(2, [&](const std::atomic<bool> *) {
+        queuedJobRan = true;
+        return singleVertexMesh();
+    });
+    CHECK(queued.wait_for(0s) == std::future_status::timeout);
+    CHECK(blocked.wait_for(0s) == std::future_status::timeout);
+    CHECK(std::chrono::steady_clock::now() - start < 100ms);
+
+    // ============= SUPERSESSION ============= //
+    // of a queued job, which never gets to run
+    std::future<CurveMeshData> latest = extruder.submit(2, [&](const std::atomic<bool> *) {
+        return singleVertexMesh();
+    });
+    // of the running job, which finishes its work but gets thrown away
+    std::future<CurveMeshData> replacement = extruder.submit(1, [&](const std::atomic<bool> *cancelled) {
+        return cancelled->load() ? CurveMeshData{} : singleVertexMesh();
+    });
+    gate.open();
+
+    CHECK(blocked.get().vertices.empty());
+    CHECK(queued.get().vertices.empty());
+    CHECK(!queuedJobRan);
+    CHECK(latest.get().vertices.size() == 1);
+    CHECK(replacement.get().vertices.size() == 1);
+
+    // ============= EXCEPTIONS ============= //
+    std::future<CurveMeshData> failing = extruder.submit(3, [&](const std::atomic<bool> *) -> CurveMeshData {
+        throw std::runtime_error("job failed");
+    });
+    bool isThrown = false;
+    try
+    {
+        failing.get();
+    }
+    catch(const std::runtime_error&)
+    {
+        isThrown = true;
+    }
+    CHECK(isThrown);
+
+    // the worker survives a failing job
+    CHECK(extruder.submit(3, [&](const std::atomic<bool> *) { return singleVertexMesh(); }).get().vertices.size() == 1);
+
+    if(failures == 0)
+    {
+        printf("async_extruder_test passed\n");
+    }
+    return failures == 0 ? 0 : 1;
+}